@@ -29,6 +29,7 @@
 #include <QDesktopServices>
 #include <QListWidget>
 #include <QMessageBox>
+#include <QProgressDialog>
 
 #include <QRegularExpression>
 
@@ -43,6 +44,7 @@
 
 #include "aloitussivu.h"
 #include "db/kirjanpito.h"
+#include "db/varmuuskopioija.h"
 #include "uusikp/uusikirjanpito.h"
 #include "alv/alvsivu.h"
 
@@ -70,6 +72,8 @@ AloitusSivu::AloitusSivu() :
 
     connect( ui->selain, SIGNAL(anchorClicked(QUrl)), this, SLOT(linkki(QUrl)));
 
+    // Kaikki tallennukset, myös tilinavaus ja tilien nimet, kirjataan muutoslokiin
+    connect( kp()->muutokset(), &MuutosLoki::versioMuuttui, this, &AloitusSivu::tyhjennaSummat);
     connect( kp(), SIGNAL(tietokantaVaihtui()), this, SLOT(kirjanpitoVaihtui()));
     connect( kp(), SIGNAL( perusAsetusMuuttui()), this, SLOT(kirjanpitoVaihtui()));
 
@@ -101,7 +105,17 @@ void AloitusSivu::siirrySivulle()
 
         // Ei tulosteta tyhjiä otsikoita vaan possu jos ei kirjauksia
         if( kp()->asetukset()->onko("EkaTositeKirjattu") )
-            txt.append(summat());
+        {
+            // Summat lasketaan uudelleen vain, jos kirjanpitoa on muokattu
+            // tai tilikausi vaihdettu. Muutoin käytetään edellistä laskelmaa.
+            Tilikausi tilikausi = kp()->tilikaudet()->tilikausiIndeksilla( ui->tilikausiCombo->currentIndex() );
+            if( summatKaudelle_ != tilikausi.alkaa() || summatHtml_.isEmpty())
+            {
+                summatHtml_ = summat();
+                summatKaudelle_ = tilikausi.alkaa();
+            }
+            txt.append(summatHtml_);
+        }
         else
             txt.append("<p><img src=qrc:/pic/aboutpossu.png></p>");
 
@@ -130,6 +144,8 @@ bool AloitusSivu::poistuSivulta(int /* minne */)
 
 void AloitusSivu::kirjanpitoVaihtui()
 {
+    tyhjennaSummat();
+
     bool avoinna = kp()->asetukset()->onko("Nimi");
 
     ui->nimiLabel->setVisible(avoinna);
@@ -184,6 +200,11 @@ void AloitusSivu::kirjanpitoVaihtui()
     siirrySivulle();
 }
 
+void AloitusSivu::tyhjennaSummat()
+{
+    summatHtml_.clear();
+}
+
 void AloitusSivu::linkki(const QUrl &linkki)
 {
     if( linkki.scheme() == "ohje")
@@ -290,11 +311,15 @@ void AloitusSivu::varmuuskopioi()
     }
     if( !tiedostoon.isEmpty() )
     {
-        QFile kirjanpito( kp()->tiedostopolku());
-        if( kirjanpito.copy(tiedostoon) )
+        QProgressDialog edistyminen(tr("Varmuuskopioidaan kirjanpitoa..."), tr("Peruuta"), 0, 0, this);
+        edistyminen.setWindowModality(Qt::ApplicationModal);
+        edistyminen.setMinimumDuration(250);
+
+        Varmuuskopioija kopioija( kp()->tietokanta() );
+        if( kopioija.kopioi(tiedostoon, &edistyminen) )
             QMessageBox::information(this, kp()->asetukset()->asetus("Nimi"), tr("Kirjanpidon varmuuskopiointi onnistui."));
-        else
-            QMessageBox::critical(this, tr("Virhe"), tr("Tiedoston varmuuskopiointi epäonnistui."));
+        else if( !edistyminen.wasCanceled())
+            QMessageBox::critical(this, tr("Virhe"), tr("Tiedoston varmuuskopiointi epäonnistui.\n%1").arg(kopioija.virhe()));
     }
 }
 
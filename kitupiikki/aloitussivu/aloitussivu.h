@@ -50,6 +50,11 @@ public slots:
     void siirrySivulle() override;
     void kirjanpitoVaihtui();
 
+    /**
+     * @brief Merkitsee summat laskettaviksi uudelleen seuraavalla näyttökerralla
+     */
+    void tyhjennaSummat();
+
     void linkki(const QUrl& linkki);
 
     void uusiTietokanta();
@@ -95,6 +100,9 @@ protected:
 protected:
     Ui::Aloitus *ui;
     bool sivulla = false;
+
+    QString summatHtml_;
+    QDate summatKaudelle_;
 };
 
 #endif // ALOITUSSIVU_H
@@ -32,6 +32,7 @@
 #include "raportti/alverittely.h"
 
 #include "marginaalilaskelma.h"
+#include "alvkuutio.h"
 
 
 AlvIlmoitusDialog::AlvIlmoitusDialog(QWidget *parent) :
@@ -97,21 +98,22 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
     int bruttovahennettavaaSnt = 0;
 
     EhdotusModel ehdotus;
-    QSqlQuery query( *kp()->tietokanta() );
+
+    // Kaikki jakson alv-kirjaukset luetaan kerralla
+    AlvKuutio kuutio( *kp()->tietokanta(), alkupvm, loppupvm);
 
     // 1) Bruttojen oikaisut
     // Korjattu 6.3.2018 #81 since 0.6
 
-    query.exec(  QString("select alvkoodi,alvprosentti,sum(debetsnt) as debetit, sum(kreditsnt) as kreditit, tili from vienti where pvm between \"%3\" and \"%4\" and (alvkoodi=%1 or alvkoodi=%2) group by alvkoodi,tili,alvprosentti")
-                 .arg(AlvKoodi::MYYNNIT_BRUTTO).arg(AlvKoodi::OSTOT_BRUTTO)
-                 .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)));
-
-    while( query.next() && query.value("alvprosentti").toInt())
+    for( const AlvKuutio::Solu& solu : kuutio.solut())
     {
+        if( ( solu.alvkoodi != AlvKoodi::MYYNNIT_BRUTTO && solu.alvkoodi != AlvKoodi::OSTOT_BRUTTO) ||
+            !solu.alvprosentti )
+            continue;
 
-        Tili tili = kp()->tilit()->tiliIdlla( query.value("tili").toInt() );
-        int alvprosentti = query.value("alvprosentti").toInt();
-        qlonglong saldoSnt =  query.value("kreditit").toInt() - query.value("debetit").toLongLong();
+        Tili tili = kp()->tilit()->tiliIdlla( solu.tili );
+        int alvprosentti = solu.alvprosentti;
+        qlonglong saldoSnt =  solu.saldo();
 
 
         VientiRivi rivi;        // Rivi, jolla tiliä oikaistaan
@@ -138,7 +140,7 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
             verorivi.debetSnt = 0 - veroSnt;
         }
 
-        if( query.value("alvkoodi").toInt() == AlvKoodi::MYYNNIT_BRUTTO )
+        if( solu.alvkoodi == AlvKoodi::MYYNNIT_BRUTTO )
         {
             verotKannoittainSnt[ alvprosentti ] = verotKannoittainSnt.value(alvprosentti, 0) + veroSnt;
             bruttoveroayhtSnt += veroSnt;
@@ -179,14 +181,10 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
     // 1B) Voittomarginaaliverotus
     MarginaaliLaskelma marginaali(alkupvm, loppupvm);
-    query.exec( QString("select tili, alvprosentti, sum(kreditsnt) as plus, sum(debetsnt) as minus from vienti "
-                        "where alvkoodi=%1 and pvm between \"%2\" and \"%3\" group by tili,alvprosentti")
-                .arg(AlvKoodi::MYYNNIT_MARGINAALI).arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)));
-
-    while( query.next())
+    for( const AlvKuutio::Solu& solu : kuutio.koodilla(AlvKoodi::MYYNNIT_MARGINAALI))
     {
-        qlonglong myynti = query.value("plus").toLongLong() - query.value("minus").toLongLong();
-        int kanta = query.value("alvprosentti").toInt();
+        qlonglong myynti = solu.saldo();
+        int kanta = solu.alvprosentti;
         double osuus = (myynti * 1.00 / marginaali.myynnit(kanta));
         qlonglong vero = qRound( osuus * marginaali.vero(kanta) );
 
@@ -195,7 +193,7 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
         tilirivi.pvm = loppupvm;
         tilirivi.alvprosentti = kanta;
-        tilirivi.tili = kp()->tilit()->tiliIdlla( query.value("tili").toInt() );
+        tilirivi.tili = kp()->tilit()->tiliIdlla( solu.tili );
         tilirivi.alvkoodi = AlvKoodi::TILITYS;
 
         verorivi.pvm = loppupvm;
@@ -219,31 +217,29 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
 
 
     // 2) Nettokirjausten koonti
-    query.exec( QString("select alvprosentti, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti where pvm between \"%1\" and \"%2\" and (alvkoodi=%3 or alvkoodi=%4) group by alvprosentti")
-                .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate))
-                .arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MYYNNIT_NETTO).arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI) );
-
-    while( query.next())
+    for( int koodi : { AlvKoodi::ALVKIRJAUS + AlvKoodi::MYYNNIT_NETTO, AlvKoodi::ALVKIRJAUS + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI })
     {
-        int alvprosentti = query.value("alvprosentti").toInt();
-        qlonglong saldo = query.value("kreditit").toInt() - query.value("debetit").toInt();
-        verotKannoittainSnt[ alvprosentti ] = verotKannoittainSnt.value(alvprosentti) + saldo;
+        QMapIterator<int,qlonglong> nettoIter( kuutio.saldotProsenteittain(koodi) );
+        while( nettoIter.hasNext())
+        {
+            nettoIter.next();
+            verotKannoittainSnt[ nettoIter.key() ] = verotKannoittainSnt.value(nettoIter.key()) + nettoIter.value();
+        }
     }
 
 
     // Muut kirjaukset tauluihin
-    query.exec( QString("select alvkoodi, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti where pvm between \"%1\" and \"%2\" group by alvkoodi")
-                .arg(alkupvm.toString(Qt::ISODate)).arg(loppupvm.toString(Qt::ISODate)) );
-
     QMap<int,qlonglong> kooditaulu;
 
     int nettoverosnt = 0;
     int nettovahennyssnt = 0;
 
-    while( query.next())
+    QMapIterator<int,qlonglong> koodiIter( kuutio.saldotKoodeittain() );
+    while( koodiIter.hasNext())
     {
-        qlonglong saldo = query.value("kreditit").toLongLong() - query.value("debetit").toLongLong();
-        int koodi = query.value("alvkoodi").toInt();
+        koodiIter.next();
+        qlonglong saldo = koodiIter.value();
+        int koodi = koodiIter.key();
 
         if( koodi > AlvKoodi::MAKSUPERUSTEINEN_KOHDENTAMATON)
             continue;   // Ei kirjaus eikä vähennys
@@ -397,42 +393,25 @@ bool AlvIlmoitusDialog::alvIlmoitus(QDate alkupvm, QDate loppupvm)
         qlonglong liikevaihto = marginaalithl.marginaali();
 
 
-        QSqlQuery kysely;
-        // Liikevaihtoon ei lasketa verotonta myyntiä eikä palveluiden yhteisömyyntiä
-        kysely.exec(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                                   "FROM vienti, tili WHERE "
-                                   "pvm BETWEEN \"%1\" AND \"%2\" "
-                                   "AND vienti.tili=tili.id AND "
-                                   "tili.tyyppi = \"CL\" AND vienti.alvkoodi > 0 AND vienti.alvkoodi <> 13 AND "
-                                   "vienti.alvkoodi <> 15")
-                           .arg(laskelmaMista.toString(Qt::ISODate))
-                           .arg(loppupvm.toString(Qt::ISODate)));
-        if( kysely.next())
-            liikevaihto += kysely.value(0).toLongLong() - kysely.value(1).toLongLong();
+        AlvKuutio vuosi( *kp()->tietokanta(), laskelmaMista, loppupvm);
 
-        // Liikevaihdossa ei oteta kuitenkaan huomioon veron osuutta (bruttomenettely)
-        liikevaihto -= bruttoveroayhtSnt;
-
-        kysely.exec(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                                   "FROM vienti WHERE "
-                                   "pvm BETWEEN \"%1\" AND \"%2\" "
-                                   "AND (alvkoodi = 111 OR alvkoodi = 127 OR alvkoodi = 118) ")
-                           .arg(laskelmaMista.toString(Qt::ISODate))
-                           .arg(loppupvm.toString(Qt::ISODate)) );
+        for( const AlvKuutio::Solu& solu : vuosi.solut())
+        {
+            // Liikevaihtoon ei lasketa verotonta myyntiä eikä palveluiden yhteisömyyntiä
+            if( solu.alvkoodi > 0 && solu.alvkoodi != 13 && solu.alvkoodi != 15 &&
+                kp()->tilit()->tiliIdlla(solu.tili).tyyppiKoodi() == "CL")
+                liikevaihto += solu.saldo();
 
-        if( kysely.next())
-            vero += kysely.value(0).toLongLong() - kysely.value(1).toLongLong();
+            if( solu.alvkoodi == 111 || solu.alvkoodi == 127 || solu.alvkoodi == 118)
+                vero += solu.saldo();
 
-        // Verosta vähennetään vielä vähennetyt
-        kysely.exec(  QString("SELECT SUM(kreditsnt), SUM(debetsnt) "
-                                   "FROM vienti WHERE "
-                                   "pvm BETWEEN \"%1\" AND \"%2\" "
-                                   "AND alvkoodi > 200 AND alvkoodi < 300 ")
-                           .arg(laskelmaMista.toString(Qt::ISODate))
-                           .arg(loppupvm.toString(Qt::ISODate)) );
+            // Verosta vähennetään vielä vähennetyt
+            if( solu.alvkoodi > 200 && solu.alvkoodi < 300)
+                vero += solu.saldo();
+        }
 
-        if( kysely.next())
-            vero -= kysely.value(1).toLongLong() - kysely.value(0).toLongLong();
+        // Liikevaihdossa ei oteta kuitenkaan huomioon veron osuutta (bruttomenettely)
+        liikevaihto -= bruttoveroayhtSnt;
 
         qlonglong suhteutettu = liikevaihto;
 
@@ -584,27 +563,33 @@ void AlvIlmoitusDialog::luku(const QString &nimike, qlonglong senttia, bool viiv
 bool AlvIlmoitusDialog::maksuperusteisenTilitys(const QDate &paivayksesta, const QDate &tilityspvm)
 {
     // Hakee kaikki sanottua vanhemmat erät ja jos niillä saldoa, niin lävähtävät maksuun
-    QSqlQuery kysely( QString("SELECT id, alvkoodi, alvprosentti FROM vienti WHERE (tili=%1 OR tili=%2) "
-                              "AND pvm <='%3'")
+    // Erien saldot haetaan samalla kyselyllä, nollasaldoiset erät jäävät pois
+    QSqlQuery kysely( QString("SELECT vienti.id, vienti.alvkoodi, vienti.alvprosentti, vienti.pvm, vienti.selite, vienti.tosite, "
+                              "erat.debet - erat.kredit FROM vienti, "
+                              "(SELECT eraid, SUM(debetsnt) AS debet, SUM(kreditsnt) AS kredit FROM vienti "
+                              "WHERE eraid IS NOT NULL GROUP BY eraid) AS erat "
+                              "WHERE erat.eraid=vienti.id AND (vienti.tili=%1 OR vienti.tili=%2) "
+                              "AND vienti.pvm <='%3' AND vienti.alvkoodi IN (%4,%5) AND erat.debet <> erat.kredit")
                       .arg( kp()->tilit()->tiliTyypilla(TiliLaji::KOHDENTAMATONALVVELKA).id() )
                       .arg( kp()->tilit()->tiliTyypilla(TiliLaji::KOHDENTAMATONALVSAATAVA).id())
-                      .arg( paivayksesta.toString(Qt::ISODate)));
+                      .arg( paivayksesta.toString(Qt::ISODate))
+                      .arg( AlvKoodi::MAKSUPERUSTEINEN_KOHDENTAMATON + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI )
+                      .arg( AlvKoodi::MAKSUPERUSTEINEN_KOHDENTAMATON + AlvKoodi::MAKSUPERUSTEINEN_OSTO ));
 
     EhdotusModel ehdotus;
 
     while( kysely.next())
     {
-        int alvkoodi = kysely.value("alvkoodi").toInt();
-        if( alvkoodi != AlvKoodi::MAKSUPERUSTEINEN_KOHDENTAMATON + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI &&
-            alvkoodi != AlvKoodi::MAKSUPERUSTEINEN_KOHDENTAMATON + AlvKoodi::MAKSUPERUSTEINEN_OSTO )
-            continue;
-
-        TaseEra veroEra( kysely.value("id").toInt() );
+        int alvkoodi = kysely.value(1).toInt();
+
+        TaseEra veroEra;
+        veroEra.eraId = kysely.value(0).toInt();
+        veroEra.pvm = kysely.value(3).toDate();
+        veroEra.selite = kysely.value(4).toString();
+        veroEra.tositeId = kysely.value(5).toInt();
+        veroEra.saldoSnt = kysely.value(6).toLongLong();
         qlonglong saldo = veroEra.saldoSnt;
 
-        if( !saldo )
-            continue;
-
         // Kirjataan kohdentamattomasta alv-velasta (saatavasta) alv-velkaan (saatavaan)
 
         VientiRivi kohdentamaton;
@@ -615,8 +600,8 @@ bool AlvIlmoitusDialog::maksuperusteisenTilitys(const QDate &paivayksesta, const
         kohdentamaton.kreditSnt = saldo > 0 ? saldo : 0;
         kohdentamaton.debetSnt = saldo < 0 ? 0 - saldo : 0;
         kohdentamaton.alvkoodi = AlvKoodi::TILITYS;
-        kohdentamaton.eraId = kysely.value("id").toInt();
-        kohdentamaton.selite = tr("Maksuperusteinen %1 % alv %2 / %3 [%4]").arg( kysely.value("alvprosentti").toInt() )
+        kohdentamaton.eraId = veroEra.eraId;
+        kohdentamaton.selite = tr("Maksuperusteinen %1 % alv %2 / %3 [%4]").arg( kysely.value(2).toInt() )
                 .arg(veroEra.tositteenTunniste()).arg(veroEra.pvm.toString("dd.MM.yyyy"))
                 .arg(veroEra.selite);
 
@@ -631,7 +616,7 @@ bool AlvIlmoitusDialog::maksuperusteisenTilitys(const QDate &paivayksesta, const
         verorivi.alvkoodi = alvkoodi == AlvKoodi::MAKSUPERUSTEINEN_KOHDENTAMATON + AlvKoodi::MAKSUPERUSTEINEN_OSTO ?
                     AlvKoodi::ALVVAHENNYS + AlvKoodi::MAKSUPERUSTEINEN_OSTO :
                     AlvKoodi::ALVKIRJAUS + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI;
-        verorivi.alvprosentti = kysely.value("alvprosentti").toInt();
+        verorivi.alvprosentti = kysely.value(2).toInt();
 
         ehdotus.lisaaVienti(kohdentamaton);
         ehdotus.lisaaVienti(verorivi);
@@ -0,0 +1,67 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QSqlQuery>
+
+#include "alvkuutio.h"
+
+AlvKuutio::AlvKuutio(QSqlDatabase &tietokanta, const QDate &alkaa, const QDate &paattyy)
+{
+    QSqlQuery kysely( tietokanta );
+    kysely.setForwardOnly(true);
+    kysely.exec( QString("SELECT alvkoodi, alvprosentti, tili, SUM(debetsnt), SUM(kreditsnt) FROM vienti "
+                         "WHERE pvm BETWEEN \"%1\" AND \"%2\" AND alvkoodi <> 0 "
+                         "GROUP BY alvkoodi, tili, alvprosentti ORDER BY alvkoodi, tili, alvprosentti")
+                 .arg(alkaa.toString(Qt::ISODate)).arg(paattyy.toString(Qt::ISODate)));
+
+    while( kysely.next())
+    {
+        Solu solu;
+        solu.alvkoodi = kysely.value(0).toInt();
+        solu.alvprosentti = kysely.value(1).toInt();
+        solu.tili = kysely.value(2).toInt();
+        solu.debet = kysely.value(3).toLongLong();
+        solu.kredit = kysely.value(4).toLongLong();
+        solut_.append(solu);
+    }
+}
+
+QList<AlvKuutio::Solu> AlvKuutio::koodilla(int alvkoodi) const
+{
+    QList<Solu> lista;
+    for( const Solu& solu : solut_)
+        if( solu.alvkoodi == alvkoodi)
+            lista.append(solu);
+    return lista;
+}
+
+QMap<int, qlonglong> AlvKuutio::saldotKoodeittain() const
+{
+    QMap<int,qlonglong> saldot;
+    for( const Solu& solu : solut_)
+        saldot[solu.alvkoodi] += solu.saldo();
+    return saldot;
+}
+
+QMap<int, qlonglong> AlvKuutio::saldotProsenteittain(int alvkoodi) const
+{
+    QMap<int,qlonglong> saldot;
+    for( const Solu& solu : solut_)
+        if( solu.alvkoodi == alvkoodi)
+            saldot[solu.alvprosentti] += solu.saldo();
+    return saldot;
+}
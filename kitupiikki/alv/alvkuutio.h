@@ -0,0 +1,77 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ALVKUUTIO_H
+#define ALVKUUTIO_H
+
+#include <QDate>
+#include <QList>
+#include <QMap>
+
+class QSqlDatabase;
+
+/**
+ * @brief Jakson arvonlisäverokirjausten summat
+ *
+ * Kaikki jakson viennit luetaan yhdellä kyselyllä, joka ryhmittelee
+ * ne alv-koodin, tilin ja verokannan mukaan. Alv-laskelman eri kohdat
+ * lasketaan tästä koosteesta.
+ *
+ * @since 1.5
+ */
+class AlvKuutio
+{
+public:
+    struct Solu
+    {
+        int alvkoodi = 0;
+        int alvprosentti = 0;
+        int tili = 0;
+        qlonglong debet = 0;
+        qlonglong kredit = 0;
+
+        qlonglong saldo() const { return kredit - debet; }
+    };
+
+    /**
+     * @param tietokanta Tietokanta, jossa vienti-taulu
+     * @param alkaa Jakson alkupäivä
+     * @param paattyy Jakson päättymispäivä
+     */
+    AlvKuutio(QSqlDatabase& tietokanta, const QDate& alkaa, const QDate& paattyy);
+
+    /**
+     * @brief Alv-koodin solut tilin ja verokannan mukaan järjestettynä
+     */
+    QList<Solu> koodilla(int alvkoodi) const;
+
+    /**
+     * @brief Saldot (kredit - debet) alv-koodeittain
+     */
+    QMap<int,qlonglong> saldotKoodeittain() const;
+
+    /**
+     * @brief Alv-koodin saldot verokannoittain
+     */
+    QMap<int,qlonglong> saldotProsenteittain(int alvkoodi) const;
+
+    const QList<Solu>& solut() const { return solut_; }
+
+protected:
+    QList<Solu> solut_;
+};
+
+#endif // ALVKUUTIO_H
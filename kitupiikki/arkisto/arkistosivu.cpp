@@ -23,12 +23,14 @@
 #include <QSqlQuery>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QCryptographicHash>
 
 #include <fstream>
 #include <iostream>
 
 #include "arkistosivu.h"
 #include "db/kirjanpito.h"
+#include "db/tositenumerointi.h"
 #include "ui_lisaatilikausidlg.h"
 #include "ui_lukitsetilikausi.h"
 #include "ui_muokkaatilikausi.h"
@@ -205,6 +207,7 @@ void ArkistoSivu::vieArkisto()
                 return;
             }
 
+            QHash<QString,QByteArray> tiivisteet = TarArkisto::lueTiivisteet(mista);
             QProgressDialog odota(tr("Kopioidaan arkistoa"), tr("Peruuta"),0, tiedostot.count(),this);
             int kopioitu = 0;
 
@@ -213,7 +216,7 @@ void ArkistoSivu::vieArkisto()
                 if( odota.wasCanceled())
                     break;
 
-                if( !tar.lisaaTiedosto( mista.absoluteFilePath(tiedosto) ) )
+                if( !tar.lisaaTiedosto( mista.absoluteFilePath(tiedosto), tiivisteet.value(tiedosto) ) )
                 {
                     tar.lopeta();
 
@@ -401,60 +404,18 @@ void ArkistoSivu::uudellenNumerointi()
 
     Tilikausi kausi = kp()->tilikaudet()->tilikausiIndeksilla(ui->view->currentIndex().row() );
 
-    kp()->tietokanta()->transaction();
-
-    QSqlQuery kysely;
-    QSqlQuery paivitys;
-
-
-    paivitys.prepare("UPDATE Tosite SET tunniste=? WHERE id=?");
-
-    int uusinumero = 1;
-
-    if( kp()->asetukset()->onko("Samaansarjaan") )
+    if( !TositeNumerointi::numeroiUudelleen( *kp()->tietokanta(), kausi.alkaa(), kausi.paattyy(),
+                                             kp()->asetukset()->onko("Samaansarjaan")))
     {
-        kysely.exec( QString("SELECT id FROM tosite WHERE pvm BETWEEN '%1' and '%2' ORDER BY pvm")
-                     .arg( kausi.alkaa().toString(Qt::ISODate) ).arg( kausi.paattyy().toString(Qt::ISODate)) );
-        while( kysely.next() )
-        {
-            paivitys.bindValue(0, uusinumero);
-            paivitys.bindValue(1, kysely.value(0).toInt());
-            if( !paivitys.exec() )
-            {
-                kp()->tietokanta()->rollback();
-                return;
-            }
-            uusinumero++;
-        }
-    }
-    else
-    {
-        int laji = -1;
-
-        kysely.exec( QString("SELECT id, laji FROM tosite "
-                             "WHERE pvm BETWEEN '%1' AND '%2' "
-                             "ORDER BY laji, pvm")
-                     .arg( kausi.alkaa().toString(Qt::ISODate) ).arg( kausi.paattyy().toString(Qt::ISODate)) );
-        while( kysely.next() )
-        {
-            if( kysely.value(1).toInt() != laji)
-            {
-                laji = kysely.value(1).toInt();
-                uusinumero = 1;
-            }
-            paivitys.bindValue(0, uusinumero);
-            paivitys.bindValue(1, kysely.value(0).toInt());
-            if( !paivitys.exec() )
-            {
-                kp()->tietokanta()->rollback();
-                return;
-            }
-            uusinumero++;
-        }
-
+        QMessageBox::critical(this, tr("Tositteiden uudelleennumerointi"),
+                              tr("Tositteiden numerointi epäonnistui tietokantavirheen takia."));
+        return;
     }
-    kp()->tietokanta()->commit();
 
+    // Välimuistit ja selaus päivitetään kerran koko numeroinnin jälkeen
+    kp()->muutokset()->kirjaa("tosite", 0, kausi.alkaa(), kausi.paattyy());
+    kp()->muutokset()->vahvista();
+    emit kp()->kirjanpitoaMuokattu();
 }
 
 bool ArkistoSivu::teeZip(const Tilikausi &kausi)
@@ -474,27 +435,62 @@ bool ArkistoSivu::teeZip(const Tilikausi &kausi)
         if( !paketti)
             return false;
 
+        QHash<QString,QByteArray> tiivisteet = TarArkisto::lueTiivisteet(mista);
         QProgressDialog odota(tr("Kopioidaan arkistoa"), tr("Peruuta"),0, tiedostot.count(),this);
         int kopioitu = 0;
 
         for( const QString& tiedosto : tiedostot)
         {
             if( odota.wasCanceled())
+            {
+                zip_discard(paketti);
                 return false;
+            }
 
             QFileInfo info( mista.absoluteFilePath(tiedosto)) ;
 
+            // Tarkastetaan tiedoston eheys ennen pakkaamista
+            if( tiivisteet.contains(tiedosto))
+            {
+                QFile in( info.absoluteFilePath() );
+                QCryptographicHash sha( QCryptographicHash::Sha256 );
+                if( !in.open(QIODevice::ReadOnly) || !sha.addData(&in) ||
+                    sha.result().toHex() != tiivisteet.value(tiedosto))
+                {
+                    zip_discard(paketti);
+                    return false;
+                }
+            }
+
+            // libzip lukee tiedoston vasta zip_closessa lohkoittain
             zip_source_t* lahde = zip_source_file(paketti, info.absoluteFilePath().toStdString().c_str(),
                                                   0,-1);
             if( !lahde)
+            {
+                zip_discard(paketti);
                 return false;
-            if( zip_file_add(paketti, info.fileName().toStdString().c_str(),
-                             lahde, 0) < 0)
+            }
+            zip_int64_t indeksi = zip_file_add(paketti, info.fileName().toStdString().c_str(),
+                             lahde, 0);
+            if( indeksi < 0)
+            {
+                zip_source_free(lahde);
+                zip_discard(paketti);
                 return false;
+            }
+
+            // Valmiiksi pakattuja kuvia ja pdf-tiedostoja ei kannata pakata uudelleen
+            QString paate = info.suffix().toLower();
+            if( paate == "pdf" || paate == "png" || paate == "jpg" || paate == "jpeg")
+                zip_set_file_compression(paketti, static_cast<zip_uint64_t>(indeksi), ZIP_CM_STORE, 0);
 
             odota.setValue(++kopioitu);
         }
-        zip_close(paketti);
+        if( zip_close(paketti) < 0)
+        {
+            zip_discard(paketti);
+            return false;
+        }
 
         QMessageBox::information(this, tr("Arkiston vienti valmis"),
                              tr("Arkisto viety tiedostoon %1").arg(arkisto));
@@ -15,13 +15,12 @@
    along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <cmath>
-
 #include "poistaja.h"
 #include "ui_poistaja.h"
 
 #include "kirjaus/ehdotusmodel.h"
 #include "raportti/raportinkirjoittaja.h"
+#include "poistolaskelma.h"
 
 #include <QSqlQuery>
 #include <QDebug>
@@ -74,18 +73,20 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
     kirjoittaja.lisaaOtsake(otsikko);
 
 
-    for( int i=0; i < kp()->tilit()->rowCount(QModelIndex()); i++)
-    {
-        Tili tili = kp()->tilit()->tiliIndeksilla(i);
-        if( !tili.onko(TiliLaji::POISTETTAVA))
-            continue;
-
-        qlonglong saldo = tili.saldoPaivalle( kausi.paattyy());
-
-        if( !saldo)
-            continue;
+    // Laskelma haetaan kerralla kaikille poistettaville tileille
+    PoistoLaskelma laskelma = PoistoLaskelma::laske( kausi.paattyy() );
+    const QVector<PoistoLaskelma::Kohde>& kohteet = laskelma.kohteet();
 
-        if( !kp()->tilit()->tiliNumerolla( tili.json()->luku("Poistotili") ).onkoValidi() )
+    for( int i=0; i < kohteet.count(); )
+    {
+        // Saman tilin kohteet ovat laskelmassa peräkkäin
+        Tili tili = kp()->tilit()->tiliIdlla( kohteet.at(i).tiliId );
+        int tilinLoppu = i;
+        while( tilinLoppu < kohteet.count() && kohteet.at(tilinLoppu).tiliId == tili.id())
+            tilinLoppu++;
+
+        Tili poistotili = kp()->tilit()->tiliNumerolla( tili.json()->luku("Poistotili") );
+        if( !poistotili.onkoValidi() )
         {
             QMessageBox::critical(nullptr, tr("Kitupiikin virhe"),
                                   tr("Poistoja ei voi kirjata, koska tilille %1 ei ole määritelty "
@@ -97,8 +98,14 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
         {
             //  Menojäännöspoistossa poistetaan määrätty prosenttimäärä siihen asti olevasta saldosta
 
-            int poistoprosentti = tili.json()->luku("Menojaannospoisto");
-            qlonglong poisto = std::round( saldo * poistoprosentti / 100.0 );
+            int poistoprosentti = kohteet.at(i).prosentti;
+            qlonglong saldo = 0;
+            qlonglong poisto = 0;
+            for( int k = i; k < tilinLoppu; k++)
+            {
+                saldo += kohteet.at(k).saldoSnt;
+                poisto += kohteet.at(k).poistoSnt;
+            }
             qlonglong jalkeen = saldo - poisto;
 
             RaporttiRivi rr;
@@ -117,32 +124,28 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
 
             if( tili.json()->luku("Kohdennukset"))
             {
-                QSqlQuery kohkysely( QString("SELECT kohdennus, SUM(debetsnt), SUM(kreditsnt) FROM vienti WHERE "
-                                             "tili=%1 AND pvm < '%2' GROUP BY kohdennus ORDER BY kohdennus" )
-                                     .arg(tili.id()).arg(kausi.paattyy().toString(Qt::ISODate)) );
-                while( kohkysely.next())
+                for( int k = i; k < tilinLoppu; k++)
                 {
-                    Kohdennus kohdennus = kp()->kohdennukset()->kohdennus(kohkysely.value(0).toInt());
-                    qlonglong kohdsaldo = kohkysely.value(1).toLongLong() - kohkysely.value(2).toLongLong();
-                    qlonglong kohdpoisto = std::round( kohdsaldo * poistoprosentti / 100.0 );
-                    qlonglong kohdjalkeen = kohdsaldo - kohdpoisto;
+                    const PoistoLaskelma::Kohde& kohde = kohteet.at(k);
+                    Kohdennus kohdennus = kp()->kohdennukset()->kohdennus( kohde.kohdennusId );
+                    qlonglong kohdjalkeen = kohde.saldoSnt - kohde.poistoSnt;
 
                     RaporttiRivi kr;
                     kr.lisaa("");
                     kr.lisaa( kohdennus.nimi() );
-                    kr.lisaa( kohdsaldo );
+                    kr.lisaa( kohde.saldoSnt );
                     kr.lisaa( tr("%1 %").arg( poistoprosentti ), 1, true);
-                    kr.lisaa( kohdpoisto);
+                    kr.lisaa( kohde.poistoSnt);
                     kr.lisaa( kohdjalkeen);
                     kirjoittaja.lisaaRivi( kr);
 
                     VientiRivi rivi;
                     rivi.pvm = kausi.paattyy();
                     rivi.tili = tili;
-                    rivi.kreditSnt = kohdpoisto;
+                    rivi.kreditSnt = kohde.poistoSnt;
                     rivi.selite = tr("Menojäännöspoisto %1 % %4 saldo ennen %L2 €, jälkeen %L3 €")
                             .arg(poistoprosentti)
-                            .arg(kohdsaldo / 100.0,0, 'f',2)
+                            .arg(kohde.saldoSnt / 100.0,0, 'f',2)
                             .arg(kohdjalkeen / 100.0,0, 'f',2)
                             .arg( kohdennus.nimi());
                     rivi.kohdennus = kohdennus;
@@ -150,8 +153,8 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
 
                     VientiRivi poistotilille;
                     poistotilille.pvm = kausi.paattyy();
-                    poistotilille.tili = kp()->tilit()->tiliNumerolla( tili.json()->luku("Poistotili") );
-                    poistotilille.debetSnt = kohdpoisto;
+                    poistotilille.tili = poistotili;
+                    poistotilille.debetSnt = kohde.poistoSnt;
                     poistotilille.kohdennus = kohdennus;
                     poistotilille.selite = tr("Tilin %1 %2 %3 menojäännöspoisto")
                             .arg(tili.numero())
@@ -178,7 +181,7 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
 
                 VientiRivi poistotilille;
                 poistotilille.pvm = kausi.paattyy();
-                poistotilille.tili = kp()->tilit()->tiliNumerolla( tili.json()->luku("Poistotili") );
+                poistotilille.tili = poistotili;
                 poistotilille.debetSnt = poisto;
                 poistotilille.selite = tr("Tilin %1 %2 menojäännöspoisto")
                         .arg(tili.numero())
@@ -192,8 +195,7 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
         }
         else if( tili.onko( TiliLaji::TASAERAPOISTO))
         {
-            // Tasaeräpoistossa poistetaan tietty kuukausierä
-            // Nyt sitten haetaan tilin tase-erät ;)
+            // Tasaeräpoistossa poistetaan tietty kuukausierä tase-erittäin
 
             RaporttiRivi tiliRivi;
             tiliRivi.lisaaLinkilla(RaporttiRiviSarake::TILI_LINKKI, tili.id(), QString::number(tili.numero()) );
@@ -201,55 +203,20 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
             tiliRivi.lihavoi();
             kirjoittaja.lisaaRivi(tiliRivi);
 
-            EranValintaModel emodel;
-            emodel.lataa(tili, false, kausi.paattyy());
-            for(int eI=1; eI < emodel.rowCount(QModelIndex()); eI++)
+            for( int k = i; k < tilinLoppu; k++)
             {
-                QModelIndex eInd = emodel.index(eI, 0);
-
-                int eranId = eInd.data(EranValintaModel::EraIdRooli).toInt();
-                int eraSaldo = eInd.data(EranValintaModel::SaldoRooli).toInt();
-                QDate eranPvm = eInd.data(EranValintaModel::PvmRooli).toDate();
-
-                int alkuSnt = 0;
-                int poistoKk = 0;
-
-                QSqlQuery alkuKysely;
-                alkuKysely.exec(QString("SELECT debetsnt, kreditsnt, json, kohdennus FROM vienti WHERE id=%1").arg(eranId) );
-                if( alkuKysely.next())
-                {
-                    alkuSnt = alkuKysely.value("debetsnt").toInt() - alkuKysely.value("kreditsnt").toInt();
-                    JsonKentta json( alkuKysely.value("json").toByteArray());
-                    poistoKk = json.luku("Tasaerapoisto");
-                }
-
-                if( !poistoKk)
-                    continue;
-
-                // Montako kuukautta on kulunut hankinnasta
-                int kuukauttaKulunut = kausi.paattyy().year() * 12 + kausi.paattyy().month() -
-                                       eranPvm.year() * 12 - eranPvm.month() + 1;
-
-
-
-                // Laskennallinen poisto: Paljonko tähän asti voitaisiin poistaa
-                int laskennallinenPoisto = alkuSnt * kuukauttaKulunut / poistoKk ;
-                if( laskennallinenPoisto > alkuSnt)
-                    laskennallinenPoisto = alkuSnt; // Poistetaan vain se, mitä on jäljellä ...
-
-
-                int eraPoisto = laskennallinenPoisto - alkuSnt + eraSaldo;
+                const PoistoLaskelma::Kohde& era = kohteet.at(k);
 
                 RaporttiRivi rr;
-                rr.lisaa( eranPvm );
-                rr.lisaa( eInd.data(EranValintaModel::SeliteRooli).toString());
-                rr.lisaa( eraSaldo );
-                if( poistoKk % 12)      // Poistoaika
-                    rr.lisaa( tr( "%1 v %2 kk").arg(poistoKk / 12).arg(poistoKk % 12), 1, true);
+                rr.lisaa( era.pvm );
+                rr.lisaa( era.selite );
+                rr.lisaa( era.saldoSnt );
+                if( era.poistoKk % 12)      // Poistoaika
+                    rr.lisaa( tr( "%1 v %2 kk").arg(era.poistoKk / 12).arg(era.poistoKk % 12), 1, true);
                 else
-                    rr.lisaa( tr("%1 v").arg(poistoKk / 12), 1, true);
-                rr.lisaa( eraPoisto);
-                rr.lisaa( eraSaldo - eraPoisto );
+                    rr.lisaa( tr("%1 v").arg(era.poistoKk / 12), 1, true);
+                rr.lisaa( era.poistoSnt);
+                rr.lisaa( era.saldoSnt - era.poistoSnt );
 
                 kirjoittaja.lisaaRivi(rr);
 
@@ -258,34 +225,34 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
                 VientiRivi vienti;
                 vienti.pvm = kausi.paattyy();
                 vienti.tili = tili;
-                vienti.kreditSnt = eraPoisto;
-                vienti.eraId = eInd.data(EranValintaModel::EraIdRooli).toInt();
-                vienti.selite = tr("Tasaeräpoisto %1 ").arg( eInd.data(EranValintaModel::SeliteRooli).toString() );
+                vienti.kreditSnt = era.poistoSnt;
+                vienti.eraId = era.eraId;
+                vienti.selite = tr("Tasaeräpoisto %1 ").arg( era.selite );
                 // #123: Kohdennetaan poisto kirjauksen kohdennuksen mukaan
-                vienti.kohdennus = kp()->kohdennukset()->kohdennus( alkuKysely.value("kohdennus").toInt() );
+                vienti.kohdennus = kp()->kohdennukset()->kohdennus( era.kohdennusId );
                 ehdotus.lisaaVienti(vienti);
 
                 VientiRivi poistotilille;
                 poistotilille.pvm = kausi.paattyy();
-                poistotilille.tili = kp()->tilit()->tiliNumerolla( tili.json()->luku("Poistotili") );
-                poistotilille.debetSnt = eraPoisto;
+                poistotilille.tili = poistotili;
+                poistotilille.debetSnt = era.poistoSnt;
                 poistotilille.selite = tr("Tasaeräpoisto %3 tilillä %1 %2")
                         .arg(tili.numero())
                         .arg(tili.nimi())
-                        .arg( eInd.data(EranValintaModel::SeliteRooli).toString());
+                        .arg( era.selite );
                 ehdotus.lisaaVienti(poistotilille);
 
             }
             kirjoittaja.lisaaRivi();
 
         }
+        i = tilinLoppu;
     }
 
-    // Näytetään ehdotus
-
-
+    // Näytetään ehdotus ja tulevien kausien ennuste
 
     ui->browser->setHtml( kirjoittaja.html());
+    ui->ennusteBrowser->setHtml( ennuste(laskelma).html());
     if( exec() )
     {
         TositeModel tosite( kp()->tietokanta() );
@@ -326,6 +293,72 @@ bool Poistaja::sumupoistaja(Tilikausi kausi)
     return false;
 }
 
+RaportinKirjoittaja Poistaja::ennuste(const PoistoLaskelma &laskelma)
+{
+    RaportinKirjoittaja kirjoittaja;
+    kirjoittaja.asetaOtsikko("POISTOENNUSTE");
+    kirjoittaja.asetaKausiteksti( laskelma.paattyy().toString("dd.MM.yyyy"));
+
+    kirjoittaja.lisaaSarake("123456");
+    kirjoittaja.lisaaVenyvaSarake();
+
+    RaporttiRivi otsikko;
+    otsikko.lisaa("Tili");
+    otsikko.lisaa("Nimike");
+
+    // Ennusteen kaudet päättyvät tilikausien mukaan, ja perustamattomat
+    // tilikaudet oletetaan vuoden mittaisiksi
+    QList<PoistoLaskelma> kaudet;
+    kaudet.append( laskelma );
+    for(int i=1; i < ENNUSTEKAUSIA; i++)
+    {
+        QDate edellinen = kaudet.last().paattyy();
+        QDate paattyy = kp()->tilikaudet()->tilikausiPaivalle( edellinen.addDays(1) ).paattyy();
+        if( !paattyy.isValid())
+            paattyy = edellinen.addYears(1);
+        kaudet.append( kaudet.last().seuraava(paattyy) );
+    }
+
+    QList<QHash<int,qlonglong>> poistot;
+    for( const PoistoLaskelma& kausi : kaudet)
+    {
+        kirjoittaja.lisaaEurosarake();
+        otsikko.lisaa( kausi.paattyy().toString("dd.MM.yyyy"), 1, true);
+        poistot.append( kausi.poistotTileittain());
+    }
+    kirjoittaja.lisaaOtsake(otsikko);
+
+    QVector<qlonglong> yhteensa( kaudet.count() );
+    int edellinenTili = 0;
+    for( const PoistoLaskelma::Kohde& kohde : laskelma.kohteet())
+    {
+        if( kohde.tiliId == edellinenTili)
+            continue;
+        edellinenTili = kohde.tiliId;
+
+        Tili tili = kp()->tilit()->tiliIdlla( kohde.tiliId );
+        RaporttiRivi rr;
+        rr.lisaaLinkilla(RaporttiRiviSarake::TILI_LINKKI, tili.id(), QString::number(tili.numero()) );
+        rr.lisaa( tili.nimi());
+        for(int i=0; i < poistot.count(); i++)
+        {
+            rr.lisaa( poistot.at(i).value( tili.id()), true);
+            yhteensa[i] += poistot.at(i).value( tili.id());
+        }
+        kirjoittaja.lisaaRivi(rr);
+    }
+
+    RaporttiRivi summa;
+    summa.lisaa( tr("Yhteensä"), 2);
+    for( qlonglong sentit : yhteensa)
+        summa.lisaa( sentit, true);
+    summa.lihavoi();
+    summa.viivaYlle();
+    kirjoittaja.lisaaRivi(summa);
+
+    return kirjoittaja;
+}
+
 bool Poistaja::onkoPoistoja(const Tilikausi& kausi)
 {
 
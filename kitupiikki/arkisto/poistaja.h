@@ -21,6 +21,9 @@
 #include <QDialog>
 
 #include "db/kirjanpito.h"
+#include "raportti/raportinkirjoittaja.h"
+
+class PoistoLaskelma;
 
 namespace Ui {
 class Poistaja;
@@ -58,6 +61,22 @@ public:
      */
     bool static onkoPoistoja(const Tilikausi &kausi);
 
+    /**
+     * @brief Montako tilikautta poistoennuste kattaa
+     */
+    enum { ENNUSTEKAUSIA = 5 };
+
+    /**
+     * @brief Poistoennuste tileittäin tulevilta tilikausilta
+     *
+     * Ennuste lasketaan muistissa kauden laskelmasta olettaen,
+     * ettei uusia hankintoja tule.
+     *
+     * @param laskelma Ensimmäisen kauden poistolaskelma
+     * @since 1.5
+     */
+    static RaportinKirjoittaja ennuste(const PoistoLaskelma& laskelma);
+
 private:
     bool sumupoistaja(Tilikausi kausi);
 
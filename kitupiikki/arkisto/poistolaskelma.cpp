@@ -0,0 +1,189 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+
+#include "poistolaskelma.h"
+#include "db/kirjanpito.h"
+
+#include <QSqlQuery>
+#include <QStringList>
+#include <QPair>
+
+PoistoLaskelma::PoistoLaskelma()
+{
+
+}
+
+PoistoLaskelma PoistoLaskelma::laske(const QDate &paattyy)
+{
+    PoistoLaskelma laskelma;
+    laskelma.paattyy_ = paattyy;
+
+    QStringList menojaannosTilit;
+    QStringList tasaeraTilit;
+    for( int i=0; i < kp()->tilit()->rowCount(QModelIndex()); i++)
+    {
+        Tili tili = kp()->tilit()->tiliIndeksilla(i);
+        if( tili.onko(TiliLaji::MENOJAANNOSPOISTO))
+            menojaannosTilit.append( QString::number(tili.id()));
+        else if( tili.onko(TiliLaji::TASAERAPOISTO))
+            tasaeraTilit.append( QString::number(tili.id()));
+    }
+
+    QString pvm = paattyy.toString(Qt::ISODate);
+    QSqlQuery kysely( *kp()->tietokanta() );
+
+    // Menojäännöspoistojen saldot kaikille tileille ja kohdennuksille kerralla
+    QHash<int, QList<QPair<int,qlonglong>>> saldot;
+    if( !menojaannosTilit.isEmpty())
+    {
+        kysely.exec( QString("SELECT tili, kohdennus, SUM(debetsnt), SUM(kreditsnt) FROM vienti "
+                             "WHERE tili IN (%1) AND pvm <= '%2' GROUP BY tili, kohdennus ORDER BY tili, kohdennus")
+                     .arg( menojaannosTilit.join(',')).arg(pvm));
+        while( kysely.next())
+            saldot[ kysely.value(0).toInt() ].append( qMakePair( kysely.value(1).toInt(),
+                                                                 kysely.value(2).toLongLong() - kysely.value(3).toLongLong() ));
+    }
+
+    // Tasaeräpoistojen tase-erät hankintamenoineen ja saldoineen
+    QHash<int, QList<Kohde>> erat;
+    if( !tasaeraTilit.isEmpty())
+    {
+        kysely.exec( QString("SELECT alku.id, alku.tili, alku.pvm, alku.selite, alku.debetsnt, alku.kreditsnt, "
+                             "alku.json, alku.kohdennus, SUM(vienti.debetsnt), SUM(vienti.kreditsnt) "
+                             "FROM vienti JOIN vienti AS alku ON alku.id=vienti.eraid "
+                             "WHERE alku.tili IN (%1) AND alku.eraid=alku.id AND vienti.tili=alku.tili "
+                             "AND vienti.pvm <= '%2' GROUP BY alku.id ORDER BY alku.pvm")
+                     .arg( tasaeraTilit.join(',')).arg(pvm));
+        while( kysely.next())
+        {
+            Kohde era;
+            era.eraId = kysely.value(0).toInt();
+            era.tiliId = kysely.value(1).toInt();
+            era.pvm = kysely.value(2).toDate();
+            era.selite = kysely.value(3).toString();
+            era.alkuSnt = kysely.value(4).toLongLong() - kysely.value(5).toLongLong();
+            era.poistoKk = JsonKentta( kysely.value(6).toByteArray()).luku("Tasaerapoisto");
+            era.kohdennusId = kysely.value(7).toInt();
+            era.saldoSnt = kysely.value(8).toLongLong() - kysely.value(9).toLongLong();
+
+            if( era.poistoKk && era.saldoSnt)
+                erat[ era.tiliId ].append(era);
+        }
+    }
+
+    // Kohteet tilikartan järjestyksessä
+    for( int i=0; i < kp()->tilit()->rowCount(QModelIndex()); i++)
+    {
+        Tili tili = kp()->tilit()->tiliIndeksilla(i);
+
+        if( saldot.contains( tili.id()))
+        {
+            int prosentti = tili.json()->luku("Menojaannospoisto");
+
+            if( tili.json()->luku("Kohdennukset"))
+            {
+                // #123: Kohdennuksilla käsiteltävän tilin poistot lasketaan kohdennuksittain
+                for( const auto& kohdennuksenSaldo : saldot.value(tili.id()))
+                {
+                    if( !kohdennuksenSaldo.second)
+                        continue;
+
+                    Kohde kohde;
+                    kohde.tiliId = tili.id();
+                    kohde.kohdennusId = kohdennuksenSaldo.first;
+                    kohde.prosentti = prosentti;
+                    kohde.saldoSnt = kohdennuksenSaldo.second;
+                    laskelma.laskePoisto(kohde);
+                    laskelma.kohteet_.append(kohde);
+                }
+            }
+            else
+            {
+                Kohde kohde;
+                kohde.tiliId = tili.id();
+                kohde.prosentti = prosentti;
+                for( const auto& kohdennuksenSaldo : saldot.value(tili.id()))
+                    kohde.saldoSnt += kohdennuksenSaldo.second;
+
+                if( kohde.saldoSnt )
+                {
+                    laskelma.laskePoisto(kohde);
+                    laskelma.kohteet_.append(kohde);
+                }
+            }
+        }
+        else if( erat.contains( tili.id()))
+        {
+            for( Kohde era : erat.value(tili.id()))
+            {
+                laskelma.laskePoisto(era);
+                laskelma.kohteet_.append(era);
+            }
+        }
+    }
+
+    return laskelma;
+}
+
+PoistoLaskelma PoistoLaskelma::seuraava(const QDate &paattyy) const
+{
+    PoistoLaskelma laskelma;
+    laskelma.paattyy_ = paattyy;
+
+    for( Kohde kohde : kohteet_)
+    {
+        kohde.saldoSnt -= kohde.poistoSnt;
+        if( !kohde.saldoSnt )
+            continue;
+
+        laskelma.laskePoisto(kohde);
+        laskelma.kohteet_.append(kohde);
+    }
+    return laskelma;
+}
+
+QHash<int, qlonglong> PoistoLaskelma::poistotTileittain() const
+{
+    QHash<int, qlonglong> poistot;
+    for( const Kohde& kohde : kohteet_)
+        poistot[ kohde.tiliId ] += kohde.poistoSnt;
+    return poistot;
+}
+
+void PoistoLaskelma::laskePoisto(PoistoLaskelma::Kohde &kohde) const
+{
+    if( kohde.onkoTasaera())
+    {
+        // Montako kuukautta on kulunut hankinnasta
+        int kuukauttaKulunut = paattyy_.year() * 12 + paattyy_.month() -
+                               kohde.pvm.year() * 12 - kohde.pvm.month() + 1;
+
+        // Laskennallinen poisto: Paljonko tähän asti voitaisiin poistaa
+        qlonglong laskennallinenPoisto = kohde.alkuSnt * kuukauttaKulunut / kohde.poistoKk ;
+        if( laskennallinenPoisto > kohde.alkuSnt)
+            laskennallinenPoisto = kohde.alkuSnt; // Poistetaan vain se, mitä on jäljellä ...
+
+        kohde.poistoSnt = laskennallinenPoisto - kohde.alkuSnt + kohde.saldoSnt;
+    }
+    else
+    {
+        //  Menojäännöspoistossa poistetaan määrätty prosenttimäärä siihen asti olevasta saldosta
+        kohde.poistoSnt = std::round( kohde.saldoSnt * kohde.prosentti / 100.0 );
+    }
+}
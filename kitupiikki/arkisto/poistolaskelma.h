@@ -0,0 +1,100 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POISTOLASKELMA_H
+#define POISTOLASKELMA_H
+
+#include <QDate>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Suunnitelman mukaisten poistojen laskelma
+ *
+ * Laskee kaikkien poistettavien tilien poistot kahdella ryhmitellyllä
+ * kyselyllä: menojäännöspoistojen saldot tileittäin ja kohdennuksittain
+ * sekä tasaeräpoistojen tase-erien saldot. Laskelma ei kirjoita mitään
+ * tietokantaan, joten sillä voi esikatsella poistoja ennen kirjaamista.
+ *
+ * Seuraavien tilikausien poistot ennustetaan laskelmasta muistissa
+ * olettaen, ettei uusia hankintoja tule.
+ *
+ * @since 1.5
+ */
+class PoistoLaskelma
+{
+public:
+    /**
+     * @brief Yksi poistettava kohde
+     *
+     * Menojäännöspoistossa kohde on tili tai kohdennuksia käyttävällä tilillä
+     * tilin kohdennus, tasaeräpoistossa tase-erä.
+     */
+    struct Kohde
+    {
+        int tiliId = 0;
+        int kohdennusId = 0;
+        int eraId = 0;              ///< Tasaeräpoiston tase-erä
+        QDate pvm;                  ///< Tase-erän päivämäärä
+        QString selite;             ///< Tase-erän selite
+        qlonglong alkuSnt = 0;      ///< Tase-erän hankintameno
+        int poistoKk = 0;           ///< Tasaeräpoiston poistoaika kuukausina
+        int prosentti = 0;          ///< Menojäännöspoiston prosentti
+        qlonglong saldoSnt = 0;     ///< Saldo ennen poistoa
+        qlonglong poistoSnt = 0;
+
+        bool onkoTasaera() const { return eraId != 0; }
+    };
+
+    PoistoLaskelma();
+
+    /**
+     * @brief Laskee tilikauden poistot kirjanpidon saldoista
+     * @param paattyy Tilikauden päättymispäivä
+     */
+    static PoistoLaskelma laske(const QDate& paattyy);
+
+    /**
+     * @brief Ennustaa seuraavan tilikauden poistot
+     *
+     * Saldoiksi tulevat tämän laskelman poistojen jälkeiset saldot.
+     *
+     * @param paattyy Seuraavan tilikauden päättymispäivä
+     */
+    PoistoLaskelma seuraava(const QDate& paattyy) const;
+
+    QDate paattyy() const { return paattyy_; }
+
+    /**
+     * @brief Poistettavat kohteet tilien järjestyksessä
+     */
+    const QVector<Kohde>& kohteet() const { return kohteet_; }
+
+    /**
+     * @brief Poistojen yhteismäärät tilien id:illä
+     */
+    QHash<int,qlonglong> poistotTileittain() const;
+
+protected:
+    void laskePoisto(Kohde& kohde) const;
+
+    QDate paattyy_;
+    QVector<Kohde> kohteet_;
+};
+
+#endif // POISTOLASKELMA_H
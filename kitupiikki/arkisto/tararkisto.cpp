@@ -20,6 +20,7 @@
 #include <QByteArray>
 
 #include <QDateTime>
+#include <QCryptographicHash>
 
 #include "tararkisto.h"
 
@@ -41,7 +42,7 @@ bool TarArkisto::aloita()
     return open( QIODevice::WriteOnly);
 }
 
-bool TarArkisto::lisaaTiedosto(const QString &polku)
+bool TarArkisto::lisaaTiedosto(const QString &polku, const QByteArray &tiiviste)
 {
     QFileInfo info(polku);
 
@@ -89,17 +90,47 @@ bool TarArkisto::lisaaTiedosto(const QString &polku)
     // Nyt otsake on valmis kirjoitettavaksi
     write( otsake );
 
-    // Sitten vielä kirjoitetaan tiedosto
-    write( in.readAll() );
+    // Sitten vielä kirjoitetaan tiedosto lohkoittain
+    QCryptographicHash sha( QCryptographicHash::Sha256 );
+    QByteArray lohko;
+    qint64 kirjoitettu = 0;
+    while( !in.atEnd())
+    {
+        lohko = in.read( LOHKO );
+        if( lohko.isEmpty() || write( lohko ) != lohko.size())
+            return false;
+        if( !tiiviste.isEmpty())
+            sha.addData( lohko );
+        kirjoitettu += lohko.size();
+    }
 
     // Ja lopuksi täytetään viimeinen tietue
-    int jaannos = 512 - info.size() % 512;
-    QByteArray tyhja( jaannos, '\0');
-    write( tyhja );
+    if( kirjoitettu % 512 )
+    {
+        QByteArray tyhja( 512 - kirjoitettu % 512, '\0');
+        write( tyhja );
+    }
 
+    return kirjoitettu == info.size() &&
+            ( tiiviste.isEmpty() || sha.result().toHex() == tiiviste );
 
-    return true;
+}
 
+QHash<QString, QByteArray> TarArkisto::lueTiivisteet(const QDir &hakemisto)
+{
+    QHash<QString, QByteArray> tiivisteet;
+    QFile tiedosto( hakemisto.absoluteFilePath("arkisto.sha256"));
+    if( tiedosto.open(QIODevice::ReadOnly))
+    {
+        while( !tiedosto.atEnd())
+        {
+            QByteArray rivi = tiedosto.readLine().trimmed();
+            int vali = rivi.indexOf(' ');
+            if( vali > 0)
+                tiivisteet.insert( QString::fromLatin1( rivi.mid(vali + 1)), rivi.left(vali) );
+        }
+    }
+    return tiivisteet;
 }
 
 void TarArkisto::lopeta()
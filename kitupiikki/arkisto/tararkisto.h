@@ -20,6 +20,8 @@
 
 #include <QFile>
 #include <QByteArray>
+#include <QHash>
+#include <QDir>
 
 /**
  * @brief Tar-arkiston muodostaminen
@@ -38,10 +40,25 @@ public:
 
     /**
      * @brief Lisää tiedoston arkistoon
+     *
+     * Tiedosto kopioidaan arkistoon lohkoittain, ja sen sha256-tiiviste
+     * lasketaan kopioinnin aikana.
+     *
      * @param polku Polku tiedostoon
-     * @return tosi, jos onnistui
+     * @param tiiviste Odotettu sha256-tiiviste heksana, tyhjä jos ei tarkasteta
+     * @return tosi, jos onnistui ja tiiviste täsmää
      */
-    bool lisaaTiedosto(const QString& polku);
+    bool lisaaTiedosto(const QString& polku, const QByteArray& tiiviste = QByteArray());
+
+    /**
+     * @brief Lukee arkistohakemiston arkisto.sha256-tiedoston
+     * @param hakemisto Arkistohakemisto
+     * @return Tiivisteet tiedostonnimen mukaan
+     * @since 1.5
+     */
+    static QHash<QString,QByteArray> lueTiivisteet(const QDir& hakemisto);
+
+    static const int LOHKO = 64 * 1024;
 
     /**
      * @brief Kirjoittaa päättävät kentät ja sulkee tiedoston
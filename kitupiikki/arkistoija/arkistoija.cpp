@@ -33,6 +33,7 @@
 #include "raportti/tilikarttaraportti.h"
 #include "raportti/tositeluetteloraportti.h"
 #include "raportti/taseerittely.h"
+#include "raportti/raporttivirta.h"
 
 #include <QDebug>
 
@@ -606,6 +607,31 @@ void Arkistoija::arkistoiByteArray(const QString &tiedostonnimi, const QByteArra
     shaBytes.append("\n");
 }
 
+void Arkistoija::arkistoiRaportti(const QString &tiedostonnimi, const std::function<void (RaporttiKohde &)> &kirjoita)
+{
+    QFile tiedosto( hakemisto_.absoluteFilePath(tiedostonnimi));
+    tiedosto.open( QIODevice::WriteOnly);
+
+    // Rivit kirjoitetaan tiedostoon sitä mukaa kun ne muodostetaan,
+    // joten suurta pää- tai päiväkirjaa ei pidetä muistissa
+    HtmlRaporttiVirta virta( &tiedosto, true);
+    virta.lisaaAlkuun("<link rel='stylesheet' type='text/css' href='arkisto.css'>", navipalkki());
+    kirjoita( virta );
+    virta.valmis();
+    tiedosto.close();
+
+    // SHA-varmistus luetaan tiedostosta
+    QCryptographicHash hash( QCryptographicHash::Sha256);
+    tiedosto.open( QIODevice::ReadOnly);
+    hash.addData( &tiedosto );
+    tiedosto.close();
+
+    shaBytes.append( hash.result().toHex());
+    shaBytes.append(" ");
+    shaBytes.append(tiedostonnimi.toLatin1());
+    shaBytes.append("\n");
+}
+
 void Arkistoija::kirjoitaHash()
 {
     QFile tiedosto( hakemisto_.absoluteFilePath( "arkisto.sha256" ));
@@ -656,10 +682,10 @@ QString Arkistoija::arkistoi(Tilikausi &tilikausi)
 
     arkistoija.arkistoiTiedosto("taseerittely.html",
                                  TaseErittely::kirjoitaRaportti( tilikausi.alkaa(), tilikausi.paattyy()).html(true) );
-    arkistoija.arkistoiTiedosto("paivakirja.html",
-                                PaivakirjaRaportti::kirjoitaRaportti( tilikausi.alkaa(), tilikausi.paattyy(), -1, false, false, true, true).html(true) );
-    arkistoija.arkistoiTiedosto("paakirja.html",
-                                PaakirjaRaportti::kirjoitaRaportti( tilikausi.alkaa(), tilikausi.paattyy(), -1, true, true).html(true));
+    arkistoija.arkistoiRaportti("paivakirja.html", [&tilikausi] (RaporttiKohde& kohde)
+        { PaivakirjaRaportti::kirjoitaRaportti( kohde, tilikausi.alkaa(), tilikausi.paattyy(), -1, false, false, true, true); } );
+    arkistoija.arkistoiRaportti("paakirja.html", [&tilikausi] (RaporttiKohde& kohde)
+        { PaakirjaRaportti::kirjoitaRaportti( kohde, tilikausi.alkaa(), tilikausi.paattyy(), -1, true, true); } );
     arkistoija.arkistoiTiedosto("tililuettelo.html",
                                 TilikarttaRaportti::kirjoitaRaportti(TilikarttaRaportti::KAYTOSSA_TILIT, tilikausi, true, false, tilikausi.paattyy(),true).html(true));
     arkistoija.arkistoiTiedosto("tositeluettelo.html",
@@ -30,8 +30,12 @@
 #include <QTextStream>
 #include <QBuffer>
 
+#include <functional>
+
 #include "db/kirjanpito.h"
 
+class RaporttiKohde;
+
 /**
  * @brief Arkiston kirjoittaja
  */
@@ -51,6 +55,13 @@ protected:
 
     void arkistoiByteArray(const QString& tiedostonnimi, const QByteArray& array);
 
+    /**
+     * @brief Kirjoittaa raportin suoraan arkiston tiedostoon
+     * @param kirjoita Funktio, joka kirjoittaa raportin rivit kohteeseen
+     */
+    void arkistoiRaportti(const QString& tiedostonnimi,
+                          const std::function<void(RaporttiKohde&)>& kirjoita);
+
     void kirjoitaHash();
 
     QString navipalkki(int edellinen=0, int seuraava=0);
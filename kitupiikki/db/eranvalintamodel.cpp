@@ -21,6 +21,7 @@
 
 #include <QHash>
 #include <QPair>
+#include <QStringList>
 
 #include <QDebug>
 
@@ -87,6 +88,27 @@ void EranValintaModel::lataa(const Tili& tili, bool kaikki, QDate paivalle)
 
     QSqlQuery query( *(kp()->tietokanta()) ) ;
 
+    if( !paivalle.isValid())
+    {
+        // Nykyiset saldot ovat valmiina era-taulussa
+        query.exec(QString("SELECT vienti.id, vienti.pvm, vienti.selite, vienti.tosite, era.saldosnt "
+                           "FROM era JOIN vienti ON vienti.id=era.id "
+                           "WHERE era.tili=%1 %2 ORDER BY vienti.pvm")
+                   .arg(tili.id()).arg( kaikki ? QString() : QString("AND era.saldosnt <> 0")));
+        while( query.next())
+        {
+            TaseEra era;
+            era.eraId = query.value(0).toInt();
+            era.pvm = query.value(1).toDate();
+            era.selite = query.value(2).toString();
+            era.tositeId = query.value(3).toInt();
+            era.saldoSnt = query.value(4).toLongLong();
+            erat_.append(era);
+        }
+        endResetModel();
+        return;
+    }
+
     // avaimena eraid, arvona saldo (debet - kredit)
     QHash<int, qlonglong > saldot;
 
@@ -134,26 +156,45 @@ TaseEra::TaseEra(int id)
     if(id)
     {
         QSqlQuery query( *( kp()->tietokanta() ));
-        query.exec(QString("SELECT sum(debetsnt),sum(kreditsnt) from vienti "
-                           "where eraid=%1").arg(id ));
-        if( query.next() )
-        {
-            saldoSnt = query.value(0).toLongLong();
-            saldoSnt -= query.value(1).toLongLong();
-        }
-
-        query.exec(QString("SELECT pvm, selite, tosite from vienti "
-                   "where id=%1").arg( id ));
+        query.exec(QString("SELECT vienti.pvm, vienti.selite, vienti.tosite, era.saldosnt "
+                           "FROM vienti LEFT OUTER JOIN era ON era.id=vienti.id "
+                           "WHERE vienti.id=%1").arg( id ));
         if( query.next())
         {
-            pvm = query.value("pvm").toDate();
-            selite = query.value("selite").toString();
-            tositeId = query.value("tosite").toInt();
+            pvm = query.value(0).toDate();
+            selite = query.value(1).toString();
+            tositeId = query.value(2).toInt();
+            saldoSnt = query.value(3).toLongLong();
         }
 
     }
 }
 
+bool TaseEra::paivitaSaldot(const QSet<int> &erat)
+{
+    QStringList idt;
+    for( int era : erat)
+        if( era > 0)
+            idt.append( QString::number(era));
+    if( idt.isEmpty() && !erat.isEmpty())
+        return true;
+
+    QString ehto = idt.isEmpty() ? QString("IS NOT NULL") : QString("IN (%1)").arg( idt.join(','));
+
+    QSqlQuery query( *( kp()->tietokanta() ));
+    if( !query.exec( QString("DELETE FROM era WHERE id %1").arg(ehto)) ||
+        !query.exec( QString("INSERT INTO era(id, tili, saldosnt, viite, asiakas, erapvm, paivitetty) "
+                             "SELECT alku.id, alku.tili, IFNULL(SUM(vienti.debetsnt),0) - IFNULL(SUM(vienti.kreditsnt),0), "
+                             "alku.viite, alku.asiakas, alku.erapvm, MAX(vienti.pvm) "
+                             "FROM vienti JOIN vienti AS alku ON alku.id=vienti.eraid "
+                             "WHERE vienti.eraid %1 GROUP BY alku.id").arg(ehto)))
+    {
+        kp()->lokiin(query);
+        return false;
+    }
+    return true;
+}
+
 QString TaseEra::tositteenTunniste()
 {
     if(eraId)
@@ -20,6 +20,7 @@
 
 #include <QAbstractListModel>
 #include <QList>
+#include <QSet>
 #include "tili.h"
 
 
@@ -45,6 +46,18 @@ struct TaseEra
      */
     QString tositteenTunniste();
 
+    /**
+     * @brief Päivittää erien saldot era-tauluun
+     *
+     * Kutsutaan vientien tallennuksen ja poiston yhteydessä samassa
+     * transaktiossa niille erille, joihin muutos vaikuttaa.
+     *
+     * @param erat Päivitettävien erien id:t, tyhjä päivittää kaikki erät
+     * @return tosi, jos onnistui
+     * @since 1.5
+     */
+    static bool paivitaSaldot(const QSet<int>& erat = QSet<int>());
+
     int eraId;
     QDate pvm;
     QString selite;
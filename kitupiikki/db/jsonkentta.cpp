@@ -23,122 +23,126 @@
 
 #include <QDebug>
 
-JsonKentta::JsonKentta() : muokattu_(false)
+JsonKentta::JsonKentta() : d_(new Data), muokattu_(false)
 {
 
 }
 
-JsonKentta::JsonKentta(const QByteArray &json) : muokattu_(false)
+JsonKentta::JsonKentta(const QByteArray &json) : d_(new Data), muokattu_(false)
 {
     fromJson(json);
 }
 
 void JsonKentta::set(const QString &avain, const QString &arvo)
 {
-    if( arvo != map_.value(avain).toString())
+    if( arvo != kartta().value(avain).toString())
     {
         if( arvo.isEmpty())
-            map_.remove(avain);
+            muokattava().remove(avain);
         else
-            map_[avain] = QVariant(arvo);
+            muokattava()[avain] = QVariant(arvo);
         muokattu_ = true;
     }
 }
 
 void JsonKentta::set(const QString &avain, const QDate &pvm)
 {
-    if( pvm != QDate::fromString(map_.value(avain).toString(), Qt::ISODate))
+    if( pvm != QDate::fromString(kartta().value(avain).toString(), Qt::ISODate))
     {
-        map_[avain] = QVariant(pvm.toString(Qt::ISODate));
+        muokattava()[avain] = QVariant(pvm.toString(Qt::ISODate));
         muokattu_ = true;
     }
 }
 
 void JsonKentta::set(const QString &avain, int arvo)
 {
-    if( map_.value(avain).toInt() != arvo )
+    if( kartta().value(avain).toInt() != arvo )
     {
-        map_[avain] = QVariant(arvo);
+        muokattava()[avain] = QVariant(arvo);
         muokattu_ = true;
     }
 }
 
 void JsonKentta::set(const QString &avain, qulonglong arvo)
 {
-    if( map_.value(avain).toULongLong() != arvo )
+    if( kartta().value(avain).toULongLong() != arvo )
     {
-        map_[avain] = QVariant(arvo);
+        muokattava()[avain] = QVariant(arvo);
         muokattu_ = true;
     }
 }
 
 void JsonKentta::set(const QString &avain, qlonglong arvo)
 {
-    if( map_.value(avain).toLongLong() != arvo )
+    if( kartta().value(avain).toLongLong() != arvo )
     {
-        map_[avain] = QVariant(arvo);
+        muokattava()[avain] = QVariant(arvo);
         muokattu_ = true;
     }
 }
 
 void JsonKentta::unset(const QString &avain)
 {
-    if( map_.contains(avain))
+    if( kartta().contains(avain))
     {
-        map_.remove(avain);
+        muokattava().remove(avain);
         muokattu_ = true;
     }
 }
 
 void JsonKentta::setVar(const QString &avain, const QVariant &arvo)
 {
-    if( map_.value(avain) != arvo)
+    if( kartta().value(avain) != arvo)
     {
-        map_[avain] = arvo;
+        muokattava()[avain] = arvo;
         muokattu_ = true;
     }
 }
 
 QString JsonKentta::str(const QString &avain)
 {
-    return map_.value(avain).toString();
+    return kartta().value(avain).toString();
 }
 
 QDate JsonKentta::date(const QString &avain)
 {
-    return QDate::fromString( map_.value(avain).toString() , Qt::ISODate);
+    return QDate::fromString( kartta().value(avain).toString() , Qt::ISODate);
 }
 
 int JsonKentta::luku(const QString &avain, int oletus)
 {
-    return map_.value(avain, QString::number(oletus) ).toInt();
+    return kartta().value(avain, QString::number(oletus) ).toInt();
 }
 
 qlonglong JsonKentta::pitkaluku(QString &avain)
 {
-    return map_.value(avain).toLongLong();
+    return kartta().value(avain).toLongLong();
 }
 
 qulonglong JsonKentta::isoluku(const QString &avain)
 {
-    return map_.value(avain).toULongLong();
+    return kartta().value(avain).toULongLong();
 }
 
 QVariant JsonKentta::variant(const QString &avain)
 {
-    return map_.value(avain);
+    return kartta().value(avain);
 }
 
-QByteArray JsonKentta::toJson()
+QByteArray JsonKentta::toJson() const
 {
-    QJsonDocument doc( QJsonObject::fromVariantMap( map_ ));
+    // Muokkaamaton kenttä kirjoitetaan takaisin sellaisenaan ilman jaetun datan kopiointia
+    if( !d_->json.isEmpty())
+        return d_->json;
+
+    QJsonDocument doc( QJsonObject::fromVariantMap( kartta() ));
     return doc.toJson( QJsonDocument::Compact);
 }
 
 QVariant JsonKentta::toSqlJson()
 {
     muokattu_ = false;
-    if( map_.count())
+    if( kartta().count())
         return QVariant( toJson() );
     else
         return QVariant();
@@ -146,7 +150,29 @@ QVariant JsonKentta::toSqlJson()
 
 void JsonKentta::fromJson(const QByteArray &json)
 {
-    QJsonDocument doc = QJsonDocument::fromJson( json );
-    map_ = doc.object().toVariantMap();
+    d_ = new Data;
+    if( !json.isEmpty())
+    {
+        d_->json = json;
+        d_->jasennetty = false;
+    }
     muokattu_ = false;
 }
+
+const QVariantMap &JsonKentta::kartta() const
+{
+    if( !d_->jasennetty )
+    {
+        QJsonDocument doc = QJsonDocument::fromJson( d_->json );
+        d_->map = doc.object().toVariantMap();
+        d_->jasennetty = true;
+    }
+    return d_->map;
+}
+
+QVariantMap &JsonKentta::muokattava()
+{
+    kartta();
+    d_->json.clear();       // Irrottaa jaetuista tiedoista
+    return d_->map;
+}
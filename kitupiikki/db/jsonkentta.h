@@ -21,6 +21,7 @@
 #include <QDate>
 #include <QMap>
 #include <QVariant>
+#include <QSharedData>
 
 /**
  * @brief json-muotoisten kenttien käsittely
@@ -28,6 +29,11 @@
  * Laajennettavuutta ja yksinkertaisempaa tietokantaa silmällä pitäen käytetään
  * json-muotoisia kenttiä, joita käsitellään tämän luokan kautta
  *
+ * Json jäsennetään vasta, kun kentästä luetaan ensimmäisen kerran, ja
+ * jäsennetyt tiedot jaetaan kopioiden kesken (implicit sharing).
+ * Muokkaamattoman kentän tallennus palauttaa alkuperäisen jsonin
+ * sellaisenaan.
+ *
  */
 class JsonKentta
 {
@@ -49,9 +55,9 @@ public:
     qlonglong pitkaluku(QString& avain);
     qulonglong isoluku(const QString& avain);
     QVariant variant(const QString& avain);
-    QStringList avaimet() const { return map_.keys(); }
+    QStringList avaimet() const { return kartta().keys(); }
 
-    QByteArray toJson();
+    QByteArray toJson() const;
     QVariant toSqlJson();
     void fromJson(const QByteArray& json);
 
@@ -66,7 +72,24 @@ public:
     bool onkoMuokattu() const { return muokattu_; }
 
 protected:
-    QVariantMap map_;
+    /**
+     * @brief Jaetut tiedot
+     *
+     * Jäsennys tehdään laiskasti, joten jäsennetyt kentät ovat mutable.
+     * @since 1.5
+     */
+    class Data : public QSharedData
+    {
+    public:
+        QByteArray json;            ///< Alkuperäinen json, tyhjä kun kenttää on muokattu
+        mutable QVariantMap map;
+        mutable bool jasennetty = true;
+    };
+
+    const QVariantMap& kartta() const;
+    QVariantMap& muokattava();
+
+    QSharedDataPointer<Data> d_;
     bool muokattu_;
 };
 
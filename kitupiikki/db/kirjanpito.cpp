@@ -30,6 +30,7 @@
 #include <QTextStream>
 #include <QBuffer>
 #include <QRandomGenerator>
+#include <QElapsedTimer>
 
 #include <QDebug>
 
@@ -37,6 +38,7 @@
 
 #include "kirjanpito.h"
 #include "naytin/naytinikkuna.h"
+#include "raportti/raporttivalimuisti.h"
 
 Kirjanpito::Kirjanpito(const QString& portableDir) : QObject(nullptr),
     harjoitusPvm( QDate::currentDate()), tempDir_(nullptr), portableDir_(portableDir)
@@ -60,24 +62,16 @@ Kirjanpito::Kirjanpito(const QString& portableDir) : QObject(nullptr),
     veroTyypit_ = new VerotyyppiModel(this);
     tiliTyypit_ = new TilityyppiModel(this);
     tuotteet_ = new TuoteModel(this);
+    muutosloki_ = new MuutosLoki(&tietokanta_, this);
     liitteet_ = nullptr;
-
-    printer_ = new QPrinter(QPrinter::HighResolution);
-
-    // Jos järjestelmässä ei ole yhtään tulostinta, otetaan käyttöön pdf-tulostus jotte
-    // saadaan dialogit
-
-    if( !printer_->isValid())
-        printer()->setOutputFileName( QDir::temp().absoluteFilePath("print.pdf") );
-
-    printer_->setPaperSize(QPrinter::A4);
-    printer_->setPageMargins(10,5,5,5, QPrinter::Millimeter);
+    printer_ = nullptr;
 }
 
 Kirjanpito::~Kirjanpito()
 {
     tietokanta_.close();
     delete tempDir_;
+    delete printer_;
 }
 
 QString Kirjanpito::asetus(const QString &avain) const
@@ -132,8 +126,44 @@ void Kirjanpito::avaaUrl(const QUrl &url)
     }
 }
 
+QPrinter *Kirjanpito::printer()
+{
+    if( !printer_ )
+    {
+        printer_ = new QPrinter(QPrinter::HighResolution);
+
+        // Jos järjestelmässä ei ole yhtään tulostinta, otetaan käyttöön pdf-tulostus jotte
+        // saadaan dialogit
+
+        if( !printer_->isValid())
+            printer_->setOutputFileName( QDir::temp().absoluteFilePath("print.pdf") );
+
+        printer_->setPaperSize(QPrinter::A4);
+        printer_->setPageMargins(10,5,5,5, QPrinter::Millimeter);
+    }
+    return printer_;
+}
+
 QString Kirjanpito::tilapainen(QString nimi) const
 {
+    if( !tempDir_ )
+    {
+        // Tilapäishakemiston luominen
+        // #124 Jos väliaikaistiedosto ei toimi...
+        tempDir_ = new QTemporaryDir();
+
+        if( !tempDir_->isValid())
+        {
+            delete tempDir_;
+
+            QFileInfo info( tiedostopolku() );
+
+            tempDir_ = new QTemporaryDir( info.dir().absoluteFilePath("Temp")  );
+            if( !tempDir_->isValid())
+                QMessageBox::critical(nullptr, tr("Tilapäishakemiston luominen epäonnistui"),
+                                      tr("Kitupiikki ei onnistunut luomaan tilapäishakemistoa. Raporttien ja laskujen esikatselu ei toimi."));
+        }
+    }
     return tempDir_->filePath(nimi.replace("XXXX", satujono(8)));
 }
 
@@ -149,10 +179,41 @@ bool Kirjanpito::onkoMaksuperusteinenAlv(const QDate &paiva) const
     return true;
 }
 
+QImage Kirjanpito::logo() const
+{
+    if( !logoLadattu_ )
+    {
+        // Luetaan vain logo, ettei kaikkia liitteitä tarvitse ladata
+        QSqlQuery kysely( tietokanta_ );
+        kysely.exec("SELECT data FROM liite WHERE tosite IS NULL AND otsikko='logo'");
+        logo_ = kysely.next() ? QImage::fromData( kysely.value(0).toByteArray(), "PNG" ) : QImage();
+        logoLadattu_ = true;
+    }
+    return logo_;
+}
+
+LiiteModel *Kirjanpito::liitteet() const
+{
+    if( !liitteet_ )
+        liitteet_ = new LiiteModel(nullptr, const_cast<Kirjanpito*>(this));
+    return liitteet_;
+}
+
+TuoteModel *Kirjanpito::tuotteet() const
+{
+    if( !tuotteetLadattu_ )
+    {
+        tuotteet_->lataa();
+        tuotteetLadattu_ = true;
+    }
+    return tuotteet_;
+}
+
 void Kirjanpito::asetaLogo(const QImage &logo)
 {
 
     logo_ = logo;
+    logoLadattu_ = true;
 
     QByteArray ba;
 
@@ -163,8 +224,8 @@ void Kirjanpito::asetaLogo(const QImage &logo)
     buffer.close();
 
     // Tallennetaan NULL-liitteeksi
-    liitteet_->asetaLiite( ba, "logo" );
-    liitteet_->tallenna();
+    liitteet()->asetaLiite( ba, "logo" );
+    liitteet()->tallenna();
 }
 
 QString Kirjanpito::arkistopolku() const
@@ -197,8 +258,33 @@ void Kirjanpito::lokiin(const QSqlQuery &kysely)
 
 bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
 {
+    // KITUPIIKKI_AJASTUS-ympäristömuuttujalla tulostetaan avaamisen vaiheiden kestot
+    const bool ajastus = qEnvironmentVariableIsSet("KITUPIIKKI_AJASTUS");
+    QElapsedTimer ajastin;
+    ajastin.start();
+    auto vaihe = [ajastus, &ajastin] (const char* nimi) {
+        if( ajastus )
+            qDebug() << "avaaTietokanta" << nimi << ajastin.restart() << "ms";
+    };
+
     tietokanta_.setDatabaseName(tiedosto);
     polkuTiedostoon_ = tiedosto;
+    avauskerta_++;
+
+    // Samassa polussa voi olla eri kirjanpito (esim. palautettu varmuuskopio),
+    // jonka muutoslokin versiot eivät ole vertailukelpoisia
+    RaporttiValimuisti::tyhjenna();
+
+    // Edellisen kirjanpidon tiedostot, liitteet ja tuotteet ladataan uudelleen
+    // vasta tarvittaessa
+    if( liitteet_ )
+        liitteet_->deleteLater();
+    liitteet_ = nullptr;
+    logo_ = QImage();
+    logoLadattu_ = false;
+    tuotteetLadattu_ = false;
+    delete tempDir_;
+    tempDir_ = nullptr;
 
     if( tiedosto.isEmpty())
     {
@@ -247,8 +333,11 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
     }
 
 
+    vaihe("avaus");
+
     // Ladataankin asetukset yms modelista
     asetusModel_->lataa();
+    vaihe("asetukset");
 
 
     if( asetusModel_->asetus("Nimi").isEmpty() || !asetusModel_->luku("KpVersio"))
@@ -281,6 +370,10 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
         return false;
     }
 
+    // Versiota 11 vanhemmat ohjelmat eivät ylläpidä laskurivi- ja era-tauluja,
+    // joten ne täytetään päivitettäessä uudelleen vienneistä
+    bool taytaJohdetut = asetusModel_->luku("KpVersio") < 11;
+
     //
     // Tiedostoversion muuttuessa tähän muutettava yhteensopivuusversio !!
     //
@@ -289,7 +382,7 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
         if( QMessageBox::question(nullptr, tr("Kirjanpidon %1 päivittäminen").arg(asetusModel_->asetus("Nimi")),
                                   tr("Kirjanpito on luotu Kitupiikin versiolla %1 ja se täytyy päivittää, ennen kuin sitä "
                                      "voi käyttää nykyisellä versiolla %2.\n\n"
-                                     "Päivittämisen jälkeen kirjanpitoa ei voi enää avata vanhemmilla versioilla kuin 0.11\n\n"
+                                     "Päivittämisen jälkeen kirjanpitoa ei voi enää avata Kitupiikin vanhemmilla versioilla.\n\n"
                                      "On erittäin suositeltavaa varmuuskopioida kirjanpito ennen päivittämistä!\n\n"
                                      "Päivitetäänkö tietokanta Kitupiikin nykyiselle versiolle?").arg(asetusModel_->asetus("LuotuVersiolla"))
                                      .arg(qApp->applicationVersion()),
@@ -384,9 +477,7 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
             QByteArray ba = logotiedosto.readAll();
             QImage logo = QImage::fromData(ba, "PNG");
 
-            liitteet_ = new LiiteModel(nullptr, this);
             asetaLogo(logo);
-            liitteet_->tallenna();
         }
 
         asetusModel_->aseta("KpVersio", TIETOKANTAVERSIO);
@@ -410,37 +501,99 @@ bool Kirjanpito::avaaTietokanta(const QString &tiedosto, bool ilmoitaVirheesta)
                        "                                                 ON UPDATE CASCADE"
                    ");");
 
-    tositelajiModel_->lataa();
-    tiliModel_->lataa();
-    tilikaudetModel_->lataa();
-    kohdennukset_->lataa();
-    tuotteet_->lataa();
-
-    // Tilapäishakemiston luominen
-    // #124 Jos väliaikaistiedosto ei toimi...
-    delete tempDir_;
-
-    tempDir_ = new QTemporaryDir();
+    // Muutosloki välimuistien mitätöimiseksi
+    tietokanta()->exec("CREATE TABLE IF NOT EXISTS muutos ("
+                       "id              INTEGER PRIMARY KEY AUTOINCREMENT,"
+                       "taulu           VARCHAR(20) NOT NULL,"
+                       "rivi            INTEGER,"
+                       "alkaa           DATE,"
+                       "paattyy         DATE,"
+                       "tilit           TEXT"
+                   ");");
+    muutosloki_->lataa();
 
-    if( !tempDir_->isValid())
+    // Laskujen rivit myyntiraporttia varten. Kun taulu puuttuu tai kirjanpito
+    // päivitetään, taulu täytetään laskujen json-kentistä.
     {
-        delete tempDir_;
+        QSqlQuery taulukysely( *tietokanta() );
+        taulukysely.exec("SELECT name FROM sqlite_master WHERE type='table' AND name='laskurivi'");
+        bool puuttuu = !taulukysely.next();
+        if( puuttuu || taytaJohdetut )
+        {
+            tietokanta()->transaction();
+            if( puuttuu )
+            {
+                tietokanta()->exec("CREATE TABLE laskurivi ("
+                                   "id              INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                   "vienti          INTEGER NOT NULL"
+                                   "                        REFERENCES vienti(id)  ON DELETE CASCADE"
+                                   "                                               ON UPDATE CASCADE,"
+                                   "nimike          TEXT,"
+                                   "maara           REAL,"
+                                   "nettosnt        BIGINT,"
+                                   "bruttosnt       BIGINT,"
+                                   "alvkoodi        INTEGER,"
+                                   "alvprosentti    INTEGER,"
+                                   "tili            INTEGER,"
+                                   "kohdennus       INTEGER,"
+                                   "tuote           INTEGER"
+                               ");");
+                tietokanta()->exec("CREATE INDEX laskurivi_vienti ON laskurivi(vienti)");
+                tietokanta()->exec("CREATE INDEX laskurivi_nimike ON laskurivi(nimike)");
+            }
+            else
+                tietokanta()->exec("DELETE FROM laskurivi");
 
-        QFileInfo info( kp()->tiedostopolku() );
+            taulukysely.exec("SELECT id, json FROM vienti WHERE viite IS NOT NULL AND json LIKE '%Laskurivit%'");
+            while( taulukysely.next())
+            {
+                JsonKentta json( taulukysely.value(1).toByteArray() );
+                VientiModel::tallennaLaskurivit( taulukysely.value(0).toInt(), json.variant("Laskurivit").toList() );
+            }
+            tietokanta()->commit();
+        }
 
-        tempDir_ = new QTemporaryDir( info.dir().absoluteFilePath("Temp")  );
-        if( !tempDir_->isValid())
-            QMessageBox::critical(nullptr, tr("Tilapäishakemiston luominen epäonnistui"),
-                                  tr("Kitupiikki ei onnistunut luomaan tilapäishakemistoa. Raporttien ja laskujen esikatselu ei toimi."));
+        // Tase-erien saldot ylläpidetään era-taulussa, joka täytetään
+        // vienneistä luotaessa ja kirjanpitoa päivitettäessä
+        taulukysely.exec("SELECT name FROM sqlite_master WHERE type='table' AND name='era'");
+        puuttuu = !taulukysely.next();
+        if( puuttuu || taytaJohdetut )
+        {
+            tietokanta()->transaction();
+            if( puuttuu )
+            {
+                tietokanta()->exec("CREATE TABLE era ("
+                                   "id              INTEGER PRIMARY KEY"
+                                   "                        REFERENCES vienti(id)  ON DELETE CASCADE"
+                                   "                                               ON UPDATE CASCADE,"
+                                   "tili            INTEGER,"
+                                   "saldosnt        BIGINT,"
+                                   "viite           VARCHAR(60),"
+                                   "asiakas         VARCHAR(60),"
+                                   "erapvm          DATE,"
+                                   "paivitetty      DATE"
+                               ");");
+                tietokanta()->exec("CREATE INDEX era_tili ON era(tili, saldosnt)");
+                tietokanta()->exec("CREATE INDEX era_viite ON era(viite)");
+            }
+            TaseEra::paivitaSaldot();
+            tietokanta()->commit();
+        }
     }
 
-    // Ladataan logo    
-    liitteet_ = new LiiteModel(nullptr, this);
-    logo_ = QImage::fromData( liitteet_->liite("logo") , "PNG" );
+    vaihe("rakenne");
 
+    // Kirjaamiseen ja selaamiseen tarvittavat mallit ladataan heti,
+    // tuotteet, liitteet, logo ja tilapäishakemisto vasta tarvittaessa
+    tositelajiModel_->lataa();
+    tiliModel_->lataa();
+    tilikaudetModel_->lataa();
+    kohdennukset_->lataa();
+    vaihe("mallit");
 
     // Ilmoitetaan, että tietokanta on vaihtunut
     emit tietokantaVaihtui();
+    vaihe("sivut");
 
     return true;
 }
@@ -45,6 +45,7 @@
 #include "kohdennusmodel.h"
 #include "verotyyppimodel.h"
 #include "tilityyppimodel.h"
+#include "muutosloki.h"
 
 #include "laskutus/tuotemodel.h"
 
@@ -84,6 +85,17 @@ public:
      */
     QString tiedostopolku() const { return polkuTiedostoon_;}
 
+    /**
+     * @brief Kirjanpidon avauskerran numero
+     *
+     * Kasvaa joka kerta, kun tietokanta avataan. Välimuistit vertaavat
+     * tätä polun sijaan, koska samassa polussa voi olla eri kirjanpito.
+     *
+     * @return
+     * @since 1.5
+     */
+    int avauskerta() const { return avauskerta_; }
+
     /**
      * @brief Käytetäänkö harjoittelutilassa
      * @return tosi, jos harjoitellaan
@@ -158,10 +170,20 @@ public:
     /**
      * @brief Palauttaa tuoteluettelon sisältävän modelin
      *
-     * Tuoteluettelosta voidaan laskutuksessa valita valmiita tuotteita
+     * Tuoteluettelosta voidaan laskutuksessa valita valmiita tuotteita.
+     * Tuotteet ladataan ensimmäisellä käyttökerralla.
      * @return
      */
-    TuoteModel *tuotteet() const { return tuotteet_; }
+    TuoteModel *tuotteet() const;
+
+    /**
+     * @brief Muutosloki ja kirjanpidon tietoversio
+     *
+     * Välimuistit voivat tarkistaa tästä, onko kirjanpitoa muutettu
+     * niiden laskemisen jälkeen
+     * @return
+     */
+    MuutosLoki *muutokset() const { return muutosloki_; }
 
     /**
      * @brief Sql-tietokanta
@@ -175,9 +197,13 @@ public:
 
     /**
      * @brief QPrinter kaikenlaiseen tulosteluun
+     *
+     * Tulostin luodaan vasta ensimmäisellä käyttökerralla, koska sen
+     * luominen kyselee tulostusjärjestelmää.
+     *
      * @return
      */
-    QPrinter *printer() { return printer_;}
+    QPrinter *printer();
 
     /**
      * @brief Näyttää halutun ohjesivun selaimessa
@@ -211,9 +237,12 @@ public:
 
     /**
      * @brief Palauttaa logon
+     *
+     * Logo luetaan tietokannasta ensimmäisellä käyttökerralla
+     *
      * @return
      */
-    QImage logo() const { return logo_;}
+    QImage logo() const;
 
     /**
      * @brief Asettaa kirjanpidon logon
@@ -223,9 +252,12 @@ public:
 
     /**
      * @brief Liitteet ilman tositetta (esim. logo, tilinpäätökset)
+     *
+     * Liitteet ladataan ensimmäisellä käyttökerralla
+     *
      * @return
      */
-    LiiteModel *liitteet() { return liitteet_;}
+    LiiteModel *liitteet() const;
 
     /**
      * @brief Arkistohakemiston polku
@@ -335,6 +367,7 @@ public slots:
 
 protected:
     QString polkuTiedostoon_;
+    int avauskerta_ = 0;
     QSqlDatabase tietokanta_;
     QMap<QString,QString> viimetiedostot;
     QDate harjoitusPvm;
@@ -347,11 +380,14 @@ protected:
     VerotyyppiModel *veroTyypit_;
     TilityyppiModel *tiliTyypit_;
     TuoteModel *tuotteet_;
-    LiiteModel *liitteet_;
+    MuutosLoki *muutosloki_;
+    mutable LiiteModel *liitteet_;
     QPrinter *printer_;
 
-    QTemporaryDir *tempDir_;
-    QImage logo_;
+    mutable QTemporaryDir *tempDir_;
+    mutable QImage logo_;
+    mutable bool logoLadattu_ = false;
+    mutable bool tuotteetLadattu_ = false;
 
     QSettings* settings_;
     QString portableDir_;      // Portable-ohjelman käynnistyshakemisto
@@ -381,9 +417,11 @@ public:
     /**
      * @brief Käytössä oleva tietokantaversio
      *
-     * Jos yritetään avata uudempaa, tulee virhe
+     * Jos yritetään avata uudempaa, tulee virhe.
+     * Versiosta 11 alkaen tietokannassa on vienneistä johdetut
+     * laskurivi- ja era-taulut.
      */
-    static const int TIETOKANTAVERSIO = 10;
+    static const int TIETOKANTAVERSIO = 11;
 
     /**
      * @brief Palauttaa satunnaismerkkijonon
@@ -0,0 +1,123 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "kirjausehdotukset.h"
+#include "kirjanpito.h"
+
+#include <QSqlQuery>
+#include <QRegularExpression>
+
+KirjausEhdotukset::KirjausEhdotukset()
+{
+
+}
+
+KirjausEhdotukset::Ehdotus KirjausEhdotukset::ehdota(const QString &selite, bool debet, int ohitaTili)
+{
+    static KirjausEhdotukset ehdotukset__;
+    ehdotukset__.paivita();
+
+    for( const QString& avain : avaimet(selite))
+    {
+        Ehdotus ehdotus = ehdotukset__.hae(avain, debet, ohitaTili);
+        if( ehdotus.kertoja )
+            return ehdotus;
+    }
+    return Ehdotus();
+}
+
+QStringList KirjausEhdotukset::avaimet(const QString &selite)
+{
+    static const QRegularExpression erottimet("[\\W\\d_]+", QRegularExpression::UseUnicodePropertiesOption);
+
+    QStringList sanat = selite.toLower().split(erottimet, QString::SkipEmptyParts);
+    QStringList avaimet;
+    if( sanat.isEmpty())
+        return avaimet;
+
+    avaimet.append( sanat.join(' '));
+    if( sanat.count() > 2)
+        avaimet.append( sanat.mid(0,2).join(' '));
+    return avaimet;
+}
+
+void KirjausEhdotukset::paivita()
+{
+    if( avauskerta_ != kp()->avauskerta())
+    {
+        tyhjenna();
+        avauskerta_ = kp()->avauskerta();
+    }
+    else if( !kp()->muutokset()->onkoMuuttunut(versio_))
+        return;
+    else if( laskettujaMuutettu() )
+        tyhjenna();
+
+    versio_ = kp()->muutokset()->versio();
+
+    // Luetaan vain edellisen päivityksen jälkeen lisätyt viennit
+    QSqlQuery kysely;
+    kysely.setForwardOnly(true);
+    kysely.exec( QString("SELECT id, tili, kohdennus, selite, debetsnt, tosite FROM vienti "
+                         "WHERE id > %1 AND tili IS NOT NULL AND selite IS NOT NULL AND selite <> '' "
+                         "AND arkistotunnus IS NULL ORDER BY id").arg(viimeisinId_));
+    while( kysely.next())
+    {
+        viimeisinId_ = kysely.value(0).toInt();
+        tositteet_.insert( kysely.value(5).toInt() );
+        QString puoli = kysely.value(4).toLongLong() ? "+" : "-";
+        qint64 tama = valinta( kysely.value(1).toInt(), kysely.value(2).toInt() );
+        for( const QString& avain : avaimet( kysely.value(3).toString()))
+            valinnat_[ puoli + avain ][ tama ]++;
+    }
+}
+
+void KirjausEhdotukset::tyhjenna()
+{
+    valinnat_.clear();
+    tositteet_.clear();
+    viimeisinId_ = 0;
+}
+
+bool KirjausEhdotukset::laskettujaMuutettu() const
+{
+    for( const TietoMuutos& muutos : kp()->muutokset()->muutokset(versio_))
+    {
+        // Rivitön muutos koskee useampaa tositetta (esim. tilinavaus)
+        if( ( muutos.taulu == "tosite" || muutos.taulu == "vienti") && !muutos.rivi )
+            return true;
+        if( muutos.taulu == "tosite" && tositteet_.contains( muutos.rivi ))
+            return true;
+    }
+    return false;
+}
+
+KirjausEhdotukset::Ehdotus KirjausEhdotukset::hae(const QString &avain, bool debet, int ohitaTili) const
+{
+    Ehdotus paras;
+    const QHash<qint64,int> valinnat = valinnat_.value( (debet ? "+" : "-") + avain );
+    for( auto iter = valinnat.constBegin(); iter != valinnat.constEnd(); ++iter)
+    {
+        int tiliId = static_cast<int>( iter.key() >> 32 );
+        if( tiliId == ohitaTili || iter.value() <= paras.kertoja )
+            continue;
+        paras.tiliId = tiliId;
+        paras.kohdennusId = static_cast<int>( iter.key() & 0xffffffff );
+        paras.kertoja = iter.value();
+    }
+    return paras;
+}
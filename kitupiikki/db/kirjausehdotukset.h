@@ -0,0 +1,86 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef KIRJAUSEHDOTUKSET_H
+#define KIRJAUSEHDOTUKSET_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Aiempiin kirjauksiin perustuvat tiliehdotukset
+ *
+ * Vientien selitteet normalisoidaan (pienet kirjaimet, ei numeroita eikä
+ * välimerkkejä) ja jokaiselle selitteelle lasketaan, millä tilillä ja
+ * kohdennuksella sillä on debet- ja kredit-puolella kirjattu. Ehdotukseksi
+ * annetaan yleisin valinta ensin koko selitteelle ja sitten selitteen
+ * kahdelle ensimmäiselle sanalle.
+ *
+ * Hakemisto luetaan kerran ja täydennetään sen jälkeen vain uusilla
+ * vienneillä, kun muutosloki kertoo kirjanpidon muuttuneen. Jos jo
+ * laskettua tositetta on muokattu tai se on poistettu, hakemisto luetaan
+ * uudelleen. Tiliotteen rahatilin rivejä (arkistotunnus) ei lasketa.
+ *
+ * @since 1.5
+ */
+class KirjausEhdotukset
+{
+public:
+    struct Ehdotus
+    {
+        int tiliId = 0;
+        int kohdennusId = 0;
+        int kertoja = 0;
+    };
+
+    /**
+     * @brief Tiliehdotus selitteelle
+     * @param selite Kirjauksen selite
+     * @param debet Ehdotetaanko debet- vai kredit-puolen tiliä
+     * @param ohitaTili Tili, jota ei ehdoteta (esim. tiliotteen rahatili)
+     * @return Ehdotus, kertoja on 0 jos ehdotusta ei löytynyt
+     */
+    static Ehdotus ehdota(const QString& selite, bool debet, int ohitaTili = 0);
+
+    /**
+     * @brief Selitteen hakuavaimet
+     * @return Koko selitteen avain ja kahden ensimmäisen sanan avain
+     */
+    static QStringList avaimet(const QString& selite);
+
+protected:
+    KirjausEhdotukset();
+    void paivita();
+    void tyhjenna();
+    /**
+     * @brief Muuttuivatko jo lasketut viennit
+     */
+    bool laskettujaMuutettu() const;
+    Ehdotus hae(const QString& avain, bool debet, int ohitaTili) const;
+    static qint64 valinta(int tiliId, int kohdennusId) { return ( static_cast<qint64>(tiliId) << 32 ) | static_cast<quint32>(kohdennusId); }
+
+    // avain (+/- ja normalisoitu selite) -> valinta -> kertoja
+    QHash<QString, QHash<qint64,int>> valinnat_;
+    QSet<int> tositteet_;     ///< Tositteet, joiden vientejä on laskettu
+    int viimeisinId_ = 0;
+    qlonglong versio_ = -1;
+    int avauskerta_ = -1;
+};
+
+#endif // KIRJAUSEHDOTUKSET_H
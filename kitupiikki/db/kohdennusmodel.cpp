@@ -266,15 +266,20 @@ void KohdennusModel::tallenna()
             if( !kohdennus.id() )
                 kohdennukset_[i].asetaId( kysely.lastInsertId().toInt());
 
+            kp()->muutokset()->kirjaa("kohdennus", kohdennukset_.at(i).id());
         }
     }
     foreach (int id, poistetutIdt_)
     {
         kysely.exec( QString("DELETE FROM kohdennus WHERE id=%1").arg(id));
+        kp()->muutokset()->kirjaa("kohdennus", id);
     }
     poistetutIdt_.clear();
 
-    tietokanta_->commit();
+    if( tietokanta_->commit() )
+        kp()->muutokset()->vahvista();
+    else
+        kp()->muutokset()->peru();
 }
 
 
@@ -346,6 +346,22 @@ void LiiteModel::tyhjaa()
 }
 
 bool LiiteModel::tallenna()
+{
+    if( tositeModel_ )
+        return tallennaLiitteet();
+
+    kp()->tietokanta()->transaction();
+    if( tallennaLiitteet() && kp()->tietokanta()->commit() )
+    {
+        kp()->muutokset()->vahvista();
+        return true;
+    }
+    kp()->tietokanta()->rollback();
+    kp()->muutokset()->peru();
+    return false;
+}
+
+bool LiiteModel::tallennaLiitteet()
 {
     QString inboxPolku = kp()->asetukset()->asetus("KirjattavienKansio");
 
@@ -378,6 +394,7 @@ bool LiiteModel::tallenna()
                 if( !kysely.exec() )
                     return false;
                 liitteet_[i].id = kysely.lastInsertId().toInt();
+                kp()->muutokset()->kirjaa("liite", liitteet_.at(i).id);
 
                 if( !inboxPolku.isEmpty() && liitteet_.at(i).lisattyPolusta.startsWith( inboxPolku ) )
                 {
@@ -400,6 +417,7 @@ bool LiiteModel::tallenna()
                 kysely.bindValue(":otsikko", liitteet_[i].otsikko);
                 if( !kysely.exec() )
                     return false;
+                kp()->muutokset()->kirjaa("liite", liitteet_.at(i).id);
             }
             liitteet_[i].muokattu = false;
         }
@@ -407,7 +425,10 @@ bool LiiteModel::tallenna()
 
     // Poistetut liitteet
     for( int poistettuId : poistetutIdt_)
+    {
         kysely.exec( QString("DELETE from liite WHERE id=%1").arg(poistettuId) );
+        kp()->muutokset()->kirjaa("liite", poistettuId);
+    }
 
     muokattu_ = false;
     return true;
@@ -108,6 +108,11 @@ public slots:
     void tyhjaa();
     /**
      * @brief Tallentaa liitteet
+     *
+     * Tositteen liitteet tallennetaan tositteen transaktiossa, ja
+     * TositeModel vahvistaa muutoslokin kirjaukset. Tositteeseen
+     * kuulumattomat liitteet tallennetaan omassa transaktiossaan.
+     *
      * @return tosi, jos onnistui
      */
     bool tallenna();
@@ -118,6 +123,7 @@ signals:
 
 protected:
     int seuraavaNumero() const;
+    bool tallennaLiitteet();
 
     TositeModel *tositeModel_;
     QList<Liite> liitteet_;
@@ -0,0 +1,115 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "muutosloki.h"
+
+#include <QSqlQuery>
+#include <QVariant>
+#include <QStringList>
+
+MuutosLoki::MuutosLoki(QSqlDatabase *tietokanta, QObject *parent)
+    : QObject(parent), tietokanta_(tietokanta)
+{
+
+}
+
+void MuutosLoki::kirjaa(const QString &taulu, int rivi, const QDate &alkaa, const QDate &paattyy, const QList<int> &tilit)
+{
+    QStringList tililista;
+    for( int tili : tilit)
+        tililista.append( QString::number(tili));
+
+    QSqlQuery kysely(*tietokanta_);
+    kysely.prepare("INSERT INTO muutos(taulu, rivi, alkaa, paattyy, tilit) "
+                   "VALUES(:taulu, :rivi, :alkaa, :paattyy, :tilit)");
+    kysely.bindValue(":taulu", taulu);
+    kysely.bindValue(":rivi", rivi);
+    kysely.bindValue(":alkaa", alkaa.isValid() ? QVariant(alkaa) : QVariant());
+    kysely.bindValue(":paattyy", paattyy.isValid() ? QVariant(paattyy) : QVariant());
+    kysely.bindValue(":tilit", tililista.isEmpty() ? QVariant() : QVariant(tililista.join(',')));
+
+    if( kysely.exec())
+        vahvistamaton_ = kysely.lastInsertId().toLongLong();
+}
+
+void MuutosLoki::vahvista()
+{
+    if( vahvistamaton_ > versio_ )
+    {
+        versio_ = vahvistamaton_;
+        emit versioMuuttui( versio_ );
+    }
+    vahvistamaton_ = versio_;
+}
+
+void MuutosLoki::peru()
+{
+    vahvistamaton_ = versio_;
+}
+
+QList<TietoMuutos> MuutosLoki::muutokset(qlonglong versiosta) const
+{
+    QList<TietoMuutos> lista;
+
+    QSqlQuery kysely(*tietokanta_);
+    kysely.exec( QString("SELECT id, taulu, rivi, alkaa, paattyy, tilit FROM muutos WHERE id > %1 ORDER BY id")
+                 .arg(versiosta));
+    while( kysely.next())
+    {
+        TietoMuutos muutos;
+        muutos.versio = kysely.value(0).toLongLong();
+        muutos.taulu = kysely.value(1).toString();
+        muutos.rivi = kysely.value(2).toInt();
+        muutos.alkaa = kysely.value(3).toDate();
+        muutos.paattyy = kysely.value(4).toDate();
+        for( const QString& tili : kysely.value(5).toString().split(',', QString::SkipEmptyParts))
+            muutos.tilit.append( tili.toInt() );
+        lista.append(muutos);
+    }
+    return lista;
+}
+
+bool MuutosLoki::onkoMuuttunut(qlonglong versiosta, const QDate &alkaa, const QDate &paattyy) const
+{
+    if( versiosta >= versio_ )
+        return false;
+
+    QString ehto;
+    if( alkaa.isValid() )
+        ehto.append( QString(" AND (paattyy IS NULL OR paattyy >= '%1')").arg( alkaa.toString(Qt::ISODate) ));
+    if( paattyy.isValid() )
+        ehto.append( QString(" AND (alkaa IS NULL OR alkaa <= '%1')").arg( paattyy.toString(Qt::ISODate) ));
+
+    QSqlQuery kysely(*tietokanta_);
+    kysely.exec( QString("SELECT id FROM muutos WHERE id > %1 %2 LIMIT 1").arg(versiosta).arg(ehto) );
+    return kysely.next();
+}
+
+void MuutosLoki::lataa()
+{
+    versio_ = 0;
+    QSqlQuery kysely(*tietokanta_);
+    kysely.exec("SELECT MAX(id) FROM muutos");
+    if( kysely.next())
+        versio_ = kysely.value(0).toLongLong();
+    vahvistamaton_ = versio_;
+
+    // AUTOINCREMENT takaa, ettei poistettujen rivien numeroita käytetä uudelleen
+    kysely.exec( QString("DELETE FROM muutos WHERE id < %1").arg(versio_));
+
+    emit versioMuuttui( versio_ );
+}
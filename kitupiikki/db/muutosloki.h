@@ -0,0 +1,138 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MUUTOSLOKI_H
+#define MUUTOSLOKI_H
+
+#include <QObject>
+#include <QDate>
+#include <QList>
+#include <QSqlDatabase>
+
+/**
+ * @brief Yksi muutoslokin rivi
+ */
+struct TietoMuutos
+{
+    qlonglong versio = 0;
+    QString taulu;
+    int rivi = 0;
+    QDate alkaa;
+    QDate paattyy;
+    QList<int> tilit;
+};
+
+/**
+ * @brief Kirjanpidon muutosloki
+ *
+ * Jokainen tallennus kirjataan muutos-tauluun samassa transaktiossa
+ * itse muutoksen kanssa. Lokin juokseva numero toimii kirjanpidon
+ * tietoversiona: välimuistit voivat tallettaa version, jolla ne on
+ * laskettu, ja selvittää myöhemmin, onko niihin vaikuttavia muutoksia
+ * tehty.
+ *
+ * Kirjattu muutos tulee voimaan vasta, kun tallentaja on vahvistanut
+ * sen onnistuneen commitin jälkeen. Näin välimuistiin ei talleteta
+ * versiota, jonka tiedot peruttiin.
+ *
+ * Jokainen suoraan tietokantaan kirjoittava tallennus kutsuu kirjaa()
+ * transaktionsa sisällä ja vahvista() tai peru() sen päätyttyä.
+ * Tositteen LiiteModel vain kirjaa muutoksensa, ja ne vahvistaa
+ * transaktion omistava TositeModel.
+ *
+ * @since 1.5
+ */
+class MuutosLoki : public QObject
+{
+    Q_OBJECT
+public:
+    MuutosLoki(QSqlDatabase *tietokanta, QObject *parent = nullptr);
+
+    /**
+     * @brief Kirjanpidon nykyinen tietoversio
+     * @return Viimeisimmän muutoksen numero
+     */
+    qlonglong versio() const { return versio_; }
+
+    /**
+     * @brief Kirjaa muutoksen lokiin
+     *
+     * Kutsutaan tallennuksen transaktion sisällä juuri ennen committia.
+     * Versio päivittyy vasta vahvista()-kutsulla.
+     *
+     * @param taulu Muutettu taulu
+     * @param rivi Muutetun rivin id
+     * @param alkaa Muutoksen vaikutusalueen alkupäivä (tyhjä, jos ei rajattu)
+     * @param paattyy Muutoksen vaikutusalueen loppupäivä (tyhjä, jos ei rajattu)
+     * @param tilit Muutoksen koskemien tilien id:t
+     */
+    void kirjaa(const QString& taulu, int rivi, const QDate& alkaa = QDate(),
+                const QDate& paattyy = QDate(), const QList<int>& tilit = QList<int>());
+
+    /**
+     * @brief Ottaa kirjatut muutokset käyttöön
+     *
+     * Kutsutaan, kun muutokset sisältänyt transaktio on tallennettu
+     */
+    void vahvista();
+
+    /**
+     * @brief Hylkää vahvistamattomat muutokset
+     *
+     * Kutsutaan, kun muutokset sisältänyt transaktio on peruttu
+     */
+    void peru();
+
+    /**
+     * @brief Annetun version jälkeen tehdyt muutokset
+     * @param versiosta Versio, jonka jälkeiset muutokset haetaan
+     * @return
+     */
+    QList<TietoMuutos> muutokset(qlonglong versiosta) const;
+
+    /**
+     * @brief Onko versiosta lähtien tehty päivämäärävälille osuvia muutoksia
+     *
+     * Muutos, jolla ei ole päivämäärärajausta (esim. tilikartan muokkaus),
+     * osuu kaikille väleille
+     *
+     * @param versiosta Versio, jonka jälkeiset muutokset tutkitaan
+     * @param alkaa Tarkasteltavan välin alku
+     * @param paattyy Tarkasteltavan välin loppu
+     * @return
+     */
+    bool onkoMuuttunut(qlonglong versiosta, const QDate& alkaa = QDate(), const QDate& paattyy = QDate()) const;
+
+    /**
+     * @brief Lukee nykyisen version tietokannasta
+     *
+     * Kutsutaan kirjanpitoa avattaessa. Aiempien avauskertojen muutoksia
+     * ei enää tarvita, koska välimuistit tyhjennetään avattaessa, joten
+     * ne poistetaan viimeisintä lukuun ottamatta.
+     */
+    void lataa();
+
+signals:
+    void versioMuuttui(qlonglong versio);
+
+protected:
+    QSqlDatabase *tietokanta_;
+    qlonglong versio_ = 0;
+    qlonglong vahvistamaton_ = 0;
+};
+
+#endif // MUUTOSLOKI_H
@@ -0,0 +1,172 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "taydennyshakemisto.h"
+#include "kirjanpito.h"
+
+#include <QSqlQuery>
+#include <QSet>
+#include <algorithm>
+
+TaydennysHakemisto::TaydennysHakemisto()
+{
+
+}
+
+const TaydennysHakemisto &TaydennysHakemisto::otsikot()
+{
+    static TaydennysHakemisto hakemisto__;
+
+    if( hakemisto__.avauskerta_ != kp()->avauskerta() )
+        hakemisto__.lataa();
+    else if( kp()->muutokset()->onkoMuuttunut( hakemisto__.versio_ ))
+        hakemisto__.paivita( kp()->muutokset()->muutokset( hakemisto__.versio_ ));
+
+    return hakemisto__;
+}
+
+QStringList TaydennysHakemisto::hae(const QString &alku, int enintaan) const
+{
+    QString avain = alku.toLower();
+
+    auto ensimmainen = std::lower_bound( otsikot_.constBegin(), otsikot_.constEnd(), avain,
+                                         [] (const Otsikko& otsikko, const QString& haettu) { return otsikko.avain < haettu; });
+    QVector<const Otsikko*> osumat;
+    for( auto iter = ensimmainen; iter != otsikot_.constEnd() && iter->avain.startsWith(avain); ++iter)
+        osumat.append( iter );
+
+    std::sort( osumat.begin(), osumat.end(), [] (const Otsikko* a, const Otsikko* b) {
+        if( a->maara != b->maara )
+            return a->maara > b->maara;
+        return a->viimeksi > b->viimeksi;
+    });
+
+    QStringList tulos;
+    for( int i=0; i < osumat.count() && i < enintaan; i++)
+        tulos.append( osumat.at(i)->teksti );
+    return tulos;
+}
+
+void TaydennysHakemisto::lataa()
+{
+    otsikot_.clear();
+    tositteet_.clear();
+    avauskerta_ = kp()->avauskerta();
+    versio_ = kp()->muutokset()->versio();
+
+    QSqlQuery kysely("SELECT id, otsikko, pvm FROM tosite "
+                     "WHERE otsikko IS NOT NULL AND otsikko <> '' ORDER BY otsikko");
+    while( kysely.next())
+    {
+        QString teksti = kysely.value(1).toString();
+        qint64 pvm = kysely.value(2).toDate().toJulianDay();
+        tositteet_.insert( kysely.value(0).toInt(), teksti );
+
+        if( !otsikot_.isEmpty() && otsikot_.last().teksti == teksti )
+        {
+            otsikot_.last().maara++;
+            otsikot_.last().viimeksi = qMax( otsikot_.last().viimeksi, pvm );
+        }
+        else
+        {
+            Otsikko otsikko;
+            otsikko.teksti = teksti;
+            otsikko.avain = teksti.toLower();
+            otsikko.maara = 1;
+            otsikko.viimeksi = pvm;
+            otsikot_.append(otsikko);
+        }
+    }
+
+    std::sort( otsikot_.begin(), otsikot_.end(), [] (const Otsikko& a, const Otsikko& b) { return a.avain < b.avain; });
+}
+
+void TaydennysHakemisto::paivita(const QList<TietoMuutos> &muutokset)
+{
+    QSet<int> muuttuneet;
+    for( const TietoMuutos& muutos : muutokset)
+    {
+        if( muutos.taulu != "tosite")
+            continue;
+        if( !muutos.rivi )
+        {
+            // Useita tositteita koskeva muutos
+            lataa();
+            return;
+        }
+        muuttuneet.insert( muutos.rivi );
+    }
+    versio_ = kp()->muutokset()->versio();
+
+    QSqlQuery kysely;
+    kysely.prepare("SELECT otsikko, pvm FROM tosite WHERE id=?");
+    for( int id : muuttuneet)
+    {
+        if( tositteet_.contains(id))
+            vahenna( tositteet_.take(id) );
+
+        kysely.addBindValue(id);
+        if( kysely.exec() && kysely.next() )
+        {
+            QString teksti = kysely.value(0).toString();
+            if( !teksti.isEmpty())
+            {
+                lisaa( teksti, kysely.value(1).toDate().toJulianDay() );
+                tositteet_.insert(id, teksti);
+            }
+        }
+    }
+}
+
+void TaydennysHakemisto::lisaa(const QString &teksti, qint64 viimeksi)
+{
+    QString avain = teksti.toLower();
+    auto iter = std::lower_bound( otsikot_.begin(), otsikot_.end(), avain,
+                                  [] (const Otsikko& otsikko, const QString& haettu) { return otsikko.avain < haettu; });
+    while( iter != otsikot_.end() && iter->avain == avain && iter->teksti != teksti)
+        ++iter;
+
+    if( iter != otsikot_.end() && iter->teksti == teksti)
+    {
+        iter->maara++;
+        iter->viimeksi = qMax( iter->viimeksi, viimeksi);
+    }
+    else
+    {
+        Otsikko otsikko;
+        otsikko.teksti = teksti;
+        otsikko.avain = avain;
+        otsikko.maara = 1;
+        otsikko.viimeksi = viimeksi;
+        otsikot_.insert( iter, otsikko);
+    }
+}
+
+void TaydennysHakemisto::vahenna(const QString &teksti)
+{
+    QString avain = teksti.toLower();
+    auto iter = std::lower_bound( otsikot_.begin(), otsikot_.end(), avain,
+                                  [] (const Otsikko& otsikko, const QString& haettu) { return otsikko.avain < haettu; });
+    while( iter != otsikot_.end() && iter->avain == avain && iter->teksti != teksti)
+        ++iter;
+
+    if( iter != otsikot_.end() && iter->teksti == teksti)
+    {
+        if( --iter->maara < 1)
+            otsikot_.erase(iter);
+    }
+}
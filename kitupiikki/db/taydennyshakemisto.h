@@ -0,0 +1,90 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TAYDENNYSHAKEMISTO_H
+#define TAYDENNYSHAKEMISTO_H
+
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+#include "muutosloki.h"
+
+/**
+ * @brief Tositteiden otsikoiden hakemisto täydennystä varten
+ *
+ * Kirjanpidon erilaiset otsikot ovat muistissa aakkosjärjestyksessä
+ * (kirjainkoosta riippumatta), joten alkuosaa vastaavat otsikot löytyvät
+ * binäärihaulla. Löydetyt otsikot järjestetään käyttökertojen ja
+ * viimeisimmän käytön mukaan.
+ *
+ * Hakemisto muodostetaan kokonaan, kun kirjanpito avataan. Sen jälkeen
+ * muutoslokin kertomat muuttuneet tositteet luetaan ja päivitetään
+ * hakemistoon yksitellen.
+ *
+ * @since 1.5
+ */
+class TaydennysHakemisto
+{
+public:
+    TaydennysHakemisto();
+
+    /**
+     * @brief Ajantasainen hakemisto tositteiden otsikoista
+     */
+    static const TaydennysHakemisto& otsikot();
+
+    /**
+     * @brief Alkuosaa vastaavat otsikot
+     * @param alku Haettava alkuosa
+     * @param enintaan Palautettavien otsikoiden enimmäismäärä
+     * @return Otsikot yleisimmästä alkaen
+     */
+    QStringList hae(const QString& alku, int enintaan = 20) const;
+
+protected:
+    struct Otsikko
+    {
+        QString avain;          ///< Otsikko pienillä kirjaimilla
+        QString teksti;
+        int maara = 0;
+        qint64 viimeksi = 0;    ///< Viimeisimmän käytön päivänumero
+    };
+
+    void lataa();
+
+    /**
+     * @brief Päivittää muuttuneiden tositteiden otsikot hakemistoon
+     */
+    void paivita(const QList<TietoMuutos>& muutokset);
+
+    void lisaa(const QString& teksti, qint64 viimeksi);
+    /**
+     * @brief Vähentää otsikon käyttökertoja
+     *
+     * Viimeisimmän käytön päivä jää ennalleen seuraavaan kokonaiseen lataukseen asti
+     */
+    void vahenna(const QString& teksti);
+
+    QVector<Otsikko> otsikot_;
+    QHash<int,QString> tositteet_;  ///< Tositteiden otsikot id:n mukaan
+    qlonglong versio_ = -1;
+    int avauskerta_ = -1;
+};
+
+#endif // TAYDENNYSHAKEMISTO_H
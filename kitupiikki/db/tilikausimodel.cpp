@@ -285,10 +285,15 @@ void TilikausiModel::tallennaJSON()
             kysely.bindValue(":json", kaudet_[i].json()->toSqlJson());
             kysely.bindValue(":alku", kaudet_[i].alkaa());
             kysely.exec();
+            // Budjetti on tilikauden json:issa
+            kp()->muutokset()->kirjaa("tilikausi", 0, kaudet_[i].alkaa(), kaudet_[i].paattyy());
         }
     }
 
-    tietokanta_->commit();
+    if( tietokanta_->commit() )
+        kp()->muutokset()->vahvista();
+    else
+        kp()->muutokset()->peru();
 }
 
 void TilikausiModel::paivitaKausitunnukset()
@@ -389,6 +389,8 @@ bool TiliModel::tallenna(bool tietokantaaLuodaan)
             if( !tili.id())
                 tilit_[i].asetaId( kysely.lastInsertId().toInt() );
 
+            if( !tietokantaaLuodaan )
+                kp()->muutokset()->kirjaa("tili", tilit_.at(i).id(), QDate(), QDate(), QList<int>() << tilit_.at(i).id());
         }
     }
 
@@ -396,9 +398,13 @@ bool TiliModel::tallenna(bool tietokantaaLuodaan)
     {
         QSqlQuery kysely(*tietokanta_);
         kysely.exec( QString("DELETE FROM tili WHERE id=%1").arg(id) );
+        kp()->muutokset()->kirjaa("tili", id, QDate(), QDate(), QList<int>() << id);
     }
 
-    tietokanta_->commit();
+    if( tietokanta_->commit() )
+        kp()->muutokset()->vahvista();
+    else
+        kp()->muutokset()->peru();
 
     if( tietokanta_->lastError().isValid() )
     {
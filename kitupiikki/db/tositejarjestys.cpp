@@ -0,0 +1,208 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tositejarjestys.h"
+#include "kirjanpito.h"
+
+#include <QSqlQuery>
+#include <algorithm>
+
+TositeJarjestys::TositeJarjestys()
+{
+
+}
+
+TositeJarjestys TositeJarjestys::kaudelle(const Tilikausi &kausi)
+{
+    static QHash<QDate, TositeJarjestys> jarjestykset__;
+    static int avauskerta__ = -1;
+
+    bool samaanSarjaan = kp()->asetukset()->onko("Samaansarjaan");
+    if( avauskerta__ != kp()->avauskerta())
+    {
+        jarjestykset__.clear();
+        avauskerta__ = kp()->avauskerta();
+    }
+
+    QHash<QDate,TositeJarjestys>::iterator iter = jarjestykset__.find( kausi.alkaa() );
+    if( iter == jarjestykset__.end() || iter.value().samaanSarjaan_ != samaanSarjaan ||
+        iter.value().paattyy_ != kausi.paattyy() )
+    {
+        TositeJarjestys jarjestys;
+        jarjestys.lataa( kausi );
+        iter = jarjestykset__.insert( kausi.alkaa(), jarjestys);
+    }
+    else if( kp()->muutokset()->onkoMuuttunut( iter.value().versio_, kausi.alkaa(), kausi.paattyy() ) &&
+             !iter.value().paivita( kp()->muutokset()->muutokset( iter.value().versio_ ) ))
+    {
+        iter.value() = TositeJarjestys();
+        iter.value().lataa( kausi );
+    }
+    return iter.value();
+}
+
+int TositeJarjestys::edellinen(int tositeId) const
+{
+    int sijainti = sijainnit_.value(tositeId, -1);
+    if( sijainti > 0)
+        return idt_.at(sijainti - 1);
+    return -1;
+}
+
+int TositeJarjestys::seuraava(int tositeId) const
+{
+    int sijainti = sijainnit_.value(tositeId, -1);
+    if( sijainti > -1 && sijainti < idt_.count() - 1)
+        return idt_.at(sijainti + 1);
+    return -1;
+}
+
+int TositeJarjestys::tosite(int laji, int tunniste) const
+{
+    return tunnisteet_.value( avain( samaanSarjaan_ ? 0 : laji, tunniste ) );
+}
+
+void TositeJarjestys::lataa(const Tilikausi &kausi)
+{
+    samaanSarjaan_ = kp()->asetukset()->onko("Samaansarjaan");
+    versio_ = kp()->muutokset()->versio();
+    alkaa_ = kausi.alkaa();
+    paattyy_ = kausi.paattyy();
+
+    QSqlQuery kysely;
+    if( samaanSarjaan_ )
+        kysely.exec( QString("SELECT id, laji, tunniste, NULL FROM tosite WHERE pvm BETWEEN '%1' and '%2' ORDER BY tunniste")
+                     .arg( kausi.alkaa().toString(Qt::ISODate) ).arg( kausi.paattyy().toString(Qt::ISODate)) );
+    else
+        kysely.exec( QString("SELECT tosite.id, tosite.laji, tosite.tunniste, tositelaji.tunnus FROM tosite JOIN tositelaji ON tosite.laji=tositelaji.id "
+                             "WHERE pvm BETWEEN '%1' AND '%2' "
+                             "ORDER BY tositelaji.tunnus,tosite.tunniste")
+                     .arg( kausi.alkaa().toString(Qt::ISODate) ).arg( kausi.paattyy().toString(Qt::ISODate)) );
+
+    while( kysely.next())
+    {
+        int id = kysely.value(0).toInt();
+        Tunniste tunniste;
+        tunniste.laji = kysely.value(1).toInt();
+        tunniste.tunniste = kysely.value(2).toInt();
+        tunniste.lajitunnus = kysely.value(3).toString();
+
+        sijainnit_.insert( id, idt_.count());
+        idt_.append( id );
+        tiedot_.insert( id, tunniste);
+        // Numerointi voi olla päällekkäinen, jolloin haku löytää ensimmäisen
+        qint64 tunnisteAvain = avain( tunniste );
+        if( !tunnisteet_.contains(tunnisteAvain))
+            tunnisteet_.insert( tunnisteAvain, id );
+    }
+}
+
+bool TositeJarjestys::paivita(const QList<TietoMuutos> &muutokset)
+{
+    QList<int> muuttuneet;
+    for( const TietoMuutos& muutos : muutokset)
+    {
+        if( muutos.taulu == "tositelaji" || muutos.taulu == "tilikausi" ||
+            ( muutos.taulu == "tosite" && !muutos.rivi ))
+            return false;
+        if( muutos.taulu != "tosite")
+            continue;
+        // Tositteen vanha ja uusi päivämäärä ovat muutoksen välillä
+        if( ( muutos.alkaa.isValid() && muutos.alkaa > paattyy_ ) ||
+            ( muutos.paattyy.isValid() && muutos.paattyy < alkaa_ ))
+            continue;
+        if( !muuttuneet.contains( muutos.rivi ))
+            muuttuneet.append( muutos.rivi );
+    }
+    versio_ = kp()->muutokset()->versio();
+
+    QSqlQuery kysely;
+    kysely.prepare("SELECT tosite.laji, tosite.tunniste, tosite.pvm, tositelaji.tunnus FROM tosite "
+                   "LEFT OUTER JOIN tositelaji ON tosite.laji=tositelaji.id WHERE tosite.id=?");
+    for( int id : muuttuneet)
+    {
+        poista( id );
+
+        kysely.addBindValue( id );
+        if( !kysely.exec() || !kysely.next())
+            continue;   // Tosite on poistettu
+
+        QDate pvm = kysely.value(2).toDate();
+        if( pvm < alkaa_ || pvm > paattyy_ || ( !samaanSarjaan_ && kysely.value(3).isNull() ))
+            continue;
+
+        Tunniste tunniste;
+        tunniste.laji = kysely.value(0).toInt();
+        tunniste.tunniste = kysely.value(1).toInt();
+        if( !samaanSarjaan_ )
+            tunniste.lajitunnus = kysely.value(3).toString();
+        lisaa( id, tunniste );
+    }
+    return true;
+}
+
+void TositeJarjestys::poista(int id)
+{
+    int sijainti = sijainnit_.value(id, -1);
+    if( sijainti < 0)
+        return;
+
+    Tunniste tunniste = tiedot_.take(id);
+    sijainnit_.remove(id);
+    idt_.remove(sijainti);
+    for( int i = sijainti; i < idt_.count(); i++)
+        sijainnit_[ idt_.at(i) ] = i;
+
+    qint64 tunnisteAvain = avain( tunniste );
+    if( tunnisteet_.value( tunnisteAvain ) == id )
+    {
+        // Päällekkäisestä numeroinnista haetaan seuraava samalla tunnisteella
+        tunnisteet_.remove( tunnisteAvain );
+        for( int muuId : idt_)
+        {
+            if( avain( tiedot_.value(muuId)) == tunnisteAvain )
+            {
+                tunnisteet_.insert( tunnisteAvain, muuId);
+                break;
+            }
+        }
+    }
+}
+
+void TositeJarjestys::lisaa(int id, const Tunniste &tunniste)
+{
+    auto paikka = std::upper_bound( idt_.begin(), idt_.end(), tunniste,
+                                    [this] (const Tunniste& lisattava, int muuId) { return ennen( lisattava, tiedot_.value(muuId)); });
+    int sijainti = static_cast<int>( paikka - idt_.begin() );
+
+    idt_.insert( sijainti, id );
+    tiedot_.insert( id, tunniste );
+    for( int i = sijainti; i < idt_.count(); i++)
+        sijainnit_[ idt_.at(i) ] = i;
+
+    qint64 tunnisteAvain = avain( tunniste );
+    int edellinen = tunnisteet_.value( tunnisteAvain );
+    if( !edellinen || sijainnit_.value(edellinen) > sijainti )
+        tunnisteet_.insert( tunnisteAvain, id );
+}
+
+bool TositeJarjestys::ennen(const TositeJarjestys::Tunniste &a, const TositeJarjestys::Tunniste &b) const
+{
+    if( !samaanSarjaan_ && a.lajitunnus != b.lajitunnus)
+        return a.lajitunnus < b.lajitunnus;
+    return a.tunniste < b.tunniste;
+}
@@ -0,0 +1,107 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOSITEJARJESTYS_H
+#define TOSITEJARJESTYS_H
+
+#include <QVector>
+#include <QHash>
+#include <QDate>
+
+#include "muutosloki.h"
+
+class Tilikausi;
+
+/**
+ * @brief Tilikauden tositteet selausjärjestyksessä
+ *
+ * Tositteiden id:t tunnisteen (tai tositelajin ja tunnisteen) mukaisessa
+ * järjestyksessä sekä hakutaulut id:n sijaintiin ja tunnisteesta id:hen.
+ * Järjestys muodostetaan kerran tilikautta kohden. Muutoslokin kertomat
+ * yksittäiset tositteet siirretään paikoilleen järjestyksessä, ja koko
+ * järjestys muodostetaan uudelleen vain, kun tositelajeja tai tilikausia
+ * on muokattu tai kirjanpito avataan uudelleen.
+ *
+ * @since 1.5
+ */
+class TositeJarjestys
+{
+public:
+    TositeJarjestys();
+
+    /**
+     * @brief Ajantasainen järjestys tilikaudelle
+     */
+    static TositeJarjestys kaudelle(const Tilikausi& kausi);
+
+    /**
+     * @brief Edellisen tositteen id
+     * @return id tai -1, jos ei edellistä
+     */
+    int edellinen(int tositeId) const;
+
+    /**
+     * @brief Seuraavan tositteen id
+     * @return id tai -1, jos ei seuraavaa
+     */
+    int seuraava(int tositeId) const;
+
+    /**
+     * @brief Tositteen id tunnisteella
+     * @param laji Tositelaji (ohitetaan, jos kaikki tositteet samassa sarjassa)
+     * @param tunniste Tositteen numero
+     * @return id tai 0, jos tositetta ei ole
+     */
+    int tosite(int laji, int tunniste) const;
+
+    QVector<int> idt() const { return idt_; }
+
+protected:
+    /**
+     * @brief Tositteen järjestysavain
+     */
+    struct Tunniste
+    {
+        QString lajitunnus;
+        int laji = 0;
+        int tunniste = 0;
+    };
+
+    void lataa(const Tilikausi& kausi);
+    /**
+     * @brief Päivittää muuttuneet tositteet järjestykseen
+     * @return epätosi, jos järjestys on muodostettava uudelleen
+     */
+    bool paivita(const QList<TietoMuutos>& muutokset);
+    void poista(int id);
+    void lisaa(int id, const Tunniste& tunniste);
+    bool ennen(const Tunniste& a, const Tunniste& b) const;
+
+    static qint64 avain(int laji, int tunniste) { return ( static_cast<qint64>(laji) << 32 ) | static_cast<quint32>(tunniste); }
+    qint64 avain(const Tunniste& tunniste) const { return avain( samaanSarjaan_ ? 0 : tunniste.laji, tunniste.tunniste); }
+
+    QVector<int> idt_;
+    QHash<int,int> sijainnit_;
+    QHash<qint64,int> tunnisteet_;
+    QHash<int,Tunniste> tiedot_;
+    bool samaanSarjaan_ = false;
+    qlonglong versio_ = 0;
+    QDate alkaa_;
+    QDate paattyy_;
+};
+
+#endif // TOSITEJARJESTYS_H
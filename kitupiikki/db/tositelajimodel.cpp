@@ -244,6 +244,10 @@ void TositelajiModel::lataa()
 
 bool TositelajiModel::tallenna()
 {
+    // Uutta kirjanpitoa luotaessa tallennetaan toiseen tietokantaan
+    bool kirjataan = tietokanta_ == kp()->tietokanta();
+    tietokanta_->transaction();
+
     QSqlQuery tallennus( *tietokanta_);
     for(int i=0; i < lajit_.count(); i++)
     {
@@ -269,16 +273,29 @@ bool TositelajiModel::tallenna()
             if( !lajit_[i].id())
                 lajit_[i].asetaId( tallennus.lastInsertId().toInt());
 
+            // Tositelajin tunnus vaikuttaa tositteiden järjestykseen
+            if( kirjataan )
+                kp()->muutokset()->kirjaa("tositelaji", lajit_.at(i).id());
         }
 
     }
     foreach (int id, poistetutIdt_)
     {
         tallennus.exec( QString("DELETE FROM tositelaji WHERE id=%1").arg(id));
+        if( kirjataan )
+            kp()->muutokset()->kirjaa("tositelaji", id);
     }
     poistetutIdt_.clear();
 
-    return true;
+    if( tietokanta_->commit() )
+    {
+        if( kirjataan )
+            kp()->muutokset()->vahvista();
+        return true;
+    }
+    if( kirjataan )
+        kp()->muutokset()->peru();
+    return false;
 }
 
 
@@ -26,6 +26,7 @@
 #include <QSqlError>
 #include <QMessageBox>
 #include <QSqlRecord>
+#include <QSet>
 
 #include "aloitussivu/aloitussivu.h"
 #include "versio.h"
@@ -225,6 +226,25 @@ bool TositeModel::tallenna()
     // Tallentaa tositteen
     tietokanta()->transaction();
 
+    // Muutoslokiin kirjataan sekä aiempien että tallennettavien vientien tilit ja päivämäärät
+    QDate muutosAlkaa = pvm();
+    QDate muutosPaattyy = pvm();
+    QList<int> muutosTilit = vanhatTilit(muutosAlkaa, muutosPaattyy);
+
+    for(int i=0; i < vientiModel_->rowCount(QModelIndex()); i++)
+    {
+        QModelIndex indeksi = vientiModel_->index(i, 0);
+        QDate vientiPvm = indeksi.data(VientiModel::PvmRooli).toDate();
+        int tiliId = indeksi.data(VientiModel::TiliIdRooli).toInt();
+
+        if( vientiPvm.isValid() && vientiPvm < muutosAlkaa)
+            muutosAlkaa = vientiPvm;
+        if( vientiPvm > muutosPaattyy )
+            muutosPaattyy = vientiPvm;
+        if( tiliId && !muutosTilit.contains(tiliId))
+            muutosTilit.append(tiliId);
+    }
+
     QSqlQuery kysely(*tietokanta_);
     if( id() > -1)
     {
@@ -280,10 +300,19 @@ bool TositeModel::tallenna()
     {
         // Tallennuksessa virheitä, perutaan ja palautetaan virhe
         tietokanta()->rollback();
+        kp()->muutokset()->peru();
         return false;
     }
 
-    tietokanta()->commit();
+    kp()->muutokset()->kirjaa("tosite", id(), muutosAlkaa, muutosPaattyy, muutosTilit);
+
+    if( !tietokanta()->commit())
+    {
+        tietokanta()->rollback();
+        kp()->muutokset()->peru();
+        return false;
+    }
+    kp()->muutokset()->vahvista();
 
     emit kp()->kirjanpitoaMuokattu();
     muokattu_ = false;
@@ -309,19 +338,54 @@ bool TositeModel::poista()
     tietokanta()->transaction();
     QSqlQuery kysely(*tietokanta());
 
+    QDate muutosAlkaa = pvm();
+    QDate muutosPaattyy = pvm();
+    QList<int> muutosTilit = vanhatTilit(muutosAlkaa, muutosPaattyy);
+
+    QSet<int> erat;
+    kysely.exec(QString("SELECT DISTINCT eraid FROM vienti WHERE tosite=%1 AND eraid IS NOT NULL").arg( id() ));
+    while( kysely.next())
+        erat.insert( kysely.value(0).toInt());
+
+    kysely.exec(QString("DELETE FROM laskurivi WHERE vienti IN (SELECT id FROM vienti WHERE tosite=%1)").arg( id() ));
     kysely.exec(QString("DELETE FROM vienti WHERE tosite=%1").arg( id() ));
+    if( !erat.isEmpty())
+        TaseEra::paivitaSaldot(erat);
     kysely.exec(QString("DELETE FROM liite WHERE tosite=%1").arg( id() ));
     kysely.exec(QString("DELETE FROM tosite WHERE id=%1").arg( id()) );
 
-    if( tietokanta()->commit())
+    kp()->muutokset()->kirjaa("tosite", id(), muutosAlkaa, muutosPaattyy, muutosTilit);
+
+    if( !tietokanta()->commit())
     {
-        emit kp()->kirjanpitoaMuokattu();
-        return true;
-    }
-    else
+        tietokanta()->rollback();
+        kp()->muutokset()->peru();
         return false;
+    }
 
+    kp()->muutokset()->vahvista();
+    emit kp()->kirjanpitoaMuokattu();
+    return true;
+}
 
+QList<int> TositeModel::vanhatTilit(QDate &alkaa, QDate &paattyy)
+{
+    QList<int> tilit;
+    if( id() < 0)
+        return tilit;
+
+    QSqlQuery kysely(*tietokanta_);
+    kysely.exec( QString("SELECT tili, MIN(pvm), MAX(pvm) FROM vienti WHERE tosite=%1 GROUP BY tili").arg( id() ));
+    while( kysely.next())
+    {
+        if( kysely.value(0).toInt())
+            tilit.append( kysely.value(0).toInt() );
+        if( kysely.value(1).toDate() < alkaa )
+            alkaa = kysely.value(1).toDate();
+        if( kysely.value(2).toDate() > paattyy )
+            paattyy = kysely.value(2).toDate();
+    }
+    return tilit;
 }
 
 void TositeModel::uusiPohjalta(const QDate &pvm, const QString &otsikko)
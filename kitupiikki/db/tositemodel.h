@@ -141,6 +141,17 @@ public:
 
 
 protected:
+    /**
+     * @brief Tietokantaan tallennettujen vientien tilit muutoslokia varten
+     *
+     * Laajentaa annettua päivämääräväliä kattamaan tallennetut viennit
+     *
+     * @param alkaa Välin alku
+     * @param paattyy Välin loppu
+     * @return Tilien id:t
+     */
+    QList<int> vanhatTilit(QDate& alkaa, QDate& paattyy);
+
     int id_;
     QDate pvm_;
     QString otsikko_;
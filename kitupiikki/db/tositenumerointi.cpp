@@ -0,0 +1,81 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tositenumerointi.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+bool TositeNumerointi::numeroiUudelleen(QSqlDatabase &tietokanta, const QDate &alkaa, const QDate &paattyy, bool samaanSarjaan)
+{
+    tietokanta.transaction();
+    QSqlQuery kysely(tietokanta);
+
+    // Tositteet kirjoitetaan väliaikaiseen tauluun uuteen järjestykseen, jolloin
+    // rivinumerosta saadaan sarjan sisäinen numero. Ikkunafunktioita ei käytetä,
+    // koska ne puuttuvat vanhempien Qt-versioiden SQLitestä.
+    QString sarja = samaanSarjaan ? QString("0") : QString("laji");
+    QString jarjestys = samaanSarjaan ? QString("pvm, id") : QString("laji, pvm, id");
+
+    bool onnistui =
+        kysely.exec("DROP TABLE IF EXISTS temp.numerointi") &&
+        kysely.exec("DROP TABLE IF EXISTS temp.numerointialku") &&
+        kysely.exec("CREATE TEMP TABLE numerointi (jarjestys INTEGER PRIMARY KEY, "
+                    "tosite INTEGER UNIQUE, sarja INTEGER)") &&
+        kysely.exec(QString("INSERT INTO numerointi(tosite, sarja) SELECT id, %1 FROM tosite "
+                            "WHERE pvm BETWEEN '%2' AND '%3' ORDER BY %4")
+                    .arg(sarja)
+                    .arg(alkaa.toString(Qt::ISODate))
+                    .arg(paattyy.toString(Qt::ISODate))
+                    .arg(jarjestys)) &&
+        kysely.exec("CREATE TABLE temp.numerointialku AS SELECT sarja, MIN(jarjestys) AS alku "
+                    "FROM numerointi GROUP BY sarja") &&
+        kysely.exec("UPDATE tosite SET tunniste = "
+                    "(SELECT numerointi.jarjestys - numerointialku.alku + 1 FROM numerointi, numerointialku "
+                    "WHERE numerointi.tosite=tosite.id AND numerointialku.sarja=numerointi.sarja) "
+                    "WHERE id IN (SELECT tosite FROM numerointi)");
+
+    if( !onnistui )
+    {
+        qWarning() << "TositeNumerointi: " << kysely.lastError().text();
+        tietokanta.rollback();
+    }
+    else
+        onnistui = tietokanta.commit();
+
+    kysely.exec("DROP TABLE IF EXISTS temp.numerointi");
+    kysely.exec("DROP TABLE IF EXISTS temp.numerointialku");
+    return onnistui;
+}
+
+bool TositeNumerointi::siirra(QSqlDatabase &tietokanta, const QDate &alkaa, const QDate &paattyy, int laji, int alkaen, int siirto)
+{
+    QSqlQuery kysely(tietokanta);
+    if( !kysely.exec( QString("UPDATE tosite SET tunniste = tunniste + %1 WHERE laji = %2 AND tunniste >= %3 AND pvm BETWEEN '%4' AND '%5'")
+                      .arg( siirto )
+                      .arg( laji )
+                      .arg( alkaen )
+                      .arg( alkaa.toString(Qt::ISODate) )
+                      .arg( paattyy.toString(Qt::ISODate))))
+    {
+        qWarning() << "TositeNumerointi: " << kysely.lastError().text();
+        return false;
+    }
+    return true;
+}
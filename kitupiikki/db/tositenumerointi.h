@@ -0,0 +1,66 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOSITENUMEROINTI_H
+#define TOSITENUMEROINTI_H
+
+#include <QDate>
+
+class QSqlDatabase;
+
+/**
+ * @brief Tositteiden tunnistenumeroiden joukkomuutokset
+ *
+ * Numeroinnit tehdään muutamalla kyselyllä riippumatta tositteiden
+ * määrästä. Funktiot eivät kirjaa muutoslokiin, vaan kutsujan on
+ * kirjattava muutos kerran onnistuneen numeroinnin jälkeen.
+ *
+ * @since 1.5
+ */
+class TositeNumerointi
+{
+public:
+    /**
+     * @brief Numeroi jakson tositteet päivämäärän mukaiseen järjestykseen
+     *
+     * Saman päivän tositteet säilyvät keskenään luontijärjestyksessä.
+     *
+     * @param tietokanta Tietokanta, jossa tosite-taulu
+     * @param alkaa Jakson alkupäivä
+     * @param paattyy Jakson päättymispäivä
+     * @param samaanSarjaan Numeroidaanko kaikki tositelajit yhteen sarjaan
+     * @return tosi, jos onnistui
+     */
+    static bool numeroiUudelleen(QSqlDatabase &tietokanta, const QDate& alkaa, const QDate& paattyy,
+                                 bool samaanSarjaan);
+
+    /**
+     * @brief Siirtää tositelajin numeroita eteenpäin
+     *
+     * @param tietokanta Tietokanta, jossa tosite-taulu
+     * @param alkaa Jakson alkupäivä
+     * @param paattyy Jakson päättymispäivä
+     * @param laji Tositelajin id
+     * @param alkaen Ensimmäinen siirrettävä numero
+     * @param siirto Paljonko numeroita kasvatetaan
+     * @return tosi, jos onnistui
+     */
+    static bool siirra(QSqlDatabase &tietokanta, const QDate& alkaa, const QDate& paattyy,
+                       int laji, int alkaen, int siirto);
+};
+
+#endif // TOSITENUMEROINTI_H
@@ -0,0 +1,216 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "varmuuskopioija.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QFile>
+#include <QProgressDialog>
+#include <QApplication>
+
+Varmuuskopioija::Varmuuskopioija(QSqlDatabase *tietokanta, QObject *parent)
+    : QObject(parent), tietokanta_(tietokanta)
+{
+
+}
+
+bool Varmuuskopioija::kopioi(const QString &tiedostoon, QProgressDialog *edistyminen)
+{
+    virhe_.clear();
+    if( QFile::exists(tiedostoon) && !QFile::remove(tiedostoon))
+    {
+        virhe_ = tr("Tiedostoa %1 ei voi korvata").arg(tiedostoon);
+        return false;
+    }
+
+    if( !luoRakenne(tiedostoon, false))
+    {
+        QFile::remove(tiedostoon);
+        return false;
+    }
+
+    QSqlQuery kysely( *tietokanta_ );
+    QStringList taulut;
+    int rivejaYhteensa = 0;
+    kysely.exec("SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' ORDER BY name");
+    while( kysely.next())
+        taulut.append( kysely.value(0).toString());
+    for( const QString& taulu : taulut)
+    {
+        kysely.exec(QString("SELECT COUNT(*) FROM \"%1\"").arg(taulu));
+        if( kysely.next())
+            rivejaYhteensa += kysely.value(0).toInt();
+    }
+    if( edistyminen )
+    {
+        edistyminen->setMaximum( rivejaYhteensa );
+        edistyminen->setValue(0);
+    }
+
+    kysely.prepare("ATTACH DATABASE ? AS varmuus");
+    kysely.addBindValue( tiedostoon );
+    if( !kysely.exec())
+    {
+        virhe_ = kysely.lastError().text();
+        QFile::remove(tiedostoon);
+        return false;
+    }
+
+    // Erät siirretään ilman yhteistä transaktiota, koska erien välissä
+    // käsitellään tapahtumat eikä kirjanpidon ainoalle yhteydelle saa jäädä
+    // avointa transaktiota muiden tallennusten ajaksi. Kopio vastaa silti
+    // yhtä kirjanpidon tilaa, koska sovellusmodaalinen edistymisdialogi
+    // estää muokkaukset kopioinnin aikana.
+    int siirretty = 0;
+    bool onnistui = true;
+    for( const QString& taulu : taulut)
+    {
+        if( !siirraTaulu(taulu, edistyminen, siirretty))
+        {
+            onnistui = false;
+            break;
+        }
+    }
+
+    // AUTOINCREMENT-laskurit, jotta palautetussa kopiossa ei käytetä
+    // uudelleen poistettujen rivien id:itä
+    if( onnistui )
+    {
+        kysely.exec("SELECT name FROM sqlite_master WHERE type='table' AND name='sqlite_sequence'");
+        // sqlite_sequence-taulussa ei ole yksilöivää avainta, joten rivit korvataan kokonaan
+        if( kysely.next() &&
+            ( !kysely.exec("DELETE FROM varmuus.sqlite_sequence") ||
+              !kysely.exec("INSERT INTO varmuus.sqlite_sequence SELECT * FROM main.sqlite_sequence")))
+        {
+            virhe_ = kysely.lastError().text();
+            onnistui = false;
+        }
+    }
+
+    kysely.exec("DETACH DATABASE varmuus");
+
+    if( onnistui )
+        onnistui = luoRakenne(tiedostoon, true) && tarkasta(tiedostoon);
+
+    if( !onnistui )
+    {
+        if( virhe_.isEmpty())
+            virhe_ = tr("Varmuuskopion eheystarkastus epäonnistui");
+        QFile::remove(tiedostoon);
+    }
+    return onnistui;
+}
+
+bool Varmuuskopioija::tarkasta(const QString &tiedosto)
+{
+    bool ok = false;
+    {
+        QSqlDatabase kopio = QSqlDatabase::addDatabase("QSQLITE", "varmuuskopiotarkastus");
+        kopio.setDatabaseName(tiedosto);
+        if( kopio.open())
+        {
+            QSqlQuery kysely( kopio );
+            kysely.exec("PRAGMA integrity_check");
+            ok = kysely.next() && kysely.value(0).toString() == "ok";
+            kopio.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("varmuuskopiotarkastus");
+    return ok;
+}
+
+bool Varmuuskopioija::luoRakenne(const QString &tiedostoon, bool indeksit)
+{
+    // Taulut luodaan ennen tietojen siirtoa, indeksit ja näkymät vasta
+    // lopuksi, jolloin siirto ei joudu päivittämään indeksejä
+    QStringList lauseet;
+    QSqlQuery kysely( *tietokanta_ );
+    if( indeksit )
+        kysely.exec("SELECT sql FROM sqlite_master WHERE type<>'table' AND sql NOT NULL "
+                    "AND name NOT LIKE 'sqlite_%' ORDER BY type, name");
+    else
+        kysely.exec("SELECT sql FROM sqlite_master WHERE type='table' AND sql NOT NULL "
+                    "AND name NOT LIKE 'sqlite_%' ORDER BY name");
+    while( kysely.next())
+        lauseet.append( kysely.value(0).toString());
+
+    bool ok = true;
+    {
+        QSqlDatabase kopio = QSqlDatabase::addDatabase("QSQLITE", "varmuuskopio");
+        kopio.setDatabaseName(tiedostoon);
+        if( !kopio.open())
+        {
+            virhe_ = kopio.lastError().text();
+            ok = false;
+        }
+        else
+        {
+            QSqlQuery luonti( kopio );
+            for( const QString& lause : lauseet)
+            {
+                if( !luonti.exec(lause))
+                {
+                    virhe_ = luonti.lastError().text();
+                    ok = false;
+                    break;
+                }
+            }
+            kopio.close();
+        }
+    }
+    QSqlDatabase::removeDatabase("varmuuskopio");
+    return ok;
+}
+
+bool Varmuuskopioija::siirraTaulu(const QString &taulu, QProgressDialog *edistyminen, int &siirretty)
+{
+    // Liitteissä on isoja tiedostoja, joten niitä siirretään pienemmissä erissä
+    const int erakoko = taulu == "liite" ? 16 : 2000;
+
+    QSqlQuery kysely( *tietokanta_ );
+    qlonglong edellinen = -1;
+    forever
+    {
+        kysely.exec( QString("SELECT MAX(rowid) FROM (SELECT rowid FROM main.\"%1\" WHERE rowid > %2 ORDER BY rowid LIMIT %3)")
+                     .arg(taulu).arg(edellinen).arg(erakoko));
+        if( !kysely.next() || kysely.value(0).isNull())
+            return true;
+        qlonglong viimeinen = kysely.value(0).toLongLong();
+
+        if( !kysely.exec( QString("INSERT INTO varmuus.\"%1\" SELECT * FROM main.\"%1\" WHERE rowid > %2 AND rowid <= %3")
+                          .arg(taulu).arg(edellinen).arg(viimeinen)))
+        {
+            virhe_ = kysely.lastError().text();
+            return false;
+        }
+        siirretty += kysely.numRowsAffected();
+        edellinen = viimeinen;
+
+        if( edistyminen )
+        {
+            edistyminen->setValue( siirretty );
+            qApp->processEvents();
+            if( edistyminen->wasCanceled())
+            {
+                virhe_ = tr("Varmuuskopiointi keskeytettiin");
+                return false;
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VARMUUSKOPIOIJA_H
+#define VARMUUSKOPIOIJA_H
+
+#include <QObject>
+#include <QSqlDatabase>
+
+class QProgressDialog;
+
+/**
+ * @brief Kirjanpidon varmuuskopiointi avoimesta tietokannasta
+ *
+ * Kopio tehdään tietokannan kautta eikä tiedostoa kopioimalla: kohteeseen
+ * luodaan ensin sama rakenne, minkä jälkeen taulut siirretään liitetyn
+ * tietokannan kautta erissä. Näin kopio on eheä myös avoimesta
+ * kirjanpidosta, käyttöliittymä pysyy ajan tasalla edistymisestä ja
+ * kopioinnin voi keskeyttää. Lopuksi kopio avataan erikseen ja sen
+ * eheys tarkastetaan.
+ *
+ * Kopioinnin aikana käsitellään käyttöliittymän tapahtumia, joten
+ * edistymisdialogin on oltava sovellusmodaalinen (Qt::ApplicationModal),
+ * jottei kirjanpitoa muokata kesken kopioinnin.
+ *
+ * Jokainen varmuuskopio on täydellinen kopio käyttäjän valitsemaan
+ * tiedostoon. Muutosten varmuuskopiointia (inkrementaalista kopiota)
+ * tai vanhojen kopioiden kierrätystä varmuuskopiokansiossa ei ole
+ * toteutettu.
+ *
+ * @since 1.5
+ */
+class Varmuuskopioija : public QObject
+{
+    Q_OBJECT
+public:
+    Varmuuskopioija(QSqlDatabase *tietokanta, QObject *parent = nullptr);
+
+    /**
+     * @brief Kopioi kirjanpidon tiedostoon
+     * @param tiedostoon Kohdetiedosto, joka korvataan
+     * @param edistyminen Edistymisdialogi tai nullptr
+     * @return tosi, jos kopiointi ja tarkastus onnistuivat
+     */
+    bool kopioi(const QString& tiedostoon, QProgressDialog* edistyminen = nullptr);
+
+    /**
+     * @brief Tarkastaa tietokantatiedoston eheyden
+     * @param tiedosto Tarkastettava tiedosto
+     * @return tosi, jos PRAGMA integrity_check palauttaa ok
+     */
+    static bool tarkasta(const QString& tiedosto);
+
+    /**
+     * @brief Viimeisimmän virheen kuvaus
+     */
+    QString virhe() const { return virhe_; }
+
+protected:
+    bool luoRakenne(const QString& tiedostoon, bool indeksit);
+    bool siirraTaulu(const QString& taulu, QProgressDialog* edistyminen, int& siirretty);
+
+    QSqlDatabase *tietokanta_;
+    QString virhe_;
+};
+
+#endif // VARMUUSKOPIOIJA_H
@@ -25,6 +25,7 @@
 #include <QDebug>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSet>
 
 VientiModel::VientiModel(TositeModel *tositemodel) : tositeModel_(tositemodel), muokattu_(false)
 {
@@ -623,7 +624,42 @@ void VientiModel::uusiPohjalta(const QString &otsikko)
 
 bool VientiModel::tallenna()
 {
-    QSqlQuery query(*tositeModel_->tietokanta());
+    QSqlQuery paivitys(*tositeModel_->tietokanta());
+    QSqlQuery lisays(*tositeModel_->tietokanta());
+    QSqlQuery poisto(*tositeModel_->tietokanta());
+
+    paivitys.prepare("UPDATE vienti SET pvm=:pvm, tili=:tili, debetsnt=:debetsnt, "
+                     "kreditsnt=:kreditsnt, selite=:selite, alvkoodi=:alvkoodi,"
+                     "kohdennus=:kohdennus, eraid=:eraid, alvprosentti=:alvprosentti, "
+                     "viite=:viite, iban=:iban, erapvm=:erapvm, arkistotunnus=:arkistotunnus, "
+                     "muokattu=:muokattu, json=:json, asiakas=:asiakas, vientirivi=:rivinro, laskupvm=:laskupvm"
+                     " WHERE id=:id");
+    lisays.prepare("INSERT INTO vienti(tosite,pvm,tili,debetsnt,kreditsnt,selite,"
+                   "alvkoodi, alvprosentti, luotu, muokattu, json, kohdennus, eraid, vientirivi,"
+                   "viite, iban, erapvm, arkistotunnus,asiakas,laskupvm) "
+                   "VALUES(:tosite,:pvm,:tili,:debetsnt,:kreditsnt,:selite,"
+                   ":alvkoodi, :alvprosentti, :luotu, :muokattu, :json, :kohdennus, :eraid, :rivinro,"
+                   ":viite, :iban, :erapvm, :arkistotunnus, :asiakas, :laskupvm)");
+
+    QSqlQuery tagiLisays(*tositeModel_->tietokanta());
+    QSqlQuery tagiPoisto(*tositeModel_->tietokanta());
+    tagiLisays.prepare("INSERT INTO merkkaus(vienti,kohdennus) VALUES(?,?)");
+    tagiPoisto.prepare("DELETE FROM merkkaus WHERE vienti=? AND kohdennus=?");
+
+    QDateTime nyt = QDateTime::currentDateTime();
+
+    // Tase-erät, joiden saldo pitää päivittää: tositteen aiemmat erät
+    // sekä tallennettavien rivien erät
+    QSet<int> erat;
+    bool kirjoitettu = false;
+    if( tositeModel_->id())
+    {
+        QSqlQuery eraKysely(*tositeModel_->tietokanta());
+        eraKysely.exec(QString("SELECT DISTINCT eraid FROM vienti WHERE tosite=%1 AND eraid IS NOT NULL").arg(tositeModel_->id()));
+        while( eraKysely.next())
+            erat.insert( eraKysely.value(0).toInt());
+    }
+
     for(int i=0; i < viennit_.count() ; i++)
     {
         VientiRivi rivi = viennit_[i];
@@ -631,33 +667,27 @@ bool VientiModel::tallenna()
         if((( rivi.kreditSnt == 0 && rivi.debetSnt == 0) || rivi.tili.id() == 0) && rivi.json.avaimet().isEmpty() )
             continue;       // "Tyhjä" rivi, ei tallenneta
 
+        // Muuttumattomia rivejä ei kirjoiteta uudelleen
+        if( rivi.vientiId && tallennetutIndeksit_.value(rivi.vientiId, -1) == i &&
+            samat( rivi, tallennetut_.at(i)))
+        {
+            poistetutVientiIdt_.removeAll(rivi.vientiId);
+            continue;
+        }
+
+        QSqlQuery& query = rivi.vientiId ? paivitys : lisays;
         if( rivi.vientiId )
         {
-            query.prepare("UPDATE vienti SET pvm=:pvm, tili=:tili, debetsnt=:debetsnt, "
-                          "kreditsnt=:kreditsnt, selite=:selite, alvkoodi=:alvkoodi,"
-                          "kohdennus=:kohdennus, eraid=:eraid, alvprosentti=:alvprosentti, "
-                          "viite=:viite, iban=:iban, erapvm=:erapvm, arkistotunnus=:arkistotunnus, "
-                          "muokattu=:muokattu, json=:json, asiakas=:asiakas, vientirivi=:rivinro, laskupvm=:laskupvm"
-                          " WHERE id=:id");
             query.bindValue(":id", rivi.vientiId);
-            if( poistetutVientiIdt_.contains(rivi.vientiId))
-                poistetutVientiIdt_.removeAll(rivi.vientiId);
+            poistetutVientiIdt_.removeAll(rivi.vientiId);
         }
         else
         {
-            query.prepare("INSERT INTO vienti(tosite,pvm,tili,debetsnt,kreditsnt,selite,"
-                           "alvkoodi, alvprosentti, luotu, muokattu, json, kohdennus, eraid, vientirivi,"
-                           "viite, iban, erapvm, arkistotunnus,asiakas,laskupvm) "
-                            "VALUES(:tosite,:pvm,:tili,:debetsnt,:kreditsnt,:selite,"
-                            ":alvkoodi, :alvprosentti, :luotu, :muokattu, :json, :kohdennus, :eraid, :rivinro,"
-                            ":viite, :iban, :erapvm, :arkistotunnus, :asiakas, :laskupvm)");
-            query.bindValue(":luotu",  QDateTime::currentDateTime() );            
+            query.bindValue(":luotu",  nyt );
+            query.bindValue(":tosite", tositeModel_->id() );
         }
         query.bindValue(":rivinro", i + 1);        // Pidetään viennit siististi numeroituina
 
-
-        query.bindValue(":tosite", tositeModel_->id() );
-
         if( rivi.pvm.isValid())
             query.bindValue(":pvm", rivi.pvm);
         else
@@ -689,8 +719,8 @@ bool VientiModel::tallenna()
         query.bindValue(":alvkoodi", rivi.alvkoodi);
         query.bindValue(":alvprosentti", rivi.alvprosentti);
 
-        // Muokattu-kenttä päivittyy aina, kun vienti tallennetaan (vaikka se ei olisikaan muuttunut)
-        query.bindValue(":muokattu", QDateTime::currentDateTime() );
+        // Muokattu-kenttä päivittyy vain, kun vienti on muuttunut
+        query.bindValue(":muokattu", nyt );
 
         query.bindValue(":kohdennus", rivi.kohdennus.id());
         query.bindValue(":viite", rivi.viite);
@@ -706,6 +736,13 @@ bool VientiModel::tallenna()
             kp()->lokiin(query);
             return false;
         }
+        kirjoitettu = true;
+
+        // Tagit: aiemmin tallennetuista poistetaan puuttuvat ja lisätään uudet
+        QSet<int> vanhatTagit;
+        QSet<int> uudetTagit;
+        for(const Kohdennus& tagi : rivi.tagit)
+            uudetTagit.insert( tagi.id() );
 
         if( !rivi.vientiId )
         {
@@ -713,54 +750,129 @@ bool VientiModel::tallenna()
             // Jos uusi tase-erä, niin merkitään tase-erä itseensä - helpottaa tase-erien laskentaa
             if( rivi.eraId == TaseEra::UUSIERA && !rivi.vientiId && !rivi.tili.onko(TiliLaji::TULOS))
             {
-                if(!query.exec(QString("UPDATE vienti SET eraid=%1 WHERE id=%1").arg(viennit_[i].vientiId) ))
+                QSqlQuery eraKysely(*tositeModel_->tietokanta());
+                if(!eraKysely.exec(QString("UPDATE vienti SET eraid=%1 WHERE id=%1").arg(viennit_[i].vientiId) ))
                 {
-                    kp()->lokiin(query);
+                    kp()->lokiin(eraKysely);
                     return false;
                 }
             }
         }
+        else if( tallennetutIndeksit_.contains(rivi.vientiId))
+        {
+            for(const Kohdennus& tagi : tallennetut_.at( tallennetutIndeksit_.value(rivi.vientiId) ).tagit)
+                vanhatTagit.insert( tagi.id() );
+        }
         else
-            // Poistetaan tagit, jotta ne voitaisiin kohta lisätä...
-            if(!query.exec( QString("DELETE FROM merkkaus WHERE vienti=%1").arg( rivi.vientiId)))
+        {
+            // Riviä ei ole ladattu tällä modelilla, joten tagit korvataan kokonaan
+            QSqlQuery tagiKysely(*tositeModel_->tietokanta());
+            tagiKysely.exec( QString("SELECT kohdennus FROM merkkaus WHERE vienti=%1").arg(rivi.vientiId));
+            while( tagiKysely.next())
+                vanhatTagit.insert( tagiKysely.value(0).toInt());
+        }
+
+        for(int tagi : vanhatTagit - uudetTagit)
+        {
+            tagiPoisto.addBindValue( viennit_[i].vientiId );
+            tagiPoisto.addBindValue( tagi );
+            if( !tagiPoisto.exec())
             {
-                kp()->lokiin(query);
+                kp()->lokiin(tagiPoisto);
                 return false;
             }
-
-        for(const Kohdennus& tagi : rivi.tagit)
+        }
+        for(int tagi : uudetTagit - vanhatTagit)
         {
-            if( !query.exec( QString("INSERT INTO merkkaus(vienti,kohdennus) VALUES(%1,%2)")
-                        .arg(viennit_[i].vientiId)
-                        .arg(tagi.id()) ) )
+            tagiLisays.addBindValue( viennit_[i].vientiId );
+            tagiLisays.addBindValue( tagi );
+            if( !tagiLisays.exec())
             {
-                kp()->lokiin(query);
+                kp()->lokiin(tagiLisays);
                 return false;
             }
-
         }
+
+        // Laskun rivit myyntiraporttia varten
+        QVariantList laskurivit = rivi.viite.isEmpty() ? QVariantList() : rivi.json.variant("Laskurivit").toList();
+        if( (rivi.vientiId || !laskurivit.isEmpty()) && !tallennaLaskurivit( viennit_[i].vientiId, laskurivit ))
+            return false;
+
+        if( rivi.eraId > 0)
+            erat.insert( rivi.eraId );
+        else if( rivi.eraId == TaseEra::UUSIERA )
+            erat.insert( viennit_[i].vientiId );
     }
 
 
     // Lopuksi pitäisi vielä poistaa ne rivit, jotka on poistettu...
     foreach (int id, poistetutVientiIdt_)
     {
-        if( !query.exec( QString("DELETE FROM vienti WHERE id=%1").arg(id)) )
+        if( !poisto.exec( QString("DELETE FROM laskurivi WHERE vienti=%1").arg(id)) ||
+            !poisto.exec( QString("DELETE FROM merkkaus WHERE vienti=%1").arg(id)) ||
+            !poisto.exec( QString("DELETE FROM vienti WHERE id=%1").arg(id)) )
         {
-            kp()->lokiin(query);
+            kp()->lokiin(poisto);
             return false;
         }
+        kirjoitettu = true;
     }
+    poistetutVientiIdt_.clear();
 
+    if( kirjoitettu && !erat.isEmpty() && !TaseEra::paivitaSaldot(erat))
+        return false;
+
+    muistaTallennetut();
     muokattu_ = false;
 
     return true;
 }
 
+bool VientiModel::tallennaLaskurivit(int vientiId, const QVariantList &laskurivit)
+{
+    QSqlQuery query( *kp()->tietokanta() );
+    if( !query.exec( QString("DELETE FROM laskurivi WHERE vienti=%1").arg(vientiId)))
+    {
+        kp()->lokiin(query);
+        return false;
+    }
+    if( laskurivit.isEmpty())
+        return true;
+
+    query.prepare("INSERT INTO laskurivi(vienti,nimike,maara,nettosnt,bruttosnt,"
+                  "alvkoodi,alvprosentti,tili,kohdennus,tuote) "
+                  "VALUES(:vienti,:nimike,:maara,:netto,:brutto,"
+                  ":alvkoodi,:alvprosentti,:tili,:kohdennus,:tuote)");
+
+    for( const QVariant& var : laskurivit)
+    {
+        QVariantMap map = var.toMap();
+        query.bindValue(":vienti", vientiId);
+        query.bindValue(":nimike", map.value("Nimike").toString());
+        query.bindValue(":maara", map.value("Maara").toDouble());
+        query.bindValue(":netto", map.value("Nettoyht").toLongLong());
+        query.bindValue(":brutto", map.value("Yhteensa").toLongLong());
+        query.bindValue(":alvkoodi", map.value("Alvkoodi").toInt());
+        query.bindValue(":alvprosentti", map.value("Alvprosentti").toInt());
+        query.bindValue(":tili", map.value("Tili").toInt());       // Tilin numero, kuten jsonissa
+        query.bindValue(":kohdennus", map.value("Kohdennus").toInt());
+        query.bindValue(":tuote", map.value("Tuotekoodi").toInt());
+        if( !query.exec())
+        {
+            kp()->lokiin(query);
+            return false;
+        }
+    }
+    return true;
+}
+
 void VientiModel::tyhjaa()
 {
     beginResetModel();
     viennit_.clear();
+    tallennetut_.clear();
+    tallennetutIndeksit_.clear();
+    poistetutVientiIdt_.clear();
     endResetModel();
     muokattu_ = false;
 }
@@ -769,8 +881,16 @@ void VientiModel::lataa()
 {
     beginResetModel();
     viennit_.clear();
+    poistetutVientiIdt_.clear();
 
+    // Tositteen kaikkien vientien tagit haetaan yhdellä kyselyllä
+    QHash<int, QList<Kohdennus>> tagit;
     QSqlQuery query( *tositeModel_->tietokanta() );
+    query.exec(QString("SELECT merkkaus.vienti, merkkaus.kohdennus FROM merkkaus, vienti "
+                       "WHERE merkkaus.vienti=vienti.id AND vienti.tosite=%1").arg( tositeModel_->id() ));
+    while( query.next())
+        tagit[ query.value(0).toInt() ].append( kp()->kohdennukset()->kohdennus( query.value(1).toInt() ) );
+
     query.exec(QString("SELECT id, pvm, tili, debetsnt, kreditsnt, selite, "
                        "alvkoodi, alvprosentti, luotu, muokattu, json, "
                        "kohdennus, eraid, vientirivi, viite, iban, erapvm, arkistotunnus, asiakas, laskupvm "
@@ -807,20 +927,41 @@ void VientiModel::lataa()
         rivi.asiakas = query.value("asiakas").toString();
         rivi.laskupvm = query.value("laskupvm").toDate();
 
-        // Tagien hakeminen
-        QSqlQuery tagiKysely( *tositeModel_->tietokanta() );
-        tagiKysely.exec( QString("SELECT kohdennus FROM merkkaus WHERE vienti=%1").arg(rivi.vientiId));
-        while( tagiKysely.next())
-        {
-            rivi.tagit.append( kp()->kohdennukset()->kohdennus( tagiKysely.value(0).toInt() ) );
-        }
-
+        rivi.tagit = tagit.value( rivi.vientiId );
 
         viennit_.append(rivi);
     }
 
+    muistaTallennetut();
     endResetModel();
     muokattu_ = false;
     emit muuttunut();
 }
 
+void VientiModel::muistaTallennetut()
+{
+    tallennetut_ = viennit_;
+    tallennetutIndeksit_.clear();
+    for(int i=0; i < tallennetut_.count(); i++)
+        if( tallennetut_.at(i).vientiId )
+            tallennetutIndeksit_.insert( tallennetut_.at(i).vientiId, i);
+}
+
+bool VientiModel::samat(const VientiRivi &rivi, const VientiRivi &tallennettu)
+{
+    if( rivi.pvm != tallennettu.pvm || rivi.tili.id() != tallennettu.tili.id() ||
+        rivi.selite != tallennettu.selite || rivi.debetSnt != tallennettu.debetSnt ||
+        rivi.kreditSnt != tallennettu.kreditSnt || rivi.alvkoodi != tallennettu.alvkoodi ||
+        rivi.alvprosentti != tallennettu.alvprosentti || rivi.kohdennus.id() != tallennettu.kohdennus.id() ||
+        rivi.eraId != tallennettu.eraId || rivi.viite != tallennettu.viite ||
+        rivi.ibanTili != tallennettu.ibanTili || rivi.laskupvm != tallennettu.laskupvm ||
+        rivi.erapvm != tallennettu.erapvm || rivi.asiakas != tallennettu.asiakas ||
+        rivi.arkistotunnus != tallennettu.arkistotunnus || rivi.tagit.count() != tallennettu.tagit.count())
+        return false;
+
+    for(int i=0; i < rivi.tagit.count(); i++)
+        if( rivi.tagit.at(i).id() != tallennettu.tagit.at(i).id())
+            return false;
+
+    return rivi.json.toJson() == tallennettu.json.toJson();
+}
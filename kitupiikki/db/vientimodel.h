@@ -20,6 +20,7 @@
 
 #include <QAbstractTableModel>
 #include <QList>
+#include <QHash>
 
 #include "db/tili.h"
 #include "db/kohdennus.h"
@@ -157,6 +158,20 @@ public:
      */
     void uusiPohjalta(const QString& otsikko);
 
+    /**
+     * @brief Tallentaa laskun rivit laskurivi-tauluun
+     *
+     * Laskurivit ovat laskun rahavientien json-kentässä, mutta myyntiraporttia
+     * varten ne puretaan myös omaan tauluunsa, jotta raportti voidaan laskea
+     * yhdellä SQL-koosteella purkamatta jokaisen viennin jsonia.
+     *
+     * @param vientiId Laskun rahaviennin id
+     * @param laskurivit Json-kentän Laskurivit-lista (tyhjä poistaa rivit)
+     * @return tosi, jos onnistui
+     * @since 1.5
+     */
+    static bool tallennaLaskurivit(int vientiId, const QVariantList& laskurivit);
+
 public slots:
     /**
      * @brief Tallentaa viennit
@@ -171,12 +186,25 @@ signals:
     void muuttunut();
 
 protected:
+    /**
+     * @brief Merkitsee nykyiset viennit tallennetuiksi
+     *
+     * Tallennettaessa verrataan tähän kopioon, jotta vain muuttuneet
+     * rivit kirjoitetaan. Kopio ei vie juuri muistia, koska rivien
+     * tiedot ovat jaettuja.
+     */
+    void muistaTallennetut();
+    static bool samat(const VientiRivi& rivi, const VientiRivi& tallennettu);
+
     TositeModel *tositeModel_;
     QList<VientiRivi> viennit_;
 
     bool muokattu_;
 
     QList<int> poistetutVientiIdt_;
+
+    QList<VientiRivi> tallennetut_;
+    QHash<int,int> tallennetutIndeksit_;
 };
 
 #endif // VIENTIMODEL_H
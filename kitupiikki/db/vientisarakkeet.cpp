@@ -0,0 +1,124 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QSqlQuery>
+
+#include <algorithm>
+#include <limits>
+
+#include "vientisarakkeet.h"
+#include "kirjanpito.h"
+
+const VientiSarakkeet &VientiSarakkeet::viennit()
+{
+    if( viennit__.avauskerta_ != kp()->avauskerta() ||
+        viennit__.versio_ != kp()->muutokset()->versio() )
+        viennit__.lataa();
+    return viennit__;
+}
+
+QMap<int, VientiSarakkeet::Summa> VientiSarakkeet::summat(const QDate &alkaa, const QDate &paattyy, int ysiluvusta, int ysiluvulle) const
+{
+    QMap<int,Summa> summat;
+
+    qint64 alkupaiva = alkaa.isValid() ? alkaa.toJulianDay() : std::numeric_limits<qint64>::min();
+    qint64 loppupaiva = paattyy.toJulianDay();
+
+    int tili = static_cast<int>( std::lower_bound( ysiluvut_.constBegin(), ysiluvut_.constEnd(), ysiluvusta) - ysiluvut_.constBegin());
+
+    for( ; tili < ysiluvut_.count() && ysiluvut_.at(tili) <= ysiluvulle; tili++)
+    {
+        const qint64* tilinAlku = pvm_.constData() + tiliAlut_.at(tili);
+        const qint64* tilinLoppu = pvm_.constData() + tiliAlut_.at(tili+1);
+
+        int mista = static_cast<int>( std::lower_bound( tilinAlku, tilinLoppu, alkupaiva) - pvm_.constData());
+        int mihin = static_cast<int>( std::upper_bound( tilinAlku, tilinLoppu, loppupaiva) - pvm_.constData());
+
+        if( mihin <= mista )
+            continue;
+
+        Summa& yhteensa = summat[ ysiluvut_.at(tili) ];
+        yhteensa.debet += debetKertyma_.at(mihin) - debetKertyma_.at(mista);
+        yhteensa.kredit += kreditKertyma_.at(mihin) - kreditKertyma_.at(mista);
+    }
+    return summat;
+}
+
+VientiSarakkeet::Summa VientiSarakkeet::yhteensa(const QDate &alkaa, const QDate &paattyy, int ysiluvusta, int ysiluvulle) const
+{
+    Summa yhteensa;
+    QMapIterator<int,Summa> iter( summat(alkaa, paattyy, ysiluvusta, ysiluvulle));
+    while( iter.hasNext())
+    {
+        iter.next();
+        yhteensa.debet += iter.value().debet;
+        yhteensa.kredit += iter.value().kredit;
+    }
+    return yhteensa;
+}
+
+void VientiSarakkeet::lataa()
+{
+    avauskerta_ = kp()->avauskerta();
+    versio_ = kp()->muutokset()->versio();
+
+    ysiluvut_.clear();
+    tiliAlut_.clear();
+    pvm_.clear();
+    tili_.clear();
+    alvkoodi_.clear();
+    debetKertyma_.clear();
+    kreditKertyma_.clear();
+
+    QSqlQuery kysely;
+    kysely.setForwardOnly(true);
+    kysely.exec("SELECT tili.ysiluku, vienti.tili, vienti.pvm, vienti.alvkoodi, vienti.debetsnt, vienti.kreditsnt "
+                "FROM vienti, tili WHERE vienti.tili=tili.id ORDER BY tili.ysiluku, vienti.tili, vienti.pvm");
+
+    int edellinenTili = -1;
+    qlonglong debetKertyma = 0;
+    qlonglong kreditKertyma = 0;
+    debetKertyma_.append(0);
+    kreditKertyma_.append(0);
+
+    while( kysely.next())
+    {
+        int tili = kysely.value(1).toInt();
+        if( tili != edellinenTili )
+        {
+            // Uuden tilin viennit alkavat
+            ysiluvut_.append( kysely.value(0).toInt() );
+            tiliAlut_.append( pvm_.count() );
+            edellinenTili = tili;
+        }
+
+        qlonglong debet = kysely.value(4).toLongLong();
+        qlonglong kredit = kysely.value(5).toLongLong();
+
+        pvm_.append( kysely.value(2).toDate().toJulianDay() );
+        tili_.append( tili );
+        alvkoodi_.append( kysely.value(3).toInt() );
+
+        debetKertyma += debet;
+        kreditKertyma += kredit;
+        debetKertyma_.append( debetKertyma );
+        kreditKertyma_.append( kreditKertyma );
+    }
+    tiliAlut_.append( pvm_.count() );
+}
+
+VientiSarakkeet VientiSarakkeet::viennit__;
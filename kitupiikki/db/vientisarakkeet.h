@@ -0,0 +1,94 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VIENTISARAKKEET_H
+#define VIENTISARAKKEET_H
+
+#include <QVector>
+#include <QMap>
+#include <QDate>
+#include <QString>
+
+/**
+ * @brief Vientien sarakemuotoinen kopio raportteja varten
+ *
+ * Viennit luetaan kerralla muistiin sarakkeittain (päivämäärä päivänumerona,
+ * tili, alv-koodi sekä debet- ja kredit-kertymät). Viennit on järjestetty tilin
+ * ysiluvun ja päivämäärän mukaan, ja tilien alkukohdat ovat omassa
+ * taulukossaan. Tilin päivämääräväli löytyy binäärihaulla ja summa
+ * tilikohtaisista kertymistä, joten raportin sarakkeen laskeminen ei vaadi
+ * tietokantakyselyä.
+ *
+ * Kopio luetaan uudelleen, kun muutosloki kertoo kirjanpidon muuttuneen
+ * tai kirjanpito avataan uudelleen.
+ *
+ * @since 1.5
+ */
+class VientiSarakkeet
+{
+public:
+    struct Summa
+    {
+        qlonglong debet = 0;
+        qlonglong kredit = 0;
+    };
+
+    /**
+     * @brief Ajantasainen kopio avoimen kirjanpidon vienneistä
+     */
+    static const VientiSarakkeet& viennit();
+
+    /**
+     * @brief Summat ysiluvuittain
+     * @param alkaa Alkupäivä, tyhjä jos kirjanpidon alusta
+     * @param paattyy Loppupäivä
+     * @param ysiluvusta Pienin mukaan otettava ysiluku
+     * @param ysiluvulle Suurin mukaan otettava ysiluku
+     * @return ysiluku, summat
+     */
+    QMap<int,Summa> summat(const QDate& alkaa, const QDate& paattyy,
+                           int ysiluvusta, int ysiluvulle) const;
+
+    /**
+     * @brief Kaikkien välille osuvien vientien yhteissumma
+     */
+    Summa yhteensa(const QDate& alkaa, const QDate& paattyy,
+                   int ysiluvusta, int ysiluvulle) const;
+
+    int vienteja() const { return pvm_.count(); }
+
+protected:
+    void lataa();
+
+    QVector<int> ysiluvut_;     // Tilien ysiluvut järjestyksessä
+    QVector<int> tiliAlut_;     // Tilin ensimmäisen viennin indeksi, viimeisenä vientien määrä
+
+    QVector<qint64> pvm_;       // Juliaaninen päivänumero
+    QVector<int> tili_;         // Tilin id
+    QVector<int> alvkoodi_;
+
+    // Kertymät: indeksin i arvo on vientien 0..i-1 summa
+    QVector<qlonglong> debetKertyma_;
+    QVector<qlonglong> kreditKertyma_;
+
+    qlonglong versio_ = -1;
+    int avauskerta_ = -1;
+
+    static VientiSarakkeet viennit__;
+};
+
+#endif // VIENTISARAKKEET_H
@@ -18,8 +18,7 @@
 
 #include "db/tositemodel.h"
 #include "db/kirjanpito.h"
-
-#include <QSqlQuery>
+#include "db/tositejarjestys.h"
 
 EdellinenSeuraavaTieto::EdellinenSeuraavaTieto(TositeModel *model, QObject *parent) :
     QObject(parent), model_(model)
@@ -34,33 +33,10 @@ void EdellinenSeuraavaTieto::paivita()
 
     if( model_->tunniste() )
     {
-        // Haetaan kaikki kyseisen tilikauden tositteet järjestykseen
-
-        QSqlQuery kysely;
-        Tilikausi nykykausi = kp()->tilikaudet()->tilikausiPaivalle(model_->pvm());
-
-        if( kp()->asetukset()->onko("Samaansarjaan") )
-            kysely.exec( QString("SELECT id FROM tosite WHERE pvm BETWEEN '%1' and '%2' ORDER BY tunniste")
-                         .arg( nykykausi.alkaa().toString(Qt::ISODate) ).arg( nykykausi.paattyy().toString(Qt::ISODate)) );
-        else
-            kysely.exec( QString("SELECT tosite.id FROM tosite JOIN tositelaji ON tosite.laji=tositelaji.id "
-                                 "WHERE pvm BETWEEN '%1' AND '%2' "
-                                 "ORDER BY tositelaji.tunnus,tosite.tunniste")
-                         .arg( nykykausi.alkaa().toString(Qt::ISODate) ).arg( nykykausi.paattyy().toString(Qt::ISODate)) );
-
-        int edellinen = -1;
-
-        while( kysely.next() )
-        {
-            if( kysely.value(0).toInt() == model_->id())
-            {
-                edellinenId_ = edellinen;
-                if( kysely.next())
-                    seuraavaId_ = kysely.value(0).toInt();
-                break;
-            }
-            edellinen = kysely.value(0).toInt();
-        }
+        // Tilikauden tositteiden järjestys pidetään muistissa
+        TositeJarjestys jarjestys = TositeJarjestys::kaudelle( kp()->tilikaudet()->tilikausiPaivalle(model_->pvm()) );
+        edellinenId_ = jarjestys.edellinen( model_->id() );
+        seuraavaId_ = jarjestys.seuraava( model_->id() );
     }
 
     // Lopuksi ilmoitukset
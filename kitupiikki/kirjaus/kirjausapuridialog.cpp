@@ -22,6 +22,7 @@
 #include <QShortcut>
 #include <cmath>
 #include "kohdennusproxymodel.h"
+#include "db/kirjausehdotukset.h"
 #include "kirjausapuridialog.h"
 #include "ui_kirjausapuridialog.h"
 #include "validator/ibanvalidator.h"
@@ -98,6 +99,7 @@ KirjausApuriDialog::KirjausApuriDialog(TositeModel *tositeModel, QWidget *parent
     connect( ui->nettoSpin, SIGNAL(valueChanged(double)), this, SLOT(laskeBrutto(double)));
     connect( ui->alvSpin, SIGNAL(valueChanged(int)), this, SLOT(laskeVerolla(int)));
     connect( ui->vaihdaNappi, &QPushButton::clicked, this, &KirjausApuriDialog::vaihdaDebetKredit);
+    connect(ui->seliteEdit, SIGNAL(editingFinished()), this, SLOT(ehdotaTilia()));
     connect(ui->seliteEdit, SIGNAL(editingFinished()), this, SLOT(ehdota()));
     connect( ui->eiVahennaCheck, SIGNAL(toggled(bool)), this, SLOT(ehdota()));
     connect( ui->ohjeNappi, &QPushButton::clicked, [] { kp()->ohje("kirjaus/apuri");} );
@@ -512,6 +514,25 @@ void KirjausApuriDialog::veroSuodattimetKuntoon()
     alvLajiMuuttui();
 }
 
+void KirjausApuriDialog::ehdotaTilia()
+{
+    if( ui->tiliEdit->valittuTilinumero() || ui->valintaTab->currentIndex() == SIIRTO )
+        return;
+
+    // Menoissa tili on debet-puolella, tuloissa kredit-puolella
+    KirjausEhdotukset::Ehdotus ehdotus = KirjausEhdotukset::ehdota( ui->seliteEdit->text(),
+                                                                   ui->valintaTab->currentIndex() == MENO,
+                                                                   ui->vastatiliEdit->valittuTili().id());
+    if( ehdotus.kertoja )
+    {
+        ui->tiliEdit->valitseTiliIdlla( ehdotus.tiliId );
+        tiliTaytetty();
+        int kohdennus = ui->kohdennusCombo->findData( ehdotus.kohdennusId, KohdennusModel::IdRooli);
+        if( kohdennus > -1)
+            ui->kohdennusCombo->setCurrentIndex( kohdennus );
+    }
+}
+
 void KirjausApuriDialog::ehdota()
 {
     ehdotus.tyhjaa();
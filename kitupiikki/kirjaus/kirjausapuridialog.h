@@ -76,6 +76,13 @@ public slots:
 
     void ehdota();
 
+    /**
+     * @brief Esitäyttää tilin aiempien samanlaisten selitteiden perusteella
+     *
+     * Tili ehdotetaan vain, jos sitä ei ole vielä valittu.
+     */
+    void ehdotaTilia();
+
     /**
      * @brief Päivitetään dialogi välilehden vaihtumisen mukaan
      * @param indeksi
@@ -18,7 +18,7 @@
 #include <QDebug>
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QSqlQueryModel>
+#include <QStringListModel>
 #include <QMessageBox>
 #include <QIntValidator>
 #include <QFileDialog>
@@ -61,12 +61,14 @@
 #include "ui_kopioitosite.h"
 
 #include "edellinenseuraavatieto.h"
+#include "db/taydennyshakemisto.h"
+#include "db/tositenumerointi.h"
 #include "verotarkastaja.h"
 
 
 KirjausWg::KirjausWg(TositeModel *tositeModel, QWidget *parent)
     : QWidget(parent), model_(tositeModel), laskuDlg_(nullptr), apurivinkki_(nullptr),
-      taydennysSql_( new QSqlQueryModel )
+      taydennys_( new QStringListModel(this) )
 {
     ui = new Ui::KirjausWg();
     ui->setupUi(this);
@@ -166,8 +168,10 @@ KirjausWg::KirjausWg(TositeModel *tositeModel, QWidget *parent)
 
     ui->tositePvmEdit->setCalendarPopup(true);
 
-    QCompleter *otsikonTaydentaja = new QCompleter(taydennysSql_, this);
-    otsikonTaydentaja->setModelSorting(QCompleter::CaseSensitivelySortedModel);
+    // Täydennyksen malliin haetaan vain alkuosaa vastaavat otsikot yleisyysjärjestyksessä
+    QCompleter *otsikonTaydentaja = new QCompleter(taydennys_, this);
+    otsikonTaydentaja->setModelSorting(QCompleter::UnsortedModel);
+    otsikonTaydentaja->setCaseSensitivity(Qt::CaseInsensitive);
     ui->otsikkoEdit->setCompleter(otsikonTaydentaja);
     connect( ui->otsikkoEdit, SIGNAL(textChanged(QString)), this, SLOT(paivitaOtsikonTaydennys(QString)));
 
@@ -450,15 +454,14 @@ void KirjausWg::numeroSiirto()
     if( dlg.exec() == QDialog::Accepted )
     {
         // Siirretään tunnistenumeroita eteenpäin
-
-        QString kasky = QString("UPDATE tosite SET tunniste = tunniste + %1 WHERE laji = %2 AND tunniste >= %3 AND pvm BETWEEN '%4' AND '%5'")
-                .arg( dui.lisaaSpin->value() )
-                .arg( ui->tositetyyppiCombo->currentData(TositelajiModel::IdRooli).toInt() )
-                .arg( dui.alkuSpin->value())
-                .arg( kausi.alkaa().toString(Qt::ISODate) )
-                .arg( kausi.paattyy().toString(Qt::ISODate));
-
-        QSqlQuery kysely(kasky);
+        if( TositeNumerointi::siirra( *kp()->tietokanta(), kausi.alkaa(), kausi.paattyy(),
+                                      ui->tositetyyppiCombo->currentData(TositelajiModel::IdRooli).toInt(),
+                                      dui.alkuSpin->value(), dui.lisaaSpin->value()))
+        {
+            kp()->muutokset()->kirjaa("tosite", 0, kausi.alkaa(), kausi.paattyy());
+            kp()->muutokset()->vahvista();
+            emit kp()->kirjanpitoaMuokattu();
+        }
 
         paivitaTunnisteVari();
     }
@@ -501,10 +504,10 @@ void KirjausWg::siirryTositteeseen()
 
 void KirjausWg::paivitaOtsikonTaydennys(const QString &teksti)
 {
-    if( teksti.length() > 2 && !teksti.contains(QChar('\'')))
-        taydennysSql_->setQuery(QString("SELECT otsikko FROM tosite WHERE otsikko LIKE '%1%' order by otsikko").arg(teksti));
+    if( teksti.length() > 2 )
+        taydennys_->setStringList( TaydennysHakemisto::otsikot().hae(teksti) );
     else
-        taydennysSql_->clear();
+        taydennys_->setStringList( QStringList() );
 
     model()->asetaOtsikko(teksti);
 }
@@ -32,7 +32,7 @@ class Kirjanpito;
 class LaskunMaksuDialogi;
 class ApuriVinkki;
 class QAction;
-class QSqlQueryModel;
+class QStringListModel;
 class EdellinenSeuraavaTieto;
 
 /**
@@ -227,7 +227,7 @@ protected:
     QAction *uudeksiAktio_;
     QAction *tyhjennaViennitAktio_;
 
-    QSqlQueryModel *taydennysSql_;
+    QStringListModel *taydennys_;
     QSortFilterProxyModel *tyyppiProxy_;
 
     EdellinenSeuraavaTieto *edellinenSeuraava_;
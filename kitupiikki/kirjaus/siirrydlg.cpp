@@ -15,10 +15,9 @@
    along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <QSqlQuery>
-
 #include "siirrydlg.h"
 #include "db/kirjanpito.h"
+#include "db/tositejarjestys.h"
 
 SiirryDlg::SiirryDlg() :
     ui(new Ui::SiirryDlg())
@@ -46,28 +45,10 @@ SiirryDlg::SiirryDlg() :
 
 void SiirryDlg::tarkista()
 {
-    QString kysymys;
-
-    if(kp()->asetukset()->onko("Samaansarjaan"))
-    {
-        kysymys = QString("SELECT id FROM tosite WHERE tunniste=%1 AND pvm BETWEEN '%2' AND '%3'")
-                .arg( ui->nroEdit->text().toInt() )
-                .arg( ui->kausiCombo->currentData(TilikausiModel::AlkaaRooli).toDate().toString(Qt::ISODate))
-                .arg( ui->kausiCombo->currentData(TilikausiModel::PaattyyRooli).toDate().toString(Qt::ISODate));
-    } else {
-        kysymys = QString("SELECT id FROM tosite WHERE tunniste=%1 AND laji=%2 AND pvm BETWEEN '%3' AND '%4'")
-                .arg( ui->nroEdit->text().toInt() )
-                .arg( ui->tyyppiCombo->currentData(TositelajiModel::IdRooli).toInt())
-                .arg( ui->kausiCombo->currentData(TilikausiModel::AlkaaRooli).toDate().toString(Qt::ISODate))
-                .arg( ui->kausiCombo->currentData(TilikausiModel::PaattyyRooli).toDate().toString(Qt::ISODate));
-    }
-
-    QSqlQuery kysely( kysymys );
-    tosite = 0;
-
-    if( kysely.next())
-        tosite = kysely.value(0).toInt();
-
+    // Haetaan tilikauden tositejärjestyksestä, ettei jokainen näppäilty numero vaadi kyselyä
+    Tilikausi kausi = kp()->tilikausiPaivalle( ui->kausiCombo->currentData(TilikausiModel::AlkaaRooli).toDate() );
+    tosite = TositeJarjestys::kaudelle(kausi).tosite( ui->tyyppiCombo->currentData(TositelajiModel::IdRooli).toInt(),
+                                                      ui->nroEdit->text().toInt() );
     ui->siirryNappi->setEnabled( tosite );
 }
 
@@ -66,6 +66,8 @@ SOURCES += main.cpp \
     db/tilikausimodel.cpp \
     kitupiikkisivu.cpp \
     raportti/raportinkirjoittaja.cpp \
+    raportti/raporttikohde.cpp \
+    raportti/raporttivirta.cpp \
     raportti/raporttirivi.cpp \
     db/tositemodel.cpp \
     db/vientimodel.cpp \
@@ -123,6 +125,7 @@ SOURCES += main.cpp \
     raportti/taseerittely.cpp \
     arkisto/tilinpaattaja.cpp \
     arkisto/poistaja.cpp \
+    arkisto/poistolaskelma.cpp \
     maaritys/kaavankorostin.cpp \
     kirjaus/kohdennusproxymodel.cpp \
     maaritys/tilikarttaohje.cpp \
@@ -191,7 +194,17 @@ SOURCES += main.cpp \
     kirjaus/viennitview.cpp \
     kirjaus/edellinenseuraavatieto.cpp \
     uusikp/numerointisivu.cpp \
-    kirjaus/verotarkastaja.cpp
+    kirjaus/verotarkastaja.cpp \
+    db/muutosloki.cpp \
+    raportti/raporttivalimuisti.cpp \
+    raportti/raporttikaava.cpp \
+    db/vientisarakkeet.cpp \
+    alv/alvkuutio.cpp \
+    db/varmuuskopioija.cpp \
+    db/tositejarjestys.cpp \
+    db/taydennyshakemisto.cpp \
+    db/kirjausehdotukset.cpp \
+    db/tositenumerointi.cpp
 
 HEADERS += \
     uusikp/uusikirjanpito.h \
@@ -231,6 +244,8 @@ HEADERS += \
     maaritys/maarityswidget.h \
     kitupiikkisivu.h \
     raportti/raportinkirjoittaja.h \
+    raportti/raporttikohde.h \
+    raportti/raporttivirta.h \
     raportti/raporttirivi.h \
     db/tositemodel.h \
     db/vientimodel.h \
@@ -287,6 +302,7 @@ HEADERS += \
     raportti/taseerittely.h \
     arkisto/tilinpaattaja.h \
     arkisto/poistaja.h \
+    arkisto/poistolaskelma.h \
     maaritys/kaavankorostin.h \
     kirjaus/kohdennusproxymodel.h \
     maaritys/tilikarttaohje.h \
@@ -356,7 +372,17 @@ HEADERS += \
     kirjaus/viennitview.h \
     kirjaus/edellinenseuraavatieto.h \
     uusikp/numerointisivu.h \
-    kirjaus/verotarkastaja.h
+    kirjaus/verotarkastaja.h \
+    db/muutosloki.h \
+    raportti/raporttivalimuisti.h \
+    raportti/raporttikaava.h \
+    db/vientisarakkeet.h \
+    alv/alvkuutio.h \
+    db/varmuuskopioija.h \
+    db/tositejarjestys.h \
+    db/taydennyshakemisto.h \
+    db/kirjausehdotukset.h \
+    db/tositenumerointi.h
 
 RESOURCES += \
     tilikartat/tilikartat.qrc \
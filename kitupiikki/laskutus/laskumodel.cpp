@@ -28,6 +28,7 @@
 
 #include <cmath>
 #include <QSqlQuery>
+#include <QSet>
 #include <QPrinter>
 #include <QBuffer>
 #include <QPdfWriter>
@@ -563,20 +564,61 @@ qulonglong LaskuModel::laskunro() const
     if( laskunNumero_)
         return laskunNumero_;
 
+    // Numero varataan ensimmäisellä kutsulla, jotta tulostettaessa ja
+    // tallennettaessa ei tarvitse hakea vapaata numeroa joka kerta uudelleen
+    if( !varattuNumero_)
+        varattuNumero_ = varaaLaskunumerot(1).value(0);
+
+    return varattuNumero_;
+}
+
+QList<qulonglong> LaskuModel::varaaLaskunumerot(int kpl)
+{
+    QList<qulonglong> numerot;
+    if( kpl < 1)
+        return numerot;
+
+    // Varaus kirjoitetaan samassa transaktiossa seuraavan numeron
+    // laskuriin, jotta kaksi avointa laskua ei saa samaa numeroa
+    bool transaktio = kp()->tietokanta()->transaction();
+
     qulonglong pohjanro = kp()->asetukset()->isoluku("LaskuSeuraavaId") / 10;
     if( pohjanro < 100)
         pohjanro = 100;
 
-    while(true)
+    // Jo käytetyt numerot haetaan yhdellä kyselyllä numeron pituutta kohden,
+    // jotta vapaat numerot löydetään ilman numerokohtaisia kyselyitä.
+    // Viite on tekstikenttä, joten saman pituisia numeroita haetaan
+    // tekstivälinä, jolloin haku käyttää iban-viite -indeksiä
+    QSet<qulonglong> kaytetyt;
+    int haettuPituus = 0;
+
+    while( numerot.count() < kpl )
     {
         // Lasketaan aina tunnistenumero uudelleen!!!
         qulonglong numero = pohjanro * 10 + laskeViiteTarkiste(pohjanro);
+        QString numeroTekstina = QString::number(numero);
+
+        if( numeroTekstina.length() != haettuPituus )
+        {
+            haettuPituus = numeroTekstina.length();
+            QSqlQuery kysely( QString("SELECT viite FROM vienti WHERE iban IS NULL AND viite BETWEEN '%1' AND '%2'")
+                              .arg( numeroTekstina ).arg( QString(haettuPituus, QChar('9'))));
+            while( kysely.next())
+                kaytetyt.insert( kysely.value(0).toULongLong() );
+        }
+
         // Varmistetaan, että tämä numero ei vielä ole käytössä!
-        QSqlQuery kysely(QString("SELECT viite FROM vienti WHERE viite='%1' AND iban IS NULL").arg(numero));
-        if( !kysely.next())
-            return numero;
+        if( !kaytetyt.contains(numero))
+            numerot.append(numero);
         pohjanro++;
     }
+
+    kp()->asetukset()->aseta("LaskuSeuraavaId", pohjanro * 10 + laskeViiteTarkiste(pohjanro));
+    if( transaktio )
+        kp()->tietokanta()->commit();
+
+    return numerot;
 }
 
 QString LaskuModel::viitenumero() const
@@ -645,6 +687,7 @@ void LaskuModel::haeRyhmasta(int indeksi)
     osoite_ =  ind.data(LaskuRyhmaModel::OsoiteRooli).toString();
     email_ = ind.data(LaskuRyhmaModel::SahkopostiRooli).toString();
     laskunNumero_ = ind.data(LaskuRyhmaModel::ViiteRooli).toULongLong();
+    ryhmaIndeksi_ = indeksi;
     ytunnus_ = ind.data(LaskuRyhmaModel::YTunnusRooli).toString();
     verkkolaskuOsoite_ = ind.data(LaskuRyhmaModel::VerkkoLaskuOsoiteRooli).toString();
     verkkolaskuValittaja_ = ind.data(LaskuRyhmaModel::VerkkoLaskuValittajaRooli).toString();
@@ -658,13 +701,19 @@ bool LaskuModel::tallenna(Tili rahatili)
     if( tyyppi() == RYHMALASKU)
     {
         bool onni = true;
+        ryhmaModel()->varaaViitteet();
         tyyppi_ = LASKU;
+
+        // Yhteinen tulostaja, jotta logo skaalataan vain kerran
+        LaskunTulostaja tulostaja(this);
+        ryhmanTulostaja_ = &tulostaja;
         for(int i=0; i < ryhmaModel()->rowCount(QModelIndex()); i++)
         {
             haeRyhmasta(i);
             if( !tallenna(rahatili) )
                 onni = false;
         }
+        ryhmanTulostaja_ = nullptr;
         tyyppi_ = RYHMALASKU;
         return onni;
     }
@@ -715,9 +764,16 @@ bool LaskuModel::tallenna(Tili rahatili)
     // Luo tilapäisen pdf-tiedoston
 
     QString liiteOtsikko = tr("Lasku nr %1").arg(laskunro());
-    LaskunTulostaja tulostaja(this);
+    QByteArray pdf;
+    if( ryhmanTulostaja_ )
+        pdf = ryhmanTulostaja_->pdf();
+    else
+    {
+        LaskunTulostaja tulostaja(this);
+        pdf = tulostaja.pdf();
+    }
 
-    int liitenro = tosite.liiteModel()->lisaaLiite( tulostaja.pdf(), liiteOtsikko );
+    int liitenro = tosite.liiteModel()->lisaaLiite( pdf, liiteOtsikko );
 
 
     // #96 Laskun kirjaaminen yhdistelmäriveillä
@@ -932,10 +988,12 @@ bool LaskuModel::tallenna(Tili rahatili)
         return false;
     }
     // Laskunumeroinnin korjaus ryhmälaskuja tallennettaessa #351
-    if( laskunro() == kp()->asetukset()->isoluku("LaskuSeuraavaId"))
-        kp()->asetukset()->aseta("LaskuSeuraavaId",  (laskunro() / 10 + 1) * 10 + laskeViiteTarkiste( laskunro() / 10 + 1));
-    else if( laskunro() > kp()->asetukset()->isoluku("LaskuSeuraavaId"))
-        kp()->asetukset()->aseta("LaskuSeuraavaId",  laskunro() );
+    // Seuraavaksi numeroksi merkitään tätä seuraava, jolloin seuraavan laskun
+    // numeron varaaminen alkaa suoraan vapaasta numerosta
+    qulonglong numero = laskunro();
+    if( numero >= kp()->asetukset()->isoluku("LaskuSeuraavaId"))
+        kp()->asetukset()->aseta("LaskuSeuraavaId",  (numero / 10 + 1) * 10 + laskeViiteTarkiste( numero / 10 + 1));
+    varattuNumero_ = 0;
 
     return true;
 }
@@ -979,7 +1037,7 @@ QString LaskuModel::tositetunnus()
         Tositelaji laji = kp()->tositelajit()->tositelaji( kp()->asetukset()->luku("LaskuTositelaji") );
         int ryhmalisays = 0;
         if( tyyppi() == RYHMALASKU  )
-            ryhmalisays = static_cast<int>(laskunNumero_ / 10 - kp()->asetukset()->isoluku("LaskuSeuraavaId") / 10);
+            ryhmalisays = ryhmaIndeksi_;
 
         return QString("%1%2/%3").arg(laji.tunnus()).arg(laji.seuraavanTunnistenumero( pvm() ) + ryhmalisays )
                           .arg( kp()->tilikausiPaivalle(kp()->paivamaara()).kausitunnus());
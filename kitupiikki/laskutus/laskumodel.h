@@ -31,6 +31,7 @@
 #include <memory>
 
 class LaskuRyhmaModel;
+class LaskunTulostaja;
 
 /**
  * @brief Laskun alv-erittelyn yksi rivi
@@ -228,6 +229,19 @@ public:
      */
     static unsigned int laskeViiteTarkiste(qulonglong luvusta);
 
+    /**
+     * @brief Varaa seuraavat vapaat laskunumerot
+     *
+     * Käytetyt numerot haetaan yhdellä kyselyllä, joten ryhmälaskulle
+     * voidaan varata kaikki numerot kerralla. Varaus siirtää asetuksen
+     * LaskuSeuraavaId varattujen numeroiden ohi, joten varattua numeroa
+     * ei anneta toiselle laskulle, vaikka laskua ei tallennettaisi.
+     *
+     * @param kpl Varattavien numeroiden määrä
+     * @return Vapaat laskunumerot tarkisteineen nousevassa järjestyksessä
+     */
+    static QList<qulonglong> varaaLaskunumerot(int kpl);
+
     /**
      * @brief Kirjanpidon tositetunnus
      *
@@ -274,6 +288,8 @@ private:
     Laskutyppi tyyppi_ = LASKU;
     int tositeId_ = 0;
     qulonglong laskunNumero_ = 0;
+    mutable qulonglong varattuNumero_ = 0;
+    int ryhmaIndeksi_ = 0;
     int vientiId_ = 0;
     qlonglong avoinSaldo_ = 0;
     bool muokattu_ = false;
@@ -284,6 +300,7 @@ private:
     double viivkorko_;
 
     LaskuRyhmaModel* ryhma_ = nullptr;
+    LaskunTulostaja* ryhmanTulostaja_ = nullptr;   ///< Ryhmälaskun kaikkien laskujen yhteinen tulostaja
 
     QMap<QString,QString> tekstit_;
 
@@ -364,7 +364,8 @@ void LaskunTulostaja::ylaruudukko(QPagedPaintDevice *printer, QPainter *painter,
         double logosuhde = (1.0 * kp()->logo().width() ) / kp()->logo().height();
         double skaala = logosuhde < 5.00 ? logosuhde : 5.00;    // Logon sallittu suhde enintään 5:1
 
-        painter->drawImage( QRectF( lahettajaAlue.x()+mm, lahettajaAlue.y()+mm, rk*2*skaala, rk*2 ),  kp()->logo()  );
+        QRectF logoRect( lahettajaAlue.x()+mm, lahettajaAlue.y()+mm, rk*2*skaala, rk*2 );
+        painter->drawImage( logoRect,  logo( logoRect.size().toSize() )  );
         vasen += rk * 2.2 * skaala;
 
     }
@@ -846,7 +847,32 @@ QByteArray LaskunTulostaja::qrSvg() const
     data.append(muotoiltuViite().remove(QChar(' ')) + "\n\n");
     data.append( QString("ReqdExctnDt/%1").arg( model_->erapaiva().toString(Qt::ISODate) ));
 
-    qrcodegen::QrCode qr = qrcodegen::QrCode::encodeText( data.toUtf8().data() , qrcodegen::QrCode::Ecc::QUARTILE);
-    return QByteArray::fromStdString( qr.toSvgString(1) );
+    // Esikatselussa ja tulostettaessa koodi muodostetaan vain kerran
+    if( data != qrData_ )
+    {
+        qrcodegen::QrCode qr = qrcodegen::QrCode::encodeText( data.toUtf8().data() , qrcodegen::QrCode::Ecc::QUARTILE);
+        qrSvg_ = QByteArray::fromStdString( qr.toSvgString(1) );
+        qrData_ = data;
+    }
+    return qrSvg_;
+}
+
+QImage LaskunTulostaja::logo(const QSize &koko)
+{
+    // Suuri logo pienennetään kerran tulostuskokoon, jolloin samalla
+    // tulostajalla tulostettavat laskut (ryhmälaskut) käyttävät valmista kuvaa.
+    // Skaalataan uudelleen, jos logo vaihdetaan tai avataan toinen kirjanpito
+    if( koko != logonKoko_ || logo_.isNull() ||
+        logonAvauskerta_ != kp()->avauskerta() || logonAvain_ != kp()->logo().cacheKey())
+    {
+        logonKoko_ = koko;
+        logonAvauskerta_ = kp()->avauskerta();
+        logonAvain_ = kp()->logo().cacheKey();
+        if( kp()->logo().width() > koko.width() || kp()->logo().height() > koko.height())
+            logo_ = kp()->logo().scaled( koko, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+        else
+            logo_ = kp()->logo();
+    }
+    return logo_;
 }
 
@@ -23,6 +23,7 @@
 #include <QPrinter>
 #include <QFile>
 #include <QMap>
+#include <QImage>
 
 #include "laskumodel.h"
 
@@ -109,9 +110,24 @@ protected:
      */
     QByteArray qrSvg() const;
 
+    /**
+     * @brief Logo tulostuskokoon pienennettynä
+     * @param koko Tulostettavan logon koko laitteen pisteinä
+     * @return
+     */
+    QImage logo(const QSize& koko);
+
 private:
     LaskuModel *model_;
 
+    QImage logo_;
+    QSize logonKoko_;
+    int logonAvauskerta_ = -1;
+    qint64 logonAvain_ = 0;
+
+    mutable QString qrData_;
+    mutable QByteArray qrSvg_;
+
 };
 
 #endif // LASKUNTULOSTAJA_H
@@ -23,12 +23,21 @@
 
 #include "tuonti/csvtuonti.h"
 #include <QMimeData>
+#include <QTimer>
 #include <QDebug>
 
 LaskuRyhmaModel::LaskuRyhmaModel(QObject *parent)
     : QAbstractTableModel (parent)
 {
-    pohjaviite_ = kp()->asetukset()->isoluku("LaskuSeuraavaId") / 10;
+    // Tuonnissa rivit lisätään yksi kerrallaan, joten numerot varataan
+    // vasta kun kaikki rivit on lisätty
+    connect( this, &LaskuRyhmaModel::rowsInserted, [this] {
+        if( !varausTulossa_ )
+        {
+            varausTulossa_ = true;
+            QTimer::singleShot(0, this, &LaskuRyhmaModel::varaaViitteet);
+        }
+    });
 }
 
 int LaskuRyhmaModel::rowCount(const QModelIndex & /* parent */) const
@@ -67,8 +76,7 @@ QVariant LaskuRyhmaModel::data(const QModelIndex &index, int role) const
     {
         if( index.column() == VIITE)
         {
-            qulonglong pohjanumero =   pohjaviite_ + static_cast<qulonglong>( index.row() );
-            return pohjanumero * 10 + LaskuModel::laskeViiteTarkiste(pohjanumero);
+            return viite( index.row() );
         }
 
         Laskutettava laskutettava = ryhma_.at(index.row());
@@ -82,8 +90,7 @@ QVariant LaskuRyhmaModel::data(const QModelIndex &index, int role) const
 
     else if( role == ViiteRooli)
     {
-        qulonglong pohjanumero =   pohjaviite_ + static_cast<qulonglong>( index.row() );
-        return pohjanumero * 10 + LaskuModel::laskeViiteTarkiste(pohjanumero);
+        return viite( index.row() );
     }
     else if( role == NimiRooli)
         return ryhma_.at(index.row()).nimi;
@@ -114,6 +121,19 @@ QVariant LaskuRyhmaModel::data(const QModelIndex &index, int role) const
     return {};
 }
 
+void LaskuRyhmaModel::varaaViitteet()
+{
+    varausTulossa_ = false;
+
+    int ensimmainen = viitteet_.count();
+    int puuttuu = ryhma_.count() - ensimmainen;
+    if( puuttuu < 1)
+        return;
+
+    viitteet_.append( LaskuModel::varaaLaskunumerot(puuttuu) );
+    emit dataChanged( index(ensimmainen, VIITE), index(ryhma_.count() - 1, VIITE));
+}
+
 Qt::ItemFlags LaskuRyhmaModel::flags(const QModelIndex &index) const
 {
     return QAbstractItemModel::flags(index) | Qt::ItemIsDropEnabled;
@@ -141,6 +161,9 @@ void LaskuRyhmaModel::poista(int indeksi)
 {
     beginRemoveRows(QModelIndex(), indeksi, indeksi);
     ryhma_.removeAt(indeksi);
+    // Poistetun rivin numero jää käyttämättä, muiden numerot säilyvät
+    if( indeksi < viitteet_.count())
+        viitteet_.removeAt(indeksi);
     endRemoveRows();
 }
 
@@ -74,13 +74,27 @@ public:
     void sahkopostiLahetetty(int indeksiin);
     void finvoiceMuodostettu(int indeksiin);
 
+    /**
+     * @brief Varaa laskunumerot riveille, joilla sitä ei vielä ole
+     *
+     * Kutsutaan ryhmän muututtua, joten kerralla lisätyille riveille
+     * varataan numerot yhdellä kertaa
+     */
+    void varaaViitteet();
+
     bool canDropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex &parent) const override;
     bool dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column, const QModelIndex &parent) override;
 
 
 protected:
+    /**
+     * @brief Rivin laskunumero, 0 jos numeroa ei ole vielä varattu
+     */
+    qulonglong viite(int rivi) const { return viitteet_.value(rivi); }
+
     QList<Laskutettava> ryhma_;
-    qulonglong pohjaviite_ = 0;
+    QList<qulonglong> viitteet_;
+    bool varausTulossa_ = false;
 
 };
 
@@ -196,9 +196,15 @@ void LaskutModel::lataaAvoimet()
 
 void LaskutModel::paivita(int valinta, QDate mista, QDate mihin)
 {
-    QString kysely = QString("SELECT vienti.id, pvm, tili, debetsnt, kreditsnt, eraid, viite, erapvm, vienti.json, tosite, asiakas, laskupvm, kohdennus, tyyppi, selite "
+    QString kysely = QString("SELECT vienti.id, pvm, vienti.tili, debetsnt, kreditsnt, eraid, vienti.viite, vienti.erapvm, vienti.json, tosite, "
+                             "vienti.asiakas, laskupvm, kohdennus, tyyppi, selite, era.saldosnt AS erasaldo "
                              "FROM vienti LEFT OUTER JOIN tili ON vienti.tili=tili.id "
-                             "WHERE ((viite IS NOT NULL AND iban IS NULL) OR (tyyppi='AO' and vienti.id=vienti.eraid)) ");
+                             "LEFT OUTER JOIN era ON era.id=vienti.eraid "
+                             "WHERE ((vienti.viite IS NOT NULL AND iban IS NULL) OR (tyyppi='AO' and vienti.id=vienti.eraid)) ");
+
+    // Avoimet saldot ovat era-taulussa, joten maksetut rajataan pois jo kyselyssä
+    if( valinta == AVOIMET || valinta == ERAANTYNEET)
+        kysely.append(" AND era.saldosnt <> 0 AND vienti.erapvm IS NOT NULL ");
 
     if( mista.isValid() && mihin.isValid())
         kysely.append( QString(" AND pvm BETWEEN '%1' AND '%2' ") .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)) );
@@ -209,12 +215,12 @@ void LaskutModel::paivita(int valinta, QDate mista, QDate mihin)
 
     while( query.next())
     {
-        TaseEra era( query.value("eraid").toInt());
+        qlonglong eraSaldo = query.value("erasaldo").toLongLong();
         int vientiId = query.value("vienti.id").toInt();
 
-        if( valinta == AVOIMET && (!era.saldoSnt || !query.value("erapvm").toDate().isValid() ))
+        if( valinta == AVOIMET && (!eraSaldo || !query.value("erapvm").toDate().isValid() ))
             continue;
-        if( valinta == ERAANTYNEET && ( !era.saldoSnt || !query.value("erapvm").toDate().isValid() || query.value("erapvm").toDate() > kp()->paivamaara() ))
+        if( valinta == ERAANTYNEET && ( !eraSaldo || !query.value("erapvm").toDate().isValid() || query.value("erapvm").toDate() > kp()->paivamaara() ))
             continue;
 
         JsonKentta json( query.value("vienti.json").toByteArray() );
@@ -227,7 +233,7 @@ void LaskutModel::paivita(int valinta, QDate mista, QDate mihin)
         lasku.erapvm = query.value("erapvm").toDate();
         lasku.eraId = query.value("eraid").toInt();
         lasku.summaSnt = query.value("debetSnt").toInt() - query.value("kreditSnt").toInt();
-        lasku.avoinSnt = json.luku("Hyvityslasku") ? 0 : era.saldoSnt;        // Hyvityslaskuille avoinsnt näytetään nollaa
+        lasku.avoinSnt = json.luku("Hyvityslasku") ? 0 : eraSaldo;        // Hyvityslaskuille avoinsnt näytetään nollaa
         lasku.asiakas = query.value("asiakas").toString();
         if( lasku.asiakas.isEmpty())
             lasku.asiakas = query.value("selite").toString();
@@ -319,13 +325,13 @@ QString LaskutModel::bicIbanilla(const QString &iban)
 
 void AvoinLasku::haeLasku(int vientiid)
 {
-    QString kysely = QString("SELECT pvm, tili, debetsnt, kreditsnt, eraid, viite, erapvm, json, tosite, asiakas, laskupvm, kohdennus, selite "
-                             "FROM vienti WHERE id=%1").arg(vientiid);
+    QString kysely = QString("SELECT pvm, vienti.tili, debetsnt, kreditsnt, eraid, vienti.viite, vienti.erapvm, json, tosite, "
+                             "vienti.asiakas, laskupvm, kohdennus, selite, era.saldosnt AS erasaldo "
+                             "FROM vienti LEFT OUTER JOIN era ON era.id=vienti.eraid WHERE vienti.id=%1").arg(vientiid);
     QSqlQuery query( kysely );
 
     if( query.next())
     {
-        TaseEra era( query.value("eraid").toInt());
         json.fromJson( query.value("vienti.json").toByteArray() );
 
         vientiId = vientiid;
@@ -334,7 +340,7 @@ void AvoinLasku::haeLasku(int vientiid)
         eraId = query.value("eraid").toInt();
         erapvm = query.value("erapvm").toDate();
         summaSnt = query.value("debetSnt").toInt() - query.value("kreditSnt").toInt();
-        avoinSnt =  vientiId == eraId ? era.saldoSnt : 0; ;
+        avoinSnt =  vientiId == eraId ? query.value("erasaldo").toLongLong() : 0;
         asiakas = query.value("asiakas").toString();
         tosite = query.value("tosite").toInt();
         kirjausperuste = json.luku("Kirjausperuste");
@@ -19,6 +19,7 @@
 #include "ui_yhteystiedot.h"
 #include "validator/ytunnusvalidator.h"
 #include "db/jsonkentta.h"
+#include "db/kirjanpito.h"
 
 #include <QSqlQuery>
 
@@ -103,7 +104,9 @@ void YhteystietoWidget::tallenna()
         json.set("VerkkolaskuValittaja", verkkolaskuvalittaja_);
 
 
-    QSqlQuery kysely;
+    kp()->tietokanta()->transaction();
+
+    QSqlQuery kysely( *kp()->tietokanta() );
     kysely.prepare("INSERT INTO vienti (vientirivi, asiakas, json, luotu, muokattu) "
                    "VALUES (0, :asiakas, :json, :luotu, :muokattu)");
     kysely.bindValue(":asiakas", nimi_);
@@ -111,7 +114,19 @@ void YhteystietoWidget::tallenna()
     kysely.bindValue(":luotu", QDateTime::currentDateTime());
     kysely.bindValue(":muokattu", QDateTime::currentDateTime());
 
-    kysely.exec();
+    if( kysely.exec() )
+    {
+        kp()->muutokset()->kirjaa("vienti", kysely.lastInsertId().toInt());
+        if( kp()->tietokanta()->commit() )
+            kp()->muutokset()->vahvista();
+        else
+            kp()->muutokset()->peru();
+    }
+    else
+    {
+        kp()->lokiin(kysely);
+        kp()->tietokanta()->rollback();
+    }
 
     ui_->tallennaNappi->setEnabled(false);
     ui_->nimiEdit->setEnabled(false);
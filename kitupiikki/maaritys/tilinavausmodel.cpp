@@ -243,7 +243,16 @@ void TilinavausModel::lataa()
 bool TilinavausModel::tallenna()
 {
 
-    QSqlQuery kysely("delete from vienti where tosite=0");
+    kp()->tietokanta()->transaction();
+    QSqlQuery kysely;
+
+    // Muutoslokiin kirjataan sekä aiemmin että nyt avatut tilit
+    QList<int> muutosTilit;
+    kysely.exec("SELECT DISTINCT tili FROM vienti WHERE tosite=0");
+    while( kysely.next())
+        muutosTilit.append( kysely.value(0).toInt());
+
+    kysely.exec("delete from vienti where tosite=0");
 
     QDate avauspaiva = Kirjanpito::db()->asetukset()->pvm("TilinavausPvm");
 
@@ -272,8 +281,24 @@ bool TilinavausModel::tallenna()
             kysely.bindValue(":debet",QVariant());
             kysely.bindValue(":kredit", iter.value());
         }
-        kysely.exec();
+        if( !kysely.exec())
+        {
+            kp()->lokiin(kysely);
+            kp()->tietokanta()->rollback();
+            return false;
+        }
+        if( !muutosTilit.contains( tili.id()))
+            muutosTilit.append( tili.id());
+    }
+    kp()->muutokset()->kirjaa("vienti", 0, avauspaiva, avauspaiva, muutosTilit);
+    if( !kp()->tietokanta()->commit())
+    {
+        kp()->tietokanta()->rollback();
+        kp()->muutokset()->peru();
+        return false;
     }
+    kp()->muutokset()->vahvista();
+
     kp()->asetukset()->aseta("Tilinavaus",1);   // Tilit merkitään avatuiksi
 
     muokattu_ = false;
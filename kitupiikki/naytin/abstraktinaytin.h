@@ -18,6 +18,7 @@
 #define NAYTINWIDGET_H
 
 #include <QWidget>
+#include <QIODevice>
 
 class QPrinter;
 
@@ -48,6 +49,12 @@ public:
     virtual bool htmlMuoto() const { return false; }
     virtual QString html() const { return QString();}
 
+    // Tiedostoon kirjoittavat näyttimet voivat kirjoittaa suoraan laitteelle
+    // muodostamatta koko sisältöä ensin muistiin
+    virtual void kirjoita(QIODevice *laite) const { laite->write( data() ); }
+    virtual void kirjoitaCsv(QIODevice *laite) const { laite->write( csv() ); }
+    virtual void kirjoitaHtml(QIODevice *laite) const { laite->write( html().toUtf8() ); }
+
     void raidoita(bool raidat = false);
     bool onkoRaidat() const { return raidat_;}
     virtual bool voikoRaidoittaa() const { return false;}
@@ -158,7 +158,8 @@ void NaytinView::avaaOhjelmalla()
 
     QFile tiedosto( tiedostonnimi);
     tiedosto.open( QIODevice::WriteOnly);    
-    tiedosto.write( data());
+    if( naytin_ )
+        naytin_->kirjoita( &tiedosto );
     tiedosto.close();
 
     if( !QDesktopServices::openUrl( QUrl::fromLocalFile(tiedosto.fileName()) ))
@@ -179,7 +180,8 @@ void NaytinView::tallenna()
                                   tr("Tiedostoon %1 kirjoittaminen epäonnistui.").arg(polku));
             return;
         }
-        tiedosto.write( data() );
+        if( naytin_ )
+            naytin_->kirjoita( &tiedosto );
     }
 }
 
@@ -190,10 +192,8 @@ void NaytinView::avaaHtml()
     QFile tiedosto( tiedostonnimi);
     tiedosto.open( QIODevice::WriteOnly);
 
-    QTextStream out( &tiedosto);
-    out.setCodec("UTF-8");
-
-    out << html();
+    if( naytin_ )
+        naytin_->kirjoitaHtml( &tiedosto );
     tiedosto.close();
 
     Kirjanpito::avaaUrl(QUrl::fromLocalFile(tiedostonnimi));
@@ -223,10 +223,8 @@ void NaytinView::tallennaHtml()
                                   tr("Tiedostoon %1 kirjoittaminen epäonnistui.").arg(polku));
             return;
         }
-        QTextStream out( &tiedosto);
-        out.setCodec("UTF-8");
-
-        out << html();
+        if( naytin_ )
+            naytin_->kirjoitaHtml( &tiedosto );
         tiedosto.close();
     }
 }
@@ -298,7 +296,8 @@ void NaytinView::tallennaCsv()
                                   tr("Tiedostoon %1 kirjoittaminen epäonnistui.").arg(polku));
             return;
         }
-        tiedosto.write( csv() );
+        if( naytin_ )
+            naytin_->kirjoitaCsv( &tiedosto );
     }
 }
 
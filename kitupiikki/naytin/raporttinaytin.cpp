@@ -50,6 +50,21 @@ QString Naytin::RaporttiNaytin::html() const
     return raportti_.html();
 }
 
+void Naytin::RaporttiNaytin::kirjoita(QIODevice *laite) const
+{
+    raportti_.kirjoitaPdf(laite, onkoRaidat());
+}
+
+void Naytin::RaporttiNaytin::kirjoitaCsv(QIODevice *laite) const
+{
+    raportti_.kirjoitaCsv(laite);
+}
+
+void Naytin::RaporttiNaytin::kirjoitaHtml(QIODevice *laite) const
+{
+    raportti_.kirjoitaHtml(laite);
+}
+
 void Naytin::RaporttiNaytin::tulosta(QPrinter *printer) const
 {
     QPainter painter(printer);
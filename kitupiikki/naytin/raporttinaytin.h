@@ -38,6 +38,10 @@ public:
     virtual bool htmlMuoto() const override { return true; }
     virtual QString html() const override;
 
+    virtual void kirjoita(QIODevice *laite) const override;
+    virtual void kirjoitaCsv(QIODevice *laite) const override;
+    virtual void kirjoitaHtml(QIODevice *laite) const override;
+
     virtual bool voikoRaidoittaa() const override { return false;}
 
 public slots:
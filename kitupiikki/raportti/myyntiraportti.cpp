@@ -21,8 +21,6 @@
 #include "db/kirjanpito.h"
 
 #include <QSqlQuery>
-#include <QMap>
-#include <QJsonDocument>
 #include <QVariant>
 
 
@@ -70,49 +68,26 @@ RaportinKirjoittaja MyyntiRaportti::kirjoitaRaportti(QDate mista, QDate mihin, b
         rk.lisaaOtsake(otsikko);
     }
 
-    QMap<QString,double> myyntiKpl;
-    QMap<QString,qlonglong> myyntiSnt;
-    QMap<QString,qlonglong> bruttoSnt;
-
+    // Laskurivit on purettu laskurivi-tauluun, joten myynti saadaan
+    // suoraan nimikkeittäin koostettuna
     QSqlQuery kysely;
-    kysely.exec(QString("SELECT json from vienti where viite is not null and pvm between '%1' and '%2'")
+    kysely.exec(QString("SELECT nimike, SUM(maara), SUM(nettosnt), SUM(bruttosnt) "
+                        "FROM laskurivi, vienti WHERE laskurivi.vienti=vienti.id "
+                        "AND vienti.viite IS NOT NULL AND vienti.pvm BETWEEN '%1' AND '%2' "
+                        "GROUP BY nimike ORDER BY nimike")
                 .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)));
 
-    while( kysely.next())
-    {
-        QJsonDocument json = QJsonDocument::fromJson( kysely.value(0).toByteArray() );
-        QVariantMap vmap = json.toVariant().toMap();
-        if( vmap.contains("Laskurivit"))
-        {
-            for( const QVariant& var : vmap.value("Laskurivit").toList())
-            {
-                QString nimike = var.toMap().value("Nimike").toString();
-
-                double maara = var.toMap().value("Maara").toDouble();
-                qlonglong sentit = var.toMap().value("Nettoyht").toLongLong();
-                qlonglong brutto = var.toMap().value("Yhteensa").toLongLong();
-
-                myyntiKpl[nimike] = myyntiKpl.value(nimike,0.0) + maara;
-                myyntiSnt[nimike] = myyntiSnt.value(nimike, 0) + sentit;
-                bruttoSnt[nimike] = bruttoSnt.value(nimike, 0) + brutto;
-            }
-        }
-    }
-
     qlonglong nettoSumma = 0;
     qlonglong bruttoSumma = 0;
 
-    QMapIterator<QString,double> iter(myyntiKpl);
-    while( iter.hasNext() )
+    while( kysely.next() )
     {
-        iter.next();
-
         RaporttiRivi rivi;
-        rivi.lisaa( iter.key());
+        rivi.lisaa( kysely.value(0).toString());
 
-        double kpl = iter.value();
-        qlonglong snt = myyntiSnt.value(iter.key());
-        qlonglong brutto = bruttoSnt.value(iter.key());
+        double kpl = kysely.value(1).toDouble();
+        qlonglong snt = kysely.value(2).toLongLong();
+        qlonglong brutto = kysely.value(3).toLongLong();
 
         rivi.lisaa( QString("%L1").arg(kpl,0,'f',2), 1, true );
         rivi.lisaa( snt / kpl);
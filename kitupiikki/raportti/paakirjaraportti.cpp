@@ -60,6 +60,13 @@ PaakirjaRaportti::PaakirjaRaportti()
 }
 
 RaportinKirjoittaja PaakirjaRaportti::raportti()
+{
+    RaportinKirjoittaja rk;
+    kirjoita(rk);
+    return rk;
+}
+
+void PaakirjaRaportti::kirjoita(RaporttiKohde &kohde)
 {
     int kohdennuksella = -1;
     if( ui->kohdennusCheck->isChecked())
@@ -68,16 +75,21 @@ RaportinKirjoittaja PaakirjaRaportti::raportti()
     if( ui->tiliBox->isChecked())
         tililta = ui->tiliCombo->currentData().toInt();
 
-    return kirjoitaRaportti(ui->alkupvm->date(), ui->loppupvm->date(), kohdennuksella,
-                            ui->tulostakohdennuksetCheck->isChecked(),
-                            ui->tulostasummat->isChecked(),
-                            tililta);
+    kirjoitaRaportti(kohde, ui->alkupvm->date(), ui->loppupvm->date(), kohdennuksella,
+                     ui->tulostakohdennuksetCheck->isChecked(),
+                     ui->tulostasummat->isChecked(),
+                     tililta);
 }
 
 RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin, int kohdennuksella, bool tulostakohdennus, bool tulostaSummarivi, int tililta)
 {
     RaportinKirjoittaja rk;
+    kirjoitaRaportti(rk, mista, mihin, kohdennuksella, tulostakohdennus, tulostaSummarivi, tililta);
+    return rk;
+}
 
+void PaakirjaRaportti::kirjoitaRaportti(RaporttiKohde &rk, QDate mista, QDate mihin, int kohdennuksella, bool tulostakohdennus, bool tulostaSummarivi, int tililta)
+{
     Kohdennus kohdennus = kp()->kohdennukset()->kohdennus(kohdennuksella);
 
     if( kohdennuksella > -1 )
@@ -205,40 +217,58 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
     }
 
 
-    // Varmistetaan, että kaikilla tämän tilikauden tileillä on tietue
+    // Sitten päästäänkin tulostamaan pääkirjaa. Kaikki kauden viennit haetaan yhdellä
+    // tilin ja päivämäärän mukaan järjestetyllä kyselyllä, ja tilin vaihtuminen
+    // havaitaan kyselyä läpikäydessä.
+
+    QString ehto = QString("pvm BETWEEN \"%1\" AND \"%2\"")
+            .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate));
+    QString taulut = "vienti, tosite, tili, tositelaji, kohdennus";
+
     if( kohdennuksella > -1 && kohdennus.tyyppi() == Kohdennus::MERKKAUS)
-        kysymys = QString("SELECT ysiluku FROM merkkaus,vienti, tili WHERE "
-                          "merkkaus.kohdennus=%3 AND merkkaus.vienti=vienti.id AND vienti.tili = tili.id AND "
-                          "pvm BETWEEN \"%1\" AND \"%2\" GROUP BY nro")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
+    {
+        taulut.append(", merkkaus");
+        ehto.append( QString(" AND merkkaus.kohdennus=%1 AND merkkaus.vienti=vienti.id").arg(kohdennuksella));
+    }
     else if( kohdennuksella > -1)
-        kysymys = QString("SELECT ysiluku FROM vienti, tili WHERE vienti.tili = tili.id AND "
-                          "pvm BETWEEN \"%1\" AND \"%2\" AND vienti.kohdennus=%3 GROUP BY nro")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
-    else
-        kysymys = QString("SELECT ysiluku FROM vienti, tili WHERE vienti.tili = tili.id AND "
-                      "pvm BETWEEN \"%1\" AND \"%2\" GROUP BY nro")
-                .arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate));
+        ehto.append( QString(" AND vienti.kohdennus=%1").arg(kohdennuksella));
+
+    if( tililta )
+        ehto.append( QString(" AND tili.nro=%1").arg(tililta));
 
+    kysymys = QString("SELECT tili.ysiluku, vienti.pvm, tositelaji.tunnus, tosite.tunniste, vienti.kohdennus, tosite.id, "
+                      "kohdennus.nimi, vienti.selite, vienti.debetsnt, vienti.kreditsnt FROM %1 "
+                      "WHERE vienti.tosite=tosite.id AND vienti.tili=tili.id AND tosite.laji=tositelaji.id AND "
+                      "vienti.kohdennus=kohdennus.id AND %2 "
+                      "ORDER BY tili.ysiluku, vienti.pvm, vienti.id").arg(taulut).arg(ehto);
+
+    kysely.setForwardOnly(true);
     kysely.exec(kysymys);
-    while( kysely.next() )
-    {
-        if( !alkusaldot.contains( kysely.value(0).toInt()))
-            alkusaldot.insert(kysely.value(0).toInt(), 0);
-    }
+    bool vienteja = kysely.next();
 
-    // Sitten päästäänkin tulostamaan pääkirjaa
     QMapIterator<int,qlonglong> iter( alkusaldot );
 
     qlonglong kokoDebetYht = 0;
     qlonglong kokoKreditYht = 0;
 
+    // Vientien kausitunnus haetaan uudelleen vain tilikauden vaihtuessa
+    Tilikausi vientikausi;
 
-    while(iter.hasNext())
+    while( vienteja || iter.hasNext() )
     {
-        iter.next();
+        // Seuraavaksi tulostetaan pienin tileistä, joilla on alkusaldo tai vientejä
+        int ysiluku = 0;
+        qlonglong saldo = 0;
+        if( iter.hasNext() && ( !vienteja || iter.peekNext().key() <= kysely.value(0).toInt() ))
+        {
+            iter.next();
+            ysiluku = iter.key();
+            saldo = iter.value();
+        }
+        else
+            ysiluku = kysely.value(0).toInt();
 
-        const Tili& tili = kp()->tilit()->tiliYsiluvulla( iter.key() );            
+        const Tili& tili = kp()->tilit()->tiliYsiluvulla( ysiluku );
 
         if( tililta && tili.numero() != tililta)
             continue;
@@ -248,59 +278,39 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
 
         RaporttiRivi tiliotsikko;
         tiliotsikko.lisaaLinkilla( RaporttiRiviSarake::TILI_LINKKI, tili.numero(),  QString("%1 %2").arg(tili.numero()).arg( tili.nimi()) , 5 + (int) tulostakohdennus );
-        tiliotsikko.lisaa( iter.value());
+        tiliotsikko.lisaa( saldo );
         tiliotsikko.lihavoi();
         rk.lisaaRivi( tiliotsikko);
 
-        qlonglong saldo = iter.value();
-        QString kysymys;
-
-        if( kohdennuksella > -1 && kohdennus.tyyppi() == Kohdennus::MERKKAUS)
-            kysymys = QString("SELECT pvm, tositelaji, tunniste, kohdennusId, tositeId, "
-                                      "vientivw.kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM merkkaus, vientivw "
-                                      "WHERE merkkaus.kohdennus=%4 AND merkkaus.vienti=vientiId AND tilinro=%1 AND pvm BETWEEN \"%2\" AND \"%3\" "
-                                      "ORDER BY pvm, vientiId ")
-                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
-        else if( kohdennuksella > -1)
-            kysymys = QString("SELECT pvm, tositelaji, tunniste, kohdennusId, tositeId, "
-                                      "kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM vientivw "
-                                      "WHERE tilinro=%1 AND pvm BETWEEN \"%2\" AND \"%3\" AND kohdennusId=%4 "
-                                      "ORDER BY pvm, vientiId ")
-                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate)).arg(kohdennuksella);
-        else
-            kysymys = QString("SELECT pvm, tositelaji, tunniste, kohdennusId, tositeId, "
-                                      "kohdennus as kohdennusnimi, selite, debetsnt, kreditsnt FROM vientivw "
-                                      "WHERE tilinro=%1 AND pvm BETWEEN \"%2\" AND \"%3\" "
-                                      "ORDER BY pvm, vientiId ")
-                    .arg(tili.numero()).arg(mista.toString(Qt::ISODate)).arg(mihin.toString(Qt::ISODate));
+        bool vastaavaa = tili.onko(TiliLaji::VASTAAVAA);
 
-
-        kysely.exec(kysymys);
-
-        while(kysely.next())
+        for( ; vienteja && kysely.value(0).toInt() == ysiluku; vienteja = kysely.next())
         {
-            qlonglong debet = kysely.value("debetsnt").toLongLong();
-            qlonglong kredit = kysely.value("kreditsnt").toLongLong();
+            qlonglong debet = kysely.value(8).toLongLong();
+            qlonglong kredit = kysely.value(9).toLongLong();
 
             debetYht += debet;
             kreditYht += kredit;
 
-            if( tili.onko(TiliLaji::VASTAAVAA) )
+            if( vastaavaa )
                 saldo += debet - kredit;
             else
                 saldo += kredit - debet;
 
             RaporttiRivi rr;
-            QDate pvm = kysely.value("pvm").toDate();
+            QDate pvm = kysely.value(1).toDate();
+            if( pvm < vientikausi.alkaa() || pvm > vientikausi.paattyy() )
+                vientikausi = kp()->tilikaudet()->tilikausiPaivalle(pvm);
+
             rr.lisaa( pvm );
-            rr.lisaaLinkilla( RaporttiRiviSarake::TOSITE_ID, kysely.value("tositeId").toInt() ,
-                              QString("%1%2/%3").arg(kysely.value("tositelaji").toString()).arg(kysely.value("tunniste").toInt())
-                              .arg( kp()->tilikaudet()->tilikausiPaivalle(pvm).kausitunnus() ));
-            rr.lisaa( kysely.value("selite").toString());
+            rr.lisaaLinkilla( RaporttiRiviSarake::TOSITE_ID, kysely.value(5).toInt() ,
+                              QString("%1%2/%3").arg(kysely.value(2).toString()).arg(kysely.value(3).toInt())
+                              .arg( vientikausi.kausitunnus() ));
+            rr.lisaa( kysely.value(7).toString());
             if( tulostakohdennus)
             {
-                if( kysely.value("kohdennusId").toInt())
-                    rr.lisaa( kysely.value("kohdennusnimi").toString());
+                if( kysely.value(4).toInt())
+                    rr.lisaa( kysely.value(6).toString());
                 else
                     rr.lisaa("");   // Ei kohdenneta-tekstiä ei tulosteta
             }
@@ -348,9 +358,6 @@ RaportinKirjoittaja PaakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin,
         summarivi.viivaYlle();
         rk.lisaaRivi(summarivi);
     }
-
-    return rk;
-
 }
 
 void PaakirjaRaportti::haeTilitComboon()
@@ -31,11 +31,19 @@ public:
     PaakirjaRaportti();
 
     RaportinKirjoittaja raportti();
+    void kirjoita(RaporttiKohde& kohde) override;
 
     static RaportinKirjoittaja kirjoitaRaportti( QDate mista, QDate mihin, int kohdennuksella = -1,
                                                  bool tulostakohdennus = false,
                                                  bool tulostaSummarivi = true,
                                                  int tililta = 0);
+    /**
+     * @brief Kirjoittaa pääkirjan kohteeseen rivi kerrallaan
+     */
+    static void kirjoitaRaportti( RaporttiKohde& rk, QDate mista, QDate mihin, int kohdennuksella = -1,
+                                  bool tulostakohdennus = false,
+                                  bool tulostaSummarivi = true,
+                                  int tililta = 0);
 public slots:
     void haeTilitComboon();
 protected:
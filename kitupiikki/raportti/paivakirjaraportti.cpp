@@ -67,22 +67,34 @@ PaivakirjaRaportti::~PaivakirjaRaportti()
 
 
 RaportinKirjoittaja PaivakirjaRaportti::raportti()
+{
+    RaportinKirjoittaja kirjoittaja;
+    kirjoita( kirjoittaja );
+    return kirjoittaja;
+}
+
+void PaivakirjaRaportti::kirjoita(RaporttiKohde &kohde)
 {
     int kohdennuksella = -1;
     if( ui->kohdennusCheck->isChecked())
         kohdennuksella = ui->kohdennusCombo->currentData( KohdennusModel::IdRooli).toInt();
 
-    return kirjoitaRaportti( ui->alkupvm->date(), ui->loppupvm->date(),
-                             kohdennuksella, ui->tositejarjestysRadio->isChecked(),
-                             ui->ryhmittelelajeittainCheck->isChecked(), ui->tulostakohdennuksetCheck->isChecked(),
-                             ui->tulostasummat->isChecked());
-
+    kirjoitaRaportti( kohde, ui->alkupvm->date(), ui->loppupvm->date(),
+                      kohdennuksella, ui->tositejarjestysRadio->isChecked(),
+                      ui->ryhmittelelajeittainCheck->isChecked(), ui->tulostakohdennuksetCheck->isChecked(),
+                      ui->tulostasummat->isChecked());
 }
 
 RaportinKirjoittaja PaivakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihin, int kohdennuksella, bool tositejarjestys, bool ryhmitalajeittain, bool tulostakohdennukset, bool tulostasummat)
 {
-
     RaportinKirjoittaja kirjoittaja;
+    kirjoitaRaportti( kirjoittaja, mista, mihin, kohdennuksella, tositejarjestys, ryhmitalajeittain,
+                      tulostakohdennukset, tulostasummat);
+    return kirjoittaja;
+}
+
+void PaivakirjaRaportti::kirjoitaRaportti(RaporttiKohde &kirjoittaja, QDate mista, QDate mihin, int kohdennuksella, bool tositejarjestys, bool ryhmitalajeittain, bool tulostakohdennukset, bool tulostasummat)
+{
 
     if( kohdennuksella > -1 )
         // Tulostetaan vain yhdestä kohdennuksesta
@@ -287,12 +299,10 @@ RaportinKirjoittaja PaivakirjaRaportti::kirjoitaRaportti(QDate mista, QDate mihi
 
     if( kirjoittaja.tyhja())
         kirjoittaja.lisaaRivi();
-
-    return kirjoittaja;
 }
 
 
-void PaivakirjaRaportti::kirjoitaSummaRivi(RaportinKirjoittaja &rk, qlonglong debet, qlonglong kredit, int sarakeleveys)
+void PaivakirjaRaportti::kirjoitaSummaRivi(RaporttiKohde &rk, qlonglong debet, qlonglong kredit, int sarakeleveys)
 {
     RaporttiRivi rivi(RaporttiRivi::EICSV);
     rivi.lisaa("Yhteensä", sarakeleveys );
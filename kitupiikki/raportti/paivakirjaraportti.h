@@ -34,6 +34,7 @@ public:
     ~PaivakirjaRaportti();
 
     RaportinKirjoittaja raportti();
+    void kirjoita(RaporttiKohde& kohde) override;
 
 
     /**
@@ -52,9 +53,16 @@ public:
                                  int kohdennuksella = -1, bool tositejarjestys = false,
                                  bool ryhmitalajeittain = false, bool tulostakohdennukset = false,
                                  bool tulostasummat = false);
+    /**
+     * @brief Kirjoittaa päiväkirjan kohteeseen rivi kerrallaan
+     */
+    static void kirjoitaRaportti( RaporttiKohde& kirjoittaja, QDate mista, QDate mihin,
+                                 int kohdennuksella = -1, bool tositejarjestys = false,
+                                 bool ryhmitalajeittain = false, bool tulostakohdennukset = false,
+                                 bool tulostasummat = false);
 
 protected:
-    static void kirjoitaSummaRivi(RaportinKirjoittaja &rk, qlonglong debet, qlonglong kredit, int sarakeleveys);
+    static void kirjoitaSummaRivi(RaporttiKohde &rk, qlonglong debet, qlonglong kredit, int sarakeleveys);
 
     Ui::Paivakirja *ui;
 };
@@ -23,8 +23,10 @@
 #include <QSettings>
 #include <QApplication>
 #include "raportinkirjoittaja.h"
+#include "raporttivirta.h"
 
 #include <QPdfWriter>
+#include <QBuffer>
 
 #include "db/kirjanpito.h"
 
@@ -48,6 +50,7 @@ void RaportinKirjoittaja::asetaKausiteksti(const QString &kausiteksti)
 
 void RaportinKirjoittaja::lisaaSarake(const QString &leveysteksti, RaporttiRivi::RivinKaytto kaytto)
 {
+    asettelu_ = Asettelu();
     RaporttiSarake uusi;
     uusi.leveysteksti = leveysteksti;
     uusi.sarakkeenKaytto = kaytto;
@@ -56,6 +59,7 @@ void RaportinKirjoittaja::lisaaSarake(const QString &leveysteksti, RaporttiRivi:
 
 void RaportinKirjoittaja::lisaaSarake(int leveysprosentti)
 {
+    asettelu_ = Asettelu();
     RaporttiSarake uusi;
     uusi.leveysprossa = leveysprosentti;
     sarakkeet_.append(uusi);
@@ -63,21 +67,12 @@ void RaportinKirjoittaja::lisaaSarake(int leveysprosentti)
 
 void RaportinKirjoittaja::lisaaVenyvaSarake(int tekija)
 {
+    asettelu_ = Asettelu();
     RaporttiSarake uusi;
     uusi.jakotekija = tekija;
     sarakkeet_.append(uusi);
 }
 
-void RaportinKirjoittaja::lisaaEurosarake()
-{
-    lisaaSarake("-9 999 999,99€XX");
-}
-
-void RaportinKirjoittaja::lisaaPvmSarake()
-{
-    lisaaSarake("99.99.9999XX");
-}
-
 void RaportinKirjoittaja::lisaaOtsake(const RaporttiRivi& otsikkorivi)
 {
     otsakkeet_.append(otsikkorivi);
@@ -100,21 +95,65 @@ int RaportinKirjoittaja::tulosta(QPagedPaintDevice *printer, QPainter *painter,
     if( rivit_.isEmpty())
         return 0;     // Ei tulostettavaa !
 
+    Sivuttaja sivuttaja(*this, printer, painter, raidoita, alkusivunumero);
+
+    // Rivien mitat lasketaan vain kerran kullekin sivukoolle
+    const Asettelu& asettelu = asettele(painter, sivuttaja.pienennys());
 
-    int pienennys = sarakkeet_.count() > 4 && printer->pageSizeMM().width() < 300 ? 2 : 0;
+    for( int r=0; r < rivit_.count(); r++)
+        sivuttaja.tulosta( rivit_.at(r), asettelu.rivit.at(r));
+
+    return sivuttaja.lopeta();
+}
+
+const RaportinKirjoittaja::Asettelu &RaportinKirjoittaja::asettele(QPainter *painter, int pienennys) const
+{
+    QSize koko = painter->window().size();
+    int dpi = painter->device()->logicalDpiY();
+
+    if( asettelu_.koko == koko && asettelu_.dpi == dpi && asettelu_.pienennys == pienennys &&
+        asettelu_.rivit.count() == rivit_.count() )
+        return asettelu_;
+
+    Asettelu asettelu;
+    asettelu.koko = koko;
+    asettelu.dpi = dpi;
+    asettelu.pienennys = pienennys;
+
+    painter->save();
 
     QFont fontti("FreeSans", 10 - pienennys );
     painter->setFont(fontti);
 
     int rivinkorkeus = painter->fontMetrics().height();
+
+    asettelu.leveydet = sarakeleveydet(painter, asettelu.jaljella);
+    asettelu.rivit.resize( rivit_.count() );
+
+    for( int r=0; r < rivit_.count(); r++)
+    {
+        const RaporttiRivi& rivi = rivit_.at(r);
+        if( rivi.kaytto() == RaporttiRivi::CSV)
+            continue;
+
+        asettelu.rivit[r] = asetteleRivi(painter, asettelu.leveydet, rivi, pienennys, rivinkorkeus);
+    }
+
+    painter->restore();
+
+    asettelu_ = asettelu;
+    return asettelu_;
+}
+
+QVector<int> RaportinKirjoittaja::sarakeleveydet(QPainter *painter, int &jaljella) const
+{
     int sivunleveys = painter->window().width();
-    int sivunkorkeus = painter->window().height();
 
     // Lasketaan sarakkeiden leveydet
     QVector<int> leveydet( sarakkeet_.count() );
 
     int tekijayhteensa = 0; // Lasketaan jäävän tilan jako
-    int jaljella = sivunleveys;
+    jaljella = sivunleveys;
 
     for( int i=0; i < sarakkeet_.count(); i++)
     {
@@ -144,278 +183,248 @@ int RaportinKirjoittaja::tulosta(QPagedPaintDevice *printer, QPainter *painter,
     if( tekijayhteensa )
         jaljella = 0;   // Koko tila käytetty venyvällä sarakkeella
 
-    // Nyt taulukosta löytyy sarakkeiden leveydet, ja tulostaminen
-    // voidaan aloittaa
+    return leveydet;
+}
 
-    int sivu = 1;
-    int rivilla = 0;
+RaportinKirjoittaja::RivinAsettelu RaportinKirjoittaja::asetteleRivi(QPainter *painter, const QVector<int> &leveydet,
+                                                                     const RaporttiRivi &rivi, int pienennys, int rivinkorkeus)
+{
+    QFont fontti("FreeSans", rivi.pistekoko() - pienennys );
+    fontti.setBold( rivi.onkoLihava() );
+    painter->setFont(fontti);
 
-    foreach (RaporttiRivi rivi, rivit_)
-    {
-        if( rivi.kaytto() == RaporttiRivi::CSV)
-            continue;
+    int sivunkorkeus = painter->window().height();
 
-        fontti.setPointSize( rivi.pistekoko() - pienennys );
-        fontti.setBold( rivi.onkoLihava() );
-        painter->setFont(fontti);
+    // Lasketaan sarakkeiden rectit
+    // ja samalla lasketaan taulukkoon liput
 
-        // Lasketaan ensin sarakkeiden rectit
-        // ja samalla lasketaan taulukkoon liput
+    RivinAsettelu rivinAsettelu;
+    rivinAsettelu.laatikot.resize( rivi.sarakkeita() );
+    rivinAsettelu.liput.resize( rivi.sarakkeita() );
+    rivinAsettelu.tekstit.resize( rivi.sarakkeita() );
 
-        QVector<QRect> laatikot( rivi.sarakkeita() );
-        QVector<int> liput( rivi.sarakkeita() );
-        QVector<QString> tekstit( rivi.sarakkeita() );
+    int korkeinrivi = rivinkorkeus;
+    int x = 0;  // Missä kohtaa ollaan leveyssuunnassa
+    int sarake = 0; // Missä taulukon sarakkeessa ollaan menossa
 
-        int korkeinrivi = rivinkorkeus;
-        int x = 0;  // Missä kohtaa ollaan leveyssuunnassa
-        int sarake = 0; // Missä taulukon sarakkeessa ollaan menossa
+    for(int i=0; i < rivi.sarakkeita(); i++)
+    {
 
-        for(int i=0; i < rivi.sarakkeita(); i++)
+        int sarakeleveys = 0;
+        // ysind (Yhdistettyjen Sarakkeiden Indeksi) kelaa ne sarakkeet läpi,
+        // jotka tällä riville yhdistetty toisiinsa
+        for( int ysind = 0; ysind < rivi.leveysSaraketta(i); ysind++ )
         {
+            sarakeleveys += leveydet.value(sarake);
+            sarake++;
+        }
 
-            int sarakeleveys = 0;
-            // ysind (Yhdistettyjen Sarakkeiden Indeksi) kelaa ne sarakkeet läpi,
-            // jotka tällä riville yhdistetty toisiinsa
-            for( int ysind = 0; ysind < rivi.leveysSaraketta(i); ysind++ )
-            {
-                sarakeleveys += leveydet.at(sarake);
-                sarake++;
-            }
+        // Nyt saatu tämän sarakkeen leveys
 
-            // Nyt saatu tämän sarakkeen leveys
+        int lippu = Qt::TextWordWrap;
+        QString teksti = rivi.teksti(i);
+        if( rivi.tasattuOikealle(i))
+        {
+            lippu |= Qt::AlignRight;
+            teksti.append("  ");
+            // Ei tasata ihan oikealle vaan välilyönnin päähän
+        }
+        rivinAsettelu.tekstit[i] = teksti;
 
-            int lippu = Qt::TextWordWrap;
-            QString teksti = rivi.teksti(i);
-            if( rivi.tasattuOikealle(i))
-            {
-                lippu |= Qt::AlignRight;
-                teksti.append("  ");
-                // Ei tasata ihan oikealle vaan välilyönnin päähän
-            }
-            tekstit[i] = teksti;
+        rivinAsettelu.liput[i] = lippu;
+        // Laatikoita ei asemoida korkeussuunnassa, vaan translatella liikutaan
+        rivinAsettelu.laatikot[i] = painter->boundingRect( x, 0,
+                                            sarakeleveys, sivunkorkeus,
+                                            lippu, teksti );
 
-            liput[i] = lippu;
-            // Laatikoita ei asemoida korkeussuunnassa, vaan translatella liikutaan
-            laatikot[i] = painter->boundingRect( x, 0,
-                                                sarakeleveys, sivunkorkeus,
-                                                lippu, teksti );
+        x += sarakeleveys;
+        if( rivinAsettelu.laatikot[i].height() > korkeinrivi )
+            korkeinrivi = rivinAsettelu.laatikot[i].height();
+    }
+    rivinAsettelu.korkeus = korkeinrivi;
+    return rivinAsettelu;
+}
 
-            x += sarakeleveys;
-            if( laatikot[i].height() > korkeinrivi )
-                korkeinrivi = laatikot[i].height();
-        }
+RaportinKirjoittaja::Sivuttaja::Sivuttaja(const RaportinKirjoittaja &raportti, QPagedPaintDevice *printer, QPainter *painter,
+                                          bool raidoita, int alkusivunumero)
+    : raportti_(raportti), printer_(printer), painter_(painter),
+      raidoita_(raidoita), alkusivunumero_(alkusivunumero)
+{
+    pienennys_ = raportti.sarakkeet_.count() > 4 && printer->pageSizeMM().width() < 300 ? 2 : 0;
 
-        if( painter->transform().dy() > sivunkorkeus - korkeinrivi)
-        {
-            // Sivu tulee täyteen
-            printer->newPage();
-            sivu++;
-            rivilla = 0;
-            painter->restore();
-        }
+    fontti_ = QFont("FreeSans", 10 - pienennys_ );
+    painter->setFont(fontti_);
 
-        if( painter->transform().dy() < 0.1 )
-        {
-            // Ollaan sivun alussa
+    rivinkorkeus_ = painter->fontMetrics().height();
+    sivunleveys_ = painter->window().width();
+    sivunkorkeus_ = painter->window().height();
 
-            painter->save();
-            painter->setFont(QFont("FreeSans", 10 - pienennys));
+    leveydet_ = raportti.sarakeleveydet(painter, jaljella_);
+}
 
-            // Tulostetaan ylätunniste
-            if( !otsikko_.isEmpty())
-                tulostaYlatunniste( painter, sivu + alkusivunumero - 1);
+void RaportinKirjoittaja::Sivuttaja::tulosta(const RaporttiRivi &rivi)
+{
+    if( rivi.kaytto() == RaporttiRivi::CSV)
+        return;
 
-            if( !otsakkeet_.isEmpty())
-                painter->translate(0, rivinkorkeus);
+    painter_->save();
+    RivinAsettelu asettelu = asetteleRivi(painter_, leveydet_, rivi, pienennys_, rivinkorkeus_);
+    painter_->restore();
 
-            // Otsikkorivit
-            foreach (RaporttiRivi otsikkorivi, otsakkeet_)
-            {
-                if( otsikkorivi.kaytto() == RaporttiRivi::CSV)
-                    continue;
-
-                x = 0;
-                sarake = 0;
-
-                for( int i = 0; i < otsikkorivi.sarakkeita(); i++)
-                {
-
-                    int lippu = 0;
-                    QString teksti = otsikkorivi.teksti(i);
-
-                    if( otsikkorivi.tasattuOikealle(i))
-                    {
-                        lippu = Qt::AlignRight;
-                        teksti.append("  ");
-                    }
-                    int sarakeleveys = 0;
-
-                    for( int ysind = 0; ysind < otsikkorivi.leveysSaraketta(i); ysind++ )
-                    {
-                        sarakeleveys += leveydet[sarake];
-                        sarake++;
-                    }
-                    painter->drawText( QRect(x,0,sarakeleveys,rivinkorkeus),
-                                      lippu, teksti );
-
-                    x += sarakeleveys;
-                }
-                painter->translate(0, rivinkorkeus);
-            } // Otsikkorivi
-            if( !otsikko_.isEmpty() || !otsakkeet_.isEmpty())
-                painter->drawLine(0,0,sivunleveys,0);
-        }
+    tulosta(rivi, asettelu);
+}
 
-        // Jos raidoitus, niin raidoitetaan eli osan rivien taakse harmaata
-        if( raidoita && rivilla % 6 > 2)
-        {
-            painter->save();
-            painter->setBrush(QBrush(QColor(222,222,222)));
-            painter->setPen(Qt::NoPen);
+void RaportinKirjoittaja::Sivuttaja::tulosta(const RaporttiRivi &rivi, const RivinAsettelu &asettelu)
+{
+    if( rivi.kaytto() == RaporttiRivi::CSV)
+        return;
 
-            painter->drawRect(0,0,sivunleveys, korkeinrivi);
+    int korkeinrivi = asettelu.korkeus;
 
-            painter->restore();
+    if( painter_->transform().dy() > sivunkorkeus_ - korkeinrivi)
+    {
+        // Sivu tulee täyteen
+        printer_->newPage();
+        sivu_++;
+        rivilla_ = 0;
+        painter_->restore();
+    }
 
-        }
+    if( painter_->transform().dy() < 0.1 )
+        aloitaSivu();
 
-        fontti.setPointSize( rivi.pistekoko() - pienennys );
-        fontti.setBold( rivi.onkoLihava() );
-        painter->setFont(fontti);
+    tulostettu_ = true;
 
-        // Sitten tulostetaan tämä varsinainen rivi
-        for( int i=0; i < rivi.sarakkeita(); i++)
-        {
-            painter->drawText( laatikot[i], liput[i] , tekstit[i] );
-        }
-        if( rivi.onkoViivaa())  // Viivan tulostaminen rivin ylle
-        {
-            painter->drawLine(0,0, sivunleveys - jaljella , 0);
-        }
+    // Jos raidoitus, niin raidoitetaan eli osan rivien taakse harmaata
+    if( raidoita_ && rivilla_ % 6 > 2)
+    {
+        painter_->save();
+        painter_->setBrush(QBrush(QColor(222,222,222)));
+        painter_->setPen(Qt::NoPen);
+
+        painter_->drawRect(0,0,sivunleveys_, korkeinrivi);
+
+        painter_->restore();
 
-        painter->translate(0, korkeinrivi);
-        rivilla++;
     }
 
-    painter->restore();
+    fontti_.setPointSize( rivi.pistekoko() - pienennys_ );
+    fontti_.setBold( rivi.onkoLihava() );
+    painter_->setFont(fontti_);
 
-    return sivu;
+    // Sitten tulostetaan tämä varsinainen rivi
+    for( int i=0; i < rivi.sarakkeita(); i++)
+    {
+        painter_->drawText( asettelu.laatikot.at(i), asettelu.liput.at(i) , asettelu.tekstit.at(i) );
+    }
+    if( rivi.onkoViivaa())  // Viivan tulostaminen rivin ylle
+    {
+        painter_->drawLine(0,0, sivunleveys_ - jaljella_ , 0);
+    }
+
+    painter_->translate(0, korkeinrivi);
+    rivilla_++;
 }
 
-QString RaportinKirjoittaja::html(bool linkit) const
+int RaportinKirjoittaja::Sivuttaja::lopeta()
 {
-    QString txt;
-
-    txt.append("<html><meta charset=\"utf-8\"><title>");
-    txt.append( otsikko() );
-    txt.append("</title>"
-               "<style>"
-               " body { font-family: Helvetica; }"
-               " h1 { font-weight: normal; }"
-               " .lihava { font-weight: bold; } "
-               " tr.viiva td { border-top: 1px solid black; }"
-               " td.oikealle { text-align: right; } "
-               " th { text-align: left; color: darkgray;}"
-               " a { text-decoration: none; color: black; }"
-               " td { padding-right: 2em; }"
-               " td:last-of-type { padding-right: 0; }"
-               " table { border-collapse: collapse;}"
-               " p.tulostettu { margin-top:2em; color: darkgray; }"
-               " span.treeni { color: green; }"
-               "</style>"
-               "</head><body>");
-
-    txt.append("<h1>" + otsikko() + "</h1>");
-    txt.append("<p>" + kp()->asetukset()->asetus("Nimi") + "<br>");
-    txt.append( kausiteksti() + "</p>");
-    txt.append("<table width=100%><thead>\n");
+    if( !tulostettu_ )
+        return 0;
 
-    // Otsikkorivit
-    foreach (RaporttiRivi otsikkorivi, otsakkeet_ )
-    {
-        if( otsikkorivi.kaytto() == RaporttiRivi::CSV)
-            continue;
+    painter_->restore();
+    tulostettu_ = false;
+    return sivu_;
+}
 
-        txt.append("<tr>");
-        for(int i=0; i < otsikkorivi.sarakkeita(); i++)
-        {
+void RaportinKirjoittaja::Sivuttaja::aloitaSivu()
+{
+    // Ollaan sivun alussa
 
-            txt.append(QString("<th colspan=%1>").arg( otsikkorivi.leveysSaraketta(i)));
-            txt.append( otsikkorivi.teksti(i));
-            txt.append("</th>");
-        }
-        txt.append("</tr>\n");
-    }
+    painter_->save();
+    painter_->setFont(QFont("FreeSans", 10 - pienennys_));
 
-    txt.append("</thead>\n");
-    // Rivit
-    foreach (RaporttiRivi rivi, rivit_)
-    {
-        if( rivi.kaytto() == RaporttiRivi::CSV)
-            continue;
+    // Tulostetaan ylätunniste
+    if( !raportti_.otsikko_.isEmpty())
+        raportti_.tulostaYlatunniste( painter_, sivu_ + alkusivunumero_ - 1);
 
-        QStringList trluokat;
-        if( rivi.onkoLihava())
-            trluokat << "lihava";
-        if( rivi.onkoViivaa())
-            trluokat << "viiva";
+    if( !raportti_.otsakkeet_.isEmpty())
+        painter_->translate(0, rivinkorkeus_);
 
-        if( trluokat.isEmpty())
-            txt.append("<tr>");
-        else
-            txt.append("<tr class=\"" + trluokat.join(' ') + "\">");
+    // Otsikkorivit
+    for (const RaporttiRivi& otsikkorivi : raportti_.otsakkeet_)
+    {
+        if( otsikkorivi.kaytto() == RaporttiRivi::CSV)
+            continue;
 
-        if( !rivi.sarakkeita())
-            txt.append("<td>&nbsp;</td>"); // Tyhjätkin rivit näkyviin!
+        int x = 0;
+        int sarake = 0;
 
-        for(int i=0; i < rivi.sarakkeita(); i++)
+        for( int i = 0; i < otsikkorivi.sarakkeita(); i++)
         {
 
-            if( rivi.tasattuOikealle(i) )
-                txt.append(QString("<td colspan=%1 class=oikealle>").arg(rivi.leveysSaraketta(i)));
-            else
-                txt.append(QString("<td colspan=%1>").arg(rivi.leveysSaraketta(i)));
+            int lippu = 0;
+            QString teksti = otsikkorivi.teksti(i);
 
-            if(linkit)
+            if( otsikkorivi.tasattuOikealle(i))
             {
-                if( rivi.sarake(i).linkkityyppi == RaporttiRiviSarake::TOSITE_ID)
-                {
-                    // Linkki tositteeseen
-                    txt.append( QString("<a href=\"%1.html\">").arg( rivi.sarake(i).linkkidata , 8, 10 , QChar('0') ) );
-                }
-                else if( rivi.sarake(i).linkkityyppi == RaporttiRiviSarake::TILI_NRO)
-                {
-                    // Linkki tiliin
-                    txt.append( QString("<a href=\"paakirja.html#%2\">").arg( rivi.sarake(i).linkkidata));
-                }
-                else if( rivi.sarake(i).linkkityyppi == RaporttiRiviSarake::TILI_LINKKI)
-                {
-                    // Nimiö dataan
-                    txt.append( QString("<a name=\"%1\">").arg( rivi.sarake(i).linkkidata));
-                }
+                lippu = Qt::AlignRight;
+                teksti.append("  ");
             }
-            QString tekstia = rivi.teksti(i);
-            tekstia.replace(' ', "&nbsp;");
-            tekstia.replace('\n', "<br>");
-
-            txt.append(  tekstia );
+            int sarakeleveys = 0;
 
-            if( linkit && rivi.sarake(i).linkkityyppi )
-                txt.append("</a>");
+            for( int ysind = 0; ysind < otsikkorivi.leveysSaraketta(i); ysind++ )
+            {
+                sarakeleveys += leveydet_.value(sarake);
+                sarake++;
+            }
+            painter_->drawText( QRect(x,0,sarakeleveys,rivinkorkeus_),
+                              lippu, teksti );
 
-            txt.append("&nbsp;</td>");
+            x += sarakeleveys;
         }
-        txt.append("</tr>\n");
+        painter_->translate(0, rivinkorkeus_);
+    } // Otsikkorivi
+    if( !raportti_.otsikko_.isEmpty() || !raportti_.otsakkeet_.isEmpty())
+        painter_->drawLine(0,0,sivunleveys_,0);
+}
 
+void RaportinKirjoittaja::kirjoita(RaporttiKohde &kohde) const
+{
+    kohde.asetaOtsikko( otsikko_ );
+    kohde.asetaKausiteksti( kausiteksti_ );
+
+    for( const RaporttiSarake& sarake : sarakkeet_)
+    {
+        if( !sarake.leveysteksti.isEmpty())
+            kohde.lisaaSarake( sarake.leveysteksti, sarake.sarakkeenKaytto );
+        else if( sarake.leveysprossa )
+            kohde.lisaaSarake( sarake.leveysprossa );
+        else
+            kohde.lisaaVenyvaSarake( sarake.jakotekija );
     }
-    txt.append("</table>");
-    txt.append("<p class=tulostettu>Tulostettu " + QDate::currentDate().toString("dd.MM.yyyy"));
-    if( kp()->onkoHarjoitus())
-        txt.append("<br><span class=treeni>Kirjanpito on laadittu Kitupiikki-ohjelman harjoittelutilassa</span>");
 
-    txt.append("</p></body></html>\n");
+    for( const RaporttiRivi& otsake : otsakkeet_)
+        kohde.lisaaOtsake( otsake );
+    for( const RaporttiRivi& rivi : rivit_)
+        kohde.lisaaRivi( rivi );
+}
+
+QString RaportinKirjoittaja::html(bool linkit) const
+{
+    QByteArray array;
+    QBuffer buffer(&array);
+    buffer.open(QIODevice::WriteOnly);
+
+    kirjoitaHtml( &buffer, linkit);
+
+    return QString::fromUtf8(array);
+}
 
-    return txt;
+void RaportinKirjoittaja::kirjoitaHtml(QIODevice *laite, bool linkit) const
+{
+    HtmlRaporttiVirta virta(laite, linkit);
+    kirjoita( virta );
+    virta.valmis();
 }
 
 QByteArray RaportinKirjoittaja::pdf(bool taustaraidat, bool tulostaA4) const
@@ -424,7 +433,15 @@ QByteArray RaportinKirjoittaja::pdf(bool taustaraidat, bool tulostaA4) const
     QBuffer buffer(&array);
     buffer.open(QIODevice::WriteOnly);
 
-    QPdfWriter writer(&buffer);
+    kirjoitaPdf( &buffer, taustaraidat, tulostaA4);
+
+    return array;
+
+}
+
+void RaportinKirjoittaja::kirjoitaPdf(QIODevice *laite, bool taustaraidat, bool tulostaA4) const
+{
+    QPdfWriter writer(laite);
     writer.setCreator( QString("Kitupiikki %1").arg( qApp->applicationVersion() ) );
     writer.setTitle( otsikko() );
 
@@ -437,52 +454,24 @@ QByteArray RaportinKirjoittaja::pdf(bool taustaraidat, bool tulostaA4) const
 
     tulosta( &writer, &painter, taustaraidat );
     painter.end();
-
-    return array;
-
 }
 
 QByteArray RaportinKirjoittaja::csv() const
 {
-    QChar erotin = kp()->settings()->value("CsvErotin", QChar(',')).toChar();
-
-    QString txt;
-
-    for( RaporttiRivi otsikko : otsakkeet_)
-    {
-        if( otsikko.kaytto() == RaporttiRivi::EICSV)
-            continue;
-
-        QStringList otsakkeet;
-        for(int i=0; i < otsikko.sarakkeita(); i++)
-            otsakkeet.append( otsikko.csv(i));
-        txt.append( otsakkeet.join(erotin));
-    }
-    for( RaporttiRivi rivi : rivit_ )
-    {
-        if( rivi.kaytto() == RaporttiRivi::EICSV)
-            continue;
+    QByteArray array;
+    QBuffer buffer(&array);
+    buffer.open(QIODevice::WriteOnly);
 
-        if( rivi.sarakkeita() )
-        {
+    kirjoitaCsv( &buffer );
 
-            txt.append("\r\n");
-            QStringList sarakkeet;
-            for( int i=0; i < rivi.sarakkeita(); i++)
-            {
-                sarakkeet.append( rivi.csv(i));
-            }
-            txt.append( sarakkeet.join(erotin));
-        }
-    }
+    return array;
+}
 
-    if( kp()->settings()->value("CsvKoodaus").toString() == "latin1")
-    {
-        txt.replace("€","EUR");
-        return txt.toLatin1();
-    }
-    else
-        return txt.toUtf8();
+void RaportinKirjoittaja::kirjoitaCsv(QIODevice *laite) const
+{
+    CsvRaporttiVirta virta(laite);
+    kirjoita( virta );
+    virta.valmis();
 }
 
 void RaportinKirjoittaja::tulostaYlatunniste(QPainter *painter, int sivu) const
@@ -21,8 +21,14 @@
 #include <QString>
 #include <QList>
 #include <QPrinter>
+#include <QVector>
+#include <QRect>
+#include <QFont>
 
 #include "raporttirivi.h"
+#include "raporttikohde.h"
+
+class QIODevice;
 
 /**
  * @brief  Yksi raportin sarake, RaportinKirjoittajan sisäiseen käyttöön
@@ -76,49 +82,31 @@ struct RaporttiSarake
  *    kirjoittaja.tulosta( &printer, &painter );
  * @endcode
  *
+ * RaportinKirjoittaja on muistiin tallettava RaporttiKohde. Suuret
+ * raportit voi kirjoittaa suoraan tiedostoon RaporttiVirta-kohteilla.
+ *
  */
-class RaportinKirjoittaja
+class RaportinKirjoittaja : public RaporttiKohde
 {
 
 public:
     RaportinKirjoittaja(bool csvKaytossa = true);
 
-    void asetaOtsikko(const QString& otsikko);
-    void asetaKausiteksti(const QString& kausiteksti);
+    void asetaOtsikko(const QString& otsikko) override;
+    void asetaKausiteksti(const QString& kausiteksti) override;
 
-    /**
-     * @brief Lisää sarakkeen
-     * @param leveysteksti Teksti, jolle sarake mitoitetaan
-     */
-    void lisaaSarake(const QString& leveysteksti, RaporttiRivi::RivinKaytto kaytto = RaporttiRivi::KAIKKI);
-    /**
-     * @brief Lisää sarakkeen
-     * @param leveysprosentti Sarakkeen leveys on % sivun leveydestä
-     */
-    void lisaaSarake(int leveysprosentti);
+    void lisaaSarake(const QString& leveysteksti, RaporttiRivi::RivinKaytto kaytto = RaporttiRivi::KAIKKI) override;
+    void lisaaSarake(int leveysprosentti) override;
+    void lisaaVenyvaSarake(int tekija = 100) override;
 
-    /**
-     * @brief Lisää venyvän sarakkeen
-     * @param tekija Missä suhteessa jäljellä oleva tila jaetaan
-     */
-    void lisaaVenyvaSarake(int tekija = 100);
+    void lisaaOtsake(const RaporttiRivi &otsikkorivi) override;
+    void lisaaRivi(const RaporttiRivi &rivi = RaporttiRivi(RaporttiRivi::EICSV)) override;
+    void lisaaTyhjaRivi() override;
 
     /**
-     * @brief Lisää euromääräisen sarakkeen
-     */
-    void lisaaEurosarake();
-    /**
-     * @brief Lisää sarakkeen päivämäärälle
+     * @brief Kirjoittaa talletetun raportin toiseen kohteeseen
      */
-    void lisaaPvmSarake();
-
-    void lisaaOtsake(const RaporttiRivi &otsikkorivi);
-    void lisaaRivi(const RaporttiRivi &rivi = RaporttiRivi(RaporttiRivi::EICSV));
-
-    /**
-     * @brief Lisää tyhjän rivin jo edellinen ei ollut jo tyhjä
-     */
-    void lisaaTyhjaRivi();
+    void kirjoita(RaporttiKohde& kohde) const;
 
     /**
      * @brief Tulostaa kirjoitetun raportin
@@ -135,6 +123,13 @@ public:
      */
     QString html(bool linkit=false) const;
 
+    /**
+     * @brief Kirjoittaa raportin html-muodossa suoraan laitteelle
+     * @param laite Avoin laite, esimerkiksi QFile
+     * @param linkit Kirjoitetaanko arkiston linkit
+     */
+    void kirjoitaHtml(QIODevice *laite, bool linkit=false) const;
+
     /**
      * @brief pdf Raportti pdf-muodossa
      * @param taustaraidat Tulosta taustaraidat
@@ -143,6 +138,11 @@ public:
      */
     QByteArray pdf(bool taustaraidat = false, bool kaytaA4 = false) const;
 
+    /**
+     * @brief Kirjoittaa raportin pdf-muodossa suoraan laitteelle
+     */
+    void kirjoitaPdf(QIODevice *laite, bool taustaraidat = false, bool kaytaA4 = false) const;
+
     /**
      * @brief Palauttaa raportin csv-muodossa
      *
@@ -153,21 +153,122 @@ public:
      */
     QByteArray csv() const;
 
+    /**
+     * @brief Kirjoittaa raportin csv-muodossa rivi kerrallaan laitteelle
+     *
+     * Koko csv-tiedostoa ei muodosteta muistiin
+     */
+    void kirjoitaCsv(QIODevice *laite) const;
+
     QString otsikko() const { return otsikko_; }
     QString kausiteksti() const { return kausiteksti_; }
+    const QList<RaporttiRivi>& otsakkeet() const { return otsakkeet_; }
 
     bool csvKaytossa() const { return csvKaytossa_;}
 
     void tulostaYlatunniste(QPainter *painter, int sivu) const;
 
-    bool tyhja() const { return rivit_.isEmpty(); }
+    bool tyhja() const override { return rivit_.isEmpty(); }
 
-signals:
+protected:
+    /**
+     * @brief Yhden rivin tulostusmitat
+     */
+    struct RivinAsettelu
+    {
+        QVector<QRect> laatikot;
+        QVector<int> liput;
+        QVector<QString> tekstit;
+        int korkeus = 0;
+    };
 
-public slots:
+    /**
+     * @brief Koko raportin tulostusmitat yhdelle sivukoolle
+     *
+     * Sama asettelu kelpaa esikatseluun, tulostamiseen ja pdf:ään,
+     * kun sivun koko ja tarkkuus ovat samat.
+     */
+    struct Asettelu
+    {
+        QSize koko;
+        int dpi = 0;
+        int pienennys = 0;
+        QVector<int> leveydet;
+        int jaljella = 0;
+        QVector<RivinAsettelu> rivit;
+    };
 
-protected:
+    /**
+     * @brief Laskee sarakkeiden leveydet ja rivien laatikot
+     *
+     * Asettelu talletetaan, ja lasketaan uudelleen vain sivun koon tai rivien muuttuessa
+     */
+    const Asettelu& asettele(QPainter *painter, int pienennys) const;
 
+    /**
+     * @brief Sarakkeiden leveydet painterin sivulle ja fontille
+     * @param jaljella Leveys, joka jää käyttämättä
+     */
+    QVector<int> sarakeleveydet(QPainter *painter, int& jaljella) const;
+
+    /**
+     * @brief Laskee yhden rivin laatikot. Vaihtaa painterin fontin.
+     */
+    static RivinAsettelu asetteleRivi(QPainter *painter, const QVector<int>& leveydet, const RaporttiRivi& rivi,
+                                      int pienennys, int rivinkorkeus);
+
+public:
+    /**
+     * @brief Raportin tulostaminen sivuille rivi kerrallaan
+     *
+     * Vaihtaa sivua tarvittaessa ja tulostaa jokaisen sivun alkuun
+     * ylätunnisteen ja otsakkeet. Rivien ei tarvitse olla tallessa
+     * raportissa, joten tällä kirjoitetaan myös pdf-virtaa.
+     */
+    class Sivuttaja
+    {
+    public:
+        /**
+         * @param raportti Raportti, jonka otsikko, sarakkeet ja otsakkeet tulostetaan
+         */
+        Sivuttaja(const RaportinKirjoittaja& raportti, QPagedPaintDevice *printer, QPainter *painter,
+                  bool raidoita, int alkusivunumero);
+
+        int pienennys() const { return pienennys_; }
+
+        /**
+         * @brief Tulostaa rivin ja asettelee sen tulostettaessa
+         */
+        void tulosta(const RaporttiRivi& rivi);
+        void tulosta(const RaporttiRivi& rivi, const RivinAsettelu& asettelu);
+
+        /**
+         * @brief Päättää tulostuksen
+         * @return Tulostettujen sivujen määrä, 0 jos rivejä ei tulostettu
+         */
+        int lopeta();
+
+    protected:
+        void aloitaSivu();
+
+        const RaportinKirjoittaja& raportti_;
+        QPagedPaintDevice *printer_;
+        QPainter *painter_;
+        bool raidoita_;
+        int alkusivunumero_;
+
+        int pienennys_;
+        QFont fontti_;
+        int rivinkorkeus_;
+        int sivunleveys_;
+        int sivunkorkeus_;
+        QVector<int> leveydet_;
+        int jaljella_ = 0;
+
+        int sivu_ = 1;
+        int rivilla_ = 0;
+        bool tulostettu_ = false;
+    };
 
 
 protected:
@@ -179,6 +280,8 @@ protected:
     QList<RaporttiRivi> otsakkeet_;
     QList<RaporttiRivi> rivit_;
 
+    mutable Asettelu asettelu_;
+
 };
 
 #endif // RAPORTINKIRJOITTAJA_H
@@ -19,11 +19,12 @@
 #include <QDebug>
 #include <QSqlError>
 
-#include <QRegularExpression>
-#include <QRegularExpressionMatch>
+#include <algorithm>
+#include <limits>
 
 #include "raportoija.h"
 #include "raporttirivi.h"
+#include "raporttivalimuisti.h"
 
 #include "db/kirjanpito.h"
 #include "db/tilikausi.h"
@@ -33,11 +34,11 @@ Raportoija::Raportoija(const QString &raportinNimi) :
     otsikko_(raportinNimi),
     tyyppi_ ( VIRHEELLINEN )
 {
-    kaava_ = kp()->asetukset()->lista("Raportti/" + raportinNimi);
+    kaava_ = RaporttiKaava::kaava(raportinNimi);
     // Jos raporttia ei ole, jää VIRHEELLINEN-raportti
-    if( kaava_.length() > 2)
+    if( !kaava_.optiorivi().isEmpty())
     {
-        optiorivi_ = kaava_.takeFirst();
+        optiorivi_ = kaava_.optiorivi();
 
         if( optiorivi_.startsWith(":tulos"))
             tyyppi_ = TULOSLASKELMA;
@@ -64,9 +65,57 @@ void Raportoija::lisaaTasepaiva(const QDate &pvm)
 
 RaportinKirjoittaja Raportoija::raportti(bool tulostaErittelyt)
 {
-    data_.resize( loppuPaivat_.count() );
+    QString avain = valimuistiAvain(tulostaErittelyt);
+    RaportinKirjoittaja rk;
+    if( RaporttiValimuisti::hae(avain, rk))
+        return rk;
+
+    rk = kirjoitaRaportti(tulostaErittelyt);
+
+    // Taseen luvut kertyvät kirjanpidon alusta saakka
+    QDate alkaa;
+    if( !onkoTaseraportti() && !alkuPaivat_.isEmpty())
+        alkaa = *std::min_element(alkuPaivat_.constBegin(), alkuPaivat_.constEnd());
+    QDate paattyy;
+    if( !loppuPaivat_.isEmpty())
+        paattyy = *std::max_element(loppuPaivat_.constBegin(), loppuPaivat_.constEnd());
+
+    RaporttiValimuisti::lisaa(avain, rk, alkaa, paattyy);
+    return rk;
+}
+
+QString Raportoija::valimuistiAvain(bool tulostaErittelyt) const
+{
+    // Avaimessa on koko kaava, jotta muokattu raportti kirjoitetaan uudelleen
+    QStringList avain;
+    avain << otsikko_ << kp()->asetukset()->asetus("Raportti/" + otsikko_);
+
+    for(int i=0; i < loppuPaivat_.count(); i++)
+        avain << QString("%1-%2/%3").arg( alkuPaivat_.value(i).toString(Qt::ISODate))
+                                    .arg( loppuPaivat_.at(i).toString(Qt::ISODate))
+                                    .arg( sarakeTyypit_.value(i));
+
+    QStringList kohdennukset;
+    for(int kohdennus : kohdennusKaytossa_)
+        kohdennukset.append( QString::number(kohdennus));
+    avain << kohdennukset.join(',');
 
+    avain << (tulostaErittelyt ? "E" : "-");
+
+    return avain.join('\n');
+}
+
+RaportinKirjoittaja Raportoija::kirjoitaRaportti(bool tulostaErittelyt)
+{
     RaportinKirjoittaja rk;
+    kirjoitaRaportti(rk, tulostaErittelyt);
+    return rk;
+}
+
+void Raportoija::kirjoitaRaportti(RaporttiKohde &rk, bool tulostaErittelyt)
+{
+    data_.resize( loppuPaivat_.count() );
+
     kirjoitaYlatunnisteet(rk);
 
     if( tyyppi() == TULOSLASKELMA)
@@ -134,11 +183,10 @@ RaportinKirjoittaja Raportoija::raportti(bool tulostaErittelyt)
             rk.lisaaRivi( RaporttiRivi());
         }
     }
-    return rk;
 }
 
 
-void Raportoija::kirjoitaYlatunnisteet(RaportinKirjoittaja &rk)
+void Raportoija::kirjoitaYlatunnisteet(RaporttiKohde &rk)
 {
     QString otsikko = otsikko_;
     // Jos otsikko päättyy tarkenteeseen /Yleinen, ei sitä tartte tulostaa
@@ -208,182 +256,82 @@ void Raportoija::kirjoitaYlatunnisteet(RaportinKirjoittaja &rk)
 
 }
 
-void Raportoija::kirjoitaDatasta(RaportinKirjoittaja &rk, bool tulostaErittelyt)
+void Raportoija::kirjoitaDatasta(RaporttiKohde &rk, bool tulostaErittelyt)
 {
-
-    QRegularExpression tiliRe("[\\s\\t,](?<alku>\\d{1,8})(\\.\\.)?(?<loppu>\\d{0,8})(?<menotulo>[+-]?)");
-    QRegularExpression maareRe("(?<maare>([A-Za-z=]+|\\*))(?<sisennys>[0-9]?)");
-
     // Välisummien käsittelyä = varten
     QVector<qlonglong> kokosumma( loppuPaivat_.count());
     QVector<qlonglong> budjettikokosumma( loppuPaivat_.count());
 
-    foreach (QString rivi, kaava_)
+    // Tilivälien summat haetaan sarakkeittain lasketuista kertymistä
+    QHash<int,int> tililajit;
+    QVector<KaavanSummat> summataulut;
+    QVector<KaavanSummat> budjettitaulut;
+    for( int sarake = 0; sarake < data_.count(); sarake++)
+    {
+        summataulut.append( KaavanSummat( data_.at(sarake), &tililajit ));
+        budjettitaulut.append( KaavanSummat( budjetti_.value(sarake), &tililajit));
+    }
+
+    for (const KaavanRivi& rivi : kaava_.rivit())
     {
-        if( !rivi.length() )
+        if( rivi.tyyppi == KaavanRivi::TYHJA )
         {
             rk.lisaaTyhjaRivi();
             continue;
         }
 
-        int tyhjanpaikka = rivi.indexOf('\t');
-
-        if( tyhjanpaikka < 0 )
-            tyhjanpaikka = rivi.indexOf("    ");
-
         RaporttiRivi rr;
 
-        if( tyhjanpaikka < 0 )
+        if( rivi.tyyppi == KaavanRivi::TEKSTI )
         {
             // Jos pelkkää tekstiä, niin se on sitten otsikko
-            rr.lisaa(rivi);
+            rr.lisaa(rivi.teksti);
             rk.lisaaRivi(rr);
             continue;
         }
 
-        QString loppurivi = rivi.mid(tyhjanpaikka);     // Aloittava tyhjä mukaan!
-
         // Lasketaan summat
         QVector<qlonglong> summat( loppuPaivat_.count() );
         QVector<qlonglong> budjetit( loppuPaivat_.count());
 
-        int sisennys = 0;
-
-        RivinTyyppi rivityyppi = SUMMA;
-        bool naytaTyhjarivi = false;
-        bool laskevalisummaan = true;
-        bool lisaavalisumma = false;
-        bool naytaErittely = false;
-        int erittelySisennys = 4;
-
-        // Haetaan määreet
-        QRegularExpressionMatchIterator mri = maareRe.globalMatch( loppurivi );
-        while( mri.hasNext())
-        {
-            QRegularExpressionMatch maareMats = mri.next();
-            QString maare = maareMats.captured("maare");
+        KaavanRivi::RivinTyyppi rivityyppi = rivi.rivityyppi;
 
-            // Sisennys
-            if( !maareMats.captured("sisennys").isEmpty())
-            {
-                int uusisisennys = maareMats.captured("sisennys").toInt();
-                if( maare == "*")
-                    erittelySisennys = uusisisennys;
-                else
-                    sisennys = uusisisennys;
-            }
-            if( maare == "*")
-            {
-                naytaErittely = true;
-            }
-            else if( maare == "S" || maare == "SUM" || maare == "SUMMA")
-            {
-                naytaTyhjarivi = true;
-            }
-            else if( maare == "H" || maare=="HEADING" || maare == "OTSIKKO")
-            {
-                rivityyppi = OTSIKKO;
-                naytaTyhjarivi = true;
-            }
-            else if( maare == "d" || maare == "details" || maare == "erittely")
-                rivityyppi = ERITTELY;
-            else if( maare == "h" || maare == "heading" || maare == "otsikko")
-                rivityyppi = OTSIKKO;
-            else if( maare == "=")
-                lisaavalisumma = true;
-            else if( maare == "==")
-                laskevalisummaan = false;
-            else if( maare == "bold" || maare == "lihava")
-                rr.lihavoi(true);
-            else if( maare == "viiva" || maare == "line")
-                rr.viivaYlle(true);
-        }
+        if( rivi.lihava )
+            rr.lihavoi(true);
+        if( rivi.viiva )
+            rr.viivaYlle(true);
 
         // Sisennys paikoilleen!
-        QString sisennysStr;
-        for( int i=0; i < sisennys; i++)
-            sisennysStr.append(' ');
+        QString sisennysStr( rivi.sisennys, ' ');
 
-        rr.lisaa( sisennysStr + rivi.left(tyhjanpaikka) );   // Lisätään teksti
+        rr.lisaa( sisennysStr + rivi.teksti );   // Lisätään teksti
 
 
-        if( rivityyppi != ERITTELY)
+        if( rivityyppi != KaavanRivi::ERITTELY)
         {
+            bool haettuTileja = !rivi.valit.isEmpty();   // Onko tiliväli määritelty (ellei, niin kyse on otsikosta)
 
-            QRegularExpressionMatchIterator ri = tiliRe.globalMatch(loppurivi );
-            // ri hakee numerot 1..1
-            bool haettuTileja = ri.hasNext();   // Onko tiliväli määritelty (ellei, niin kyse on otsikosta)
-
-            while( ri.hasNext())
+            for( const KaavanVali& vali : rivi.valit)
             {
-                QRegularExpressionMatch tiliMats = ri.next();
-                int alku = Tili::ysiluku( tiliMats.captured("alku").toInt(), false);
-                int loppu;
-
-                if( !tiliMats.captured("loppu").isEmpty())
-                    loppu = Tili::ysiluku(tiliMats.captured("loppu").toInt(), true);
-                else
-                    loppu = Tili::ysiluku( tiliMats.captured("alku").toInt(), true);
-                bool vainTulot = tiliMats.captured("menotulo") == "+";
-                bool vainMenot = tiliMats.captured("menotulo") == "-";
-
                 // Lasketaan summa joka sarakkeelle
-                // Tässä voitaisiin käyttää vähän tehokkaampaa algoritmiä..
-
                 for( int sarake = 0; sarake < data_.count(); sarake++)
                 {
-                    QMapIterator<int,qlonglong> iter( data_.at(sarake));
-                    while( iter.hasNext())
-                    {
-                        iter.next();
-                        if( iter.key() >= alku )
-                        {
-                            if( iter.key() > loppu) // Päästy jo yli
-                                break;
+                    qlonglong summa = summataulut.at(sarake).summa(vali);
+                    qlonglong budjetti = budjettitaulut.at(sarake).summa(vali);
 
-                            if( vainTulot || vainMenot)
-                            {
-                                Tili tili = kp()->tilit()->tiliNumerolla( iter.key() / 10);
+                    summat[sarake] += summa;
+                    budjetit[sarake] += budjetti;
 
-                                // Ohitetaan, jos haluttu vain tulot ja menot eikä ole niitä
-                                if( (vainTulot && !tili.onko(TiliLaji::TULO) ) || (vainMenot && !tili.onko(TiliLaji::MENO) ))
-                                        continue;
-                            }
-
-                            summat[sarake] += iter.value();
-
-                            if( laskevalisummaan)
-                                kokosumma[sarake] += iter.value();  // Lisätään välisummaan
-                        }
-                    }
-
-                    QMapIterator<int,qlonglong> budjettiIter( budjetti_.at(sarake));
-                    while( budjettiIter.hasNext())
+                    if( rivi.laskevalisummaan)
                     {
-                        budjettiIter.next();
-                        if( budjettiIter.key() >= alku && budjettiIter.key() <= loppu )
-                        {
-                            if( vainTulot || vainMenot)
-                            {
-                                Tili tili = kp()->tilit()->tiliNumerolla( budjettiIter.key() / 10);
-
-                                // Ohitetaan, jos haluttu vain tulot ja menot eikä ole niitä
-                                if( (vainTulot && !tili.onko(TiliLaji::TULO) ) || (vainMenot && !tili.onko(TiliLaji::MENO) ))
-                                        continue;
-                            }
-
-                            budjetit[sarake] += budjettiIter.value();
-
-                            if( laskevalisummaan)
-                                budjettikokosumma[sarake] += budjettiIter.value();  // Lisätään välisummaan
-                        }
+                        // Lisätään välisummaan
+                        kokosumma[sarake] += summa;
+                        budjettikokosumma[sarake] += budjetti;
                     }
-
-
                 }
 
             }
-            if( lisaavalisumma )
+            if( rivi.lisaavalisumma )
             {
                 // Välisumman lisääminen
                 for(int sarake=0; sarake < data_.count(); sarake++)
@@ -405,14 +353,14 @@ void Raportoija::kirjoitaDatasta(RaportinKirjoittaja &rk, bool tulostaErittelyt)
 
             }
 
-            if( !naytaTyhjarivi && !kirjauksia && haettuTileja && !lisaavalisumma)
+            if( !rivi.naytaTyhjarivi && !kirjauksia && haettuTileja && !rivi.lisaavalisumma)
                 continue;       // Ei tulosteta tyhjää riviä ollenkaan
-            else if( !haettuTileja && !lisaavalisumma)
-                rivityyppi = OTSIKKO;
+            else if( !haettuTileja && !rivi.lisaavalisumma)
+                rivityyppi = KaavanRivi::OTSIKKO;
         }
 
         // header tulostaa vain otsikon
-        if( rivityyppi != OTSIKKO  )
+        if( rivityyppi != KaavanRivi::OTSIKKO  )
         {
             // Sitten kirjoitetaan summat riville
             for( int sarake=0; sarake < data_.count(); sarake++)
@@ -441,76 +389,55 @@ void Raportoija::kirjoitaDatasta(RaportinKirjoittaja &rk, bool tulostaErittelyt)
             }
         }
 
-        if( rivityyppi != ERITTELY)
+        if( rivityyppi != KaavanRivi::ERITTELY)
             rk.lisaaRivi(rr);
 
-        if( rivityyppi == ERITTELY || (naytaErittely && tulostaErittelyt ))
+        if( rivityyppi == KaavanRivi::ERITTELY || (rivi.naytaErittely && tulostaErittelyt ))
         {
             // eriSisennysStr on erittelyrivin aloitussisennys, joka *-rivillä kasvaa edellisen rivin sisennyksestä
             QString eriSisennysStr = sisennysStr;
-            if( naytaErittely )
-            {
-                for( int i=0; i < erittelySisennys; i++)
-                    eriSisennysStr.append(' ');
-            }
+            if( rivi.naytaErittely )
+                eriSisennysStr.append( QString( rivi.erittelySisennys, ' '));
 
             // details-tuloste: kaikkien välille kuuluvien tilien nimet ja summat
             // sama, mikäli tavallista summariviä seuraa *-merkillä tulostuva erittely
 
-            QRegularExpressionMatchIterator ri = tiliRe.globalMatch(loppurivi );
-
-            while( ri.hasNext())
+            for( const KaavanVali& vali : rivi.valit)
             {
-                QRegularExpressionMatch tiliMats = ri.next();
-                int alku = Tili::ysiluku( tiliMats.captured("alku").toInt(), false);
-                int loppu;
-
-                if( !tiliMats.captured("loppu").isEmpty())
-                    loppu = Tili::ysiluku(tiliMats.captured("loppu").toInt(), true);
-                else
-                    loppu = Tili::ysiluku( tiliMats.captured("alku").toInt(), true);
-                bool vainTulot = tiliMats.captured("menotulo") == "+";
-                bool vainMenot = tiliMats.captured("menotulo") == "-";
+                QMap<int,bool>::const_iterator iter = tilitKaytossa_.lowerBound( vali.alku );
+                for( ; iter != tilitKaytossa_.constEnd() && iter.key() <= vali.loppu; ++iter)
+                {
+                    RaporttiRivi rr;
+                    Tili tili = kp()->tilit()->tiliNumerolla( iter.key() / 10);
 
+                    // Ohitetaan, jos haluttu vain tulot ja menot eikä ole niitä
+                    if( (vali.vainTulot && !tili.onko(TiliLaji::TULO) ) || (vali.vainMenot && !tili.onko(TiliLaji::MENO)))
+                            continue;
 
-                QMapIterator<int,bool> iter( tilitKaytossa_ );
-                while( iter.hasNext())
-                {
-                    iter.next();
-                    if( iter.key() >= alku && iter.key() <= loppu )
+                    // Erittelyriville tilin numero ja nimi sekä summat
+                    rr.lisaaLinkilla( RaporttiRiviSarake::TILI_NRO, tili.numero(), QString("%1%2 %3").arg(eriSisennysStr).arg(tili.numero()).arg(tili.nimi()));
+                    for( int sarake=0; sarake < data_.count(); sarake++)
                     {
-                        RaporttiRivi rr;
-                        Tili tili = kp()->tilit()->tiliNumerolla( iter.key() / 10);
-
-                        // Ohitetaan, jos haluttu vain tulot ja menot eikä ole niitä
-                        if( (vainTulot && !tili.onko(TiliLaji::TULO) ) || (vainMenot && !tili.onko(TiliLaji::MENO)))
-                                continue;
-
-                        // Erittelyriville tilin numero ja nimi sekä summat
-                        rr.lisaaLinkilla( RaporttiRiviSarake::TILI_NRO, tili.numero(), QString("%1%2 %3").arg(eriSisennysStr).arg(tili.numero()).arg(tili.nimi()));
-                        for( int sarake=0; sarake < data_.count(); sarake++)
-                        {
-                            switch (sarakeTyypit_.at(sarake)) {
-
-                            case TOTEUTUNUT :
-                                rr.lisaa( data_.at(sarake).value(iter.key(), 0) , true );
-                                break;
-                            case BUDJETTI:
-                                rr.lisaa( budjetti_.at(sarake).value(iter.key(), 0), false);
-                                break;
-                            case BUDJETTIERO:
-                                rr.lisaa( data_.at(sarake).value(iter.key(), 0) - budjetti_.at(sarake).value(iter.key(), 0), true );
-                                break;
-                            case TOTEUMAPROSENTTI:
-                                if( !budjetti_.at(sarake).value(iter.key(), 0))
-                                    rr.lisaa("");
-                                else
-                                    rr.lisaa( 10000 * data_.at(sarake).value(iter.key(), 0) / budjetti_.at(sarake).value(iter.key(), 0), true );
-                            }
-
+                        switch (sarakeTyypit_.at(sarake)) {
+
+                        case TOTEUTUNUT :
+                            rr.lisaa( data_.at(sarake).value(iter.key(), 0) , true );
+                            break;
+                        case BUDJETTI:
+                            rr.lisaa( budjetti_.at(sarake).value(iter.key(), 0), false);
+                            break;
+                        case BUDJETTIERO:
+                            rr.lisaa( data_.at(sarake).value(iter.key(), 0) - budjetti_.at(sarake).value(iter.key(), 0), true );
+                            break;
+                        case TOTEUMAPROSENTTI:
+                            if( !budjetti_.at(sarake).value(iter.key(), 0))
+                                rr.lisaa("");
+                            else
+                                rr.lisaa( 10000 * data_.at(sarake).value(iter.key(), 0) / budjetti_.at(sarake).value(iter.key(), 0), true );
                         }
-                        rk.lisaaRivi( rr );
+
                     }
+                    rk.lisaaRivi( rr );
                 }
 
             }
@@ -542,41 +469,54 @@ void Raportoija::sijoitaTulosKyselyData(const QString &kysymys, int i)
     data_[i].insert( 0, tulossumma );
 }
 
+void Raportoija::sijoitaTulosData(const QMap<int, VientiSarakkeet::Summa> &summat, int i)
+{
+    qlonglong tulossumma = 0;
+
+    QMapIterator<int, VientiSarakkeet::Summa> iter(summat);
+    while( iter.hasNext())
+    {
+        iter.next();
+        int ysiluku = iter.key();
+        qlonglong saldo = iter.value().kredit - iter.value().debet;
+
+        data_[i].insert( ysiluku, saldo  );
+        tilitKaytossa_.insert( ysiluku, true);
+
+        tulossumma += saldo;
+    }
+
+    // Sijoitetaan vielä summa "tilille" 0
+    data_[i].insert( 0, tulossumma );
+}
+
 void Raportoija::laskeTulosData()
 {
     // Tuloslaskelman summien laskemista
+    const VientiSarakkeet& viennit = VientiSarakkeet::viennit();
+
     for( int i = 0; i < alkuPaivat_.count(); i++)
     {
         if( sarakeTyypit_.value(i) != BUDJETTI )
-        {
-
-            QString kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                      "from vienti,tili where vienti.tili = tili.id and ysiluku > 300000000 "
-                                      "and pvm between \"%1\" and \"%2\" "
-                                      "group by ysiluku").arg( alkuPaivat_.at(i).toString(Qt::ISODate)).arg(loppuPaivat_.at(i).toString(Qt::ISODate));
-
-
-            sijoitaTulosKyselyData( kysymys , i);
-        }        
+            sijoitaTulosData( viennit.summat( alkuPaivat_.at(i), loppuPaivat_.at(i), TULOSTILIT, std::numeric_limits<int>::max() ) , i);
     }
 }
 
 void Raportoija::laskeTaseDate()
 {
     // Taseen summien laskeminen
+    const VientiSarakkeet& viennit = VientiSarakkeet::viennit();
+
     for( int i=0; i < loppuPaivat_.count(); i++)
     {
         // 1) Tasetilien summat
-        QString kysymys = QString("SELECT ysiluku, sum(debetsnt), sum(kreditsnt) "
-                                  "from vienti,tili where vienti.tili = tili.id and ysiluku < 300000000 "
-                                  "and pvm <= \"%1\" "
-                                  "group by ysiluku").arg(loppuPaivat_.at(i).toString(Qt::ISODate));
-        QSqlQuery query(kysymys);
-        while (query.next())
+        QMapIterator<int, VientiSarakkeet::Summa> iter( viennit.summat( QDate(), loppuPaivat_.at(i), 0, TULOSTILIT - 2));
+        while (iter.hasNext())
         {
-            int ysiluku = query.value(0).toInt();
-            qlonglong debet = query.value(1).toLongLong();
-            qlonglong kredit = query.value(2).toLongLong();
+            iter.next();
+            int ysiluku = iter.key();
+            qlonglong debet = iter.value().debet;
+            qlonglong kredit = iter.value().kredit;
 
             if( ysiluku < 200000000)    // Vastaavaa
                 data_[i].insert( ysiluku, debet - kredit );
@@ -589,38 +529,25 @@ void Raportoija::laskeTaseDate()
         // 2)  Sijoitetaan "edellisten tilikausien alijäämä/ylijäämä" ko.tilille
         Tilikausi tilikausi = kp()->tilikaudet()->tilikausiPaivalle( loppuPaivat_.at(i) );
 
-        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id "
-                          " AND ysiluku > 300000000 AND pvm < \"%1\" ").arg( tilikausi.alkaa().toString(Qt::ISODate));
-        query.exec(kysymys);
-        if( query.next())
-        {
-            qlonglong edYlijaama = query.value(1).toLongLong() - query.value(0).toLongLong();
-
-            int kertymaTilinYsiluku = kp()->tilit()->edellistenYlijaamaTili().ysivertailuluku();
-            if( kertymaTilinYsiluku )
-            {
-                data_[i][ kertymaTilinYsiluku] = edYlijaama + data_[i].value( kertymaTilinYsiluku, 0);
-                tilitKaytossa_.insert(kertymaTilinYsiluku, true);
-            }
+        VientiSarakkeet::Summa edelliset = viennit.yhteensa( QDate(), tilikausi.alkaa().addDays(-1), TULOSTILIT, std::numeric_limits<int>::max());
+        qlonglong edYlijaama = edelliset.kredit - edelliset.debet;
 
+        int kertymaTilinYsiluku = kp()->tilit()->edellistenYlijaamaTili().ysivertailuluku();
+        if( kertymaTilinYsiluku )
+        {
+            data_[i][ kertymaTilinYsiluku] = edYlijaama + data_[i].value( kertymaTilinYsiluku, 0);
+            tilitKaytossa_.insert(kertymaTilinYsiluku, true);
         }
 
         // 3) Sijoitetaan tämän tilikauden tulos "tulostilille" 0 ja määritellylle tulostilille
-        kysymys = QString("SELECT sum(debetsnt), sum(kreditsnt) FROM vienti, tili WHERE vienti.tili=tili.id"
-                          " AND ysiluku > 300000000 AND pvm BETWEEN \"%1\" AND \"%2\"")
-                .arg( tilikausi.alkaa().toString(Qt::ISODate) ).arg( loppuPaivat_.at(i).toString(Qt::ISODate));
+        VientiSarakkeet::Summa kausi = viennit.yhteensa( tilikausi.alkaa(), loppuPaivat_.at(i), TULOSTILIT, std::numeric_limits<int>::max());
+        qlonglong tulos = kausi.kredit - kausi.debet;
 
-        query.exec(kysymys);
-        if( query.next() )
+        data_[i].insert(0, tulos);
+        if( kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).onkoValidi())
         {
-            qlonglong debet = query.value(0).toLongLong();
-            qlonglong kredit = query.value(1).toLongLong();
-            data_[i].insert(0, kredit - debet);
-            if( kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).onkoValidi())
-            {
-                data_[i].insert(kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).ysivertailuluku(), kredit - debet);
-                tilitKaytossa_.insert(kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).ysivertailuluku(), true  );
-            }
+            data_[i].insert(kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).ysivertailuluku(), tulos);
+            tilitKaytossa_.insert(kp()->tilit()->tiliTyypilla(TiliLaji::KAUDENTULOS).ysivertailuluku(), true  );
         }
 
     }
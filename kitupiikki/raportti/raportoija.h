@@ -25,6 +25,8 @@
 #include <QObject>
 
 #include "raportinkirjoittaja.h"
+#include "raporttikaava.h"
+#include "db/vientisarakkeet.h"
 
 
 /**
@@ -58,6 +60,11 @@ public:
         KOHDENNUSLASKELMA = 3
     };
 
+    /**
+     * @brief Tulostilien ysiluvut ovat tätä suurempia
+     */
+    static const int TULOSTILIT = 300000001;
+
     enum SarakeTyyppi
     {
         TOTEUTUNUT = 0,
@@ -130,17 +137,23 @@ public:
      * @param tulostaErittelyt Tulostetaanko *-rivien jälkeen tilikohtaiset erittelyt
      * @param csvmuoto Muotoillaanko csv-tulostusta varten
      * @return
+     *
+     * Valmis raportti otetaan RaporttiValimuistista, jos kirjanpitoon ei ole
+     * raportin jälkeen tehty raportin kausiin vaikuttavia muutoksia
      */
     RaportinKirjoittaja raportti(bool tulostaErittelyt = true);
 
+    /**
+     * @brief Kirjoittaa raportin kohteeseen rivi kerrallaan ohi välimuistin
+     */
+    void kirjoitaRaportti(RaporttiKohde& rk, bool tulostaErittelyt = true);
+
 protected:
-    enum RivinTyyppi
-    {
-        OLETUS, SUMMA, OTSIKKO, ERITTELY
-    };
+    RaportinKirjoittaja kirjoitaRaportti(bool tulostaErittelyt);
+    QString valimuistiAvain(bool tulostaErittelyt) const;
 
-    void kirjoitaYlatunnisteet(RaportinKirjoittaja &rk);
-    void kirjoitaDatasta(RaportinKirjoittaja &rk, bool tulostaErittelyt);
+    void kirjoitaYlatunnisteet(RaporttiKohde &rk);
+    void kirjoitaDatasta(RaporttiKohde &rk, bool tulostaErittelyt);
 
     /**
      * @brief Sijoittaa tulostilien kyselyn dataan
@@ -148,6 +161,12 @@ protected:
      */
     void sijoitaTulosKyselyData(const QString& kysymys, int i);
 
+    /**
+     * @brief Sijoittaa tulostilien summat dataan
+     * @param summat Summat ysiluvuittain
+     */
+    void sijoitaTulosData(const QMap<int, VientiSarakkeet::Summa>& summat, int i);
+
     void laskeTulosData();
     void laskeTaseDate();
 
@@ -166,7 +185,7 @@ protected:
 
 protected:
     QString otsikko_;
-    QStringList kaava_;
+    RaporttiKaava kaava_;
     QString optiorivi_;
 
     RaportinTyyppi tyyppi_;
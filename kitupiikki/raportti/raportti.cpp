@@ -44,6 +44,7 @@
 #include <QPrinterInfo>
 
 #include "raportti.h"
+#include "raporttivirta.h"
 #include "db/kirjanpito.h"
 
 #include <QSettings>
@@ -59,8 +60,12 @@ Raportti::Raportti(QWidget *parent) : QWidget(parent)
         QPushButton *esikatseluBtn = new QPushButton(QIcon(":/pic/print.png"), tr("Esikatsele"));
         connect( esikatseluBtn, &QPushButton::clicked, this, &Raportti::esikatsele);
 
+        QPushButton *csvBtn = new QPushButton(QIcon(":/pic/csv.png"), tr("Vie csv"));
+        connect( csvBtn, &QPushButton::clicked, this, &Raportti::vieCsv);
+
         QHBoxLayout *nappiLeiska = new QHBoxLayout;
         nappiLeiska->addStretch();
+        nappiLeiska->addWidget(csvBtn);
         nappiLeiska->addWidget(esikatseluBtn);
 
         QVBoxLayout *paaLeiska = new QVBoxLayout;
@@ -76,3 +81,29 @@ void Raportti::esikatsele()
 {
     NaytinIkkuna::naytaRaportti( raportti() );
 }
+
+void Raportti::kirjoita(RaporttiKohde &kohde)
+{
+    raportti().kirjoita(kohde);
+}
+
+void Raportti::vieCsv()
+{
+    QString polku = QFileDialog::getSaveFileName(this, tr("Vie csv-tiedostoon"),
+                                                 QString(), "csv-tiedosto (*.csv)");
+    if( polku.isEmpty())
+        return;
+
+    QFile tiedosto( polku );
+    if( !tiedosto.open( QIODevice::WriteOnly))
+    {
+        QMessageBox::critical(this, tr("Tiedoston vieminen"),
+                              tr("Tiedostoon %1 kirjoittaminen epäonnistui.").arg(polku));
+        return;
+    }
+
+    // Rivit kirjoitetaan tiedostoon sitä mukaa kun raportti niitä muodostaa
+    CsvRaporttiVirta virta( &tiedosto );
+    kirjoita( virta );
+    virta.valmis();
+}
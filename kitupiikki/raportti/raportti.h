@@ -58,6 +58,14 @@ public:
      */
     virtual RaportinKirjoittaja raportti() = 0;
 
+    /**
+     * @brief Kirjoittaa raportin kohteeseen
+     *
+     * Oletuksena raportti kirjoitetaan ensin muistiin. Suuret raportit
+     * kirjoittavat rivit suoraan kohteeseen.
+     */
+    virtual void kirjoita(RaporttiKohde& kohde);
+
 
 signals:
 
@@ -67,6 +75,11 @@ public slots:
      */
     void esikatsele();
 
+    /**
+     * @brief Vie raportin csv-tiedostoon rivi kerrallaan
+     */
+    void vieCsv();
+
 
 
 protected:
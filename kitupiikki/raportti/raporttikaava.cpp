@@ -0,0 +1,227 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QRegularExpression>
+#include <QRegularExpressionMatch>
+
+#include <QPair>
+
+#include <algorithm>
+
+#include "raporttikaava.h"
+
+#include "db/kirjanpito.h"
+
+// Käännetyt kaavat raportin nimellä: lähdeteksti ja käännetty kaava
+static QHash<QString, QPair<QString,RaporttiKaava>> kaavat__;
+
+RaporttiKaava::RaporttiKaava()
+{
+
+}
+
+RaporttiKaava::RaporttiKaava(const QStringList &kaava)
+{
+    QRegularExpression tiliRe("[\\s\\t,](?<alku>\\d{1,8})(\\.\\.)?(?<loppu>\\d{0,8})(?<menotulo>[+-]?)");
+    QRegularExpression maareRe("(?<maare>([A-Za-z=]+|\\*))(?<sisennys>[0-9]?)");
+
+    for( const QString& rivi : kaava)
+    {
+        KaavanRivi kr;
+
+        if( !rivi.length() )
+        {
+            rivit_.append(kr);
+            continue;
+        }
+
+        int tyhjanpaikka = rivi.indexOf('\t');
+
+        if( tyhjanpaikka < 0 )
+            tyhjanpaikka = rivi.indexOf("    ");
+
+        if( tyhjanpaikka < 0 )
+        {
+            // Jos pelkkää tekstiä, niin se on sitten otsikko
+            kr.tyyppi = KaavanRivi::TEKSTI;
+            kr.teksti = rivi;
+            rivit_.append(kr);
+            continue;
+        }
+
+        kr.tyyppi = KaavanRivi::KAAVA;
+        kr.teksti = rivi.left(tyhjanpaikka);
+
+        QString loppurivi = rivi.mid(tyhjanpaikka);     // Aloittava tyhjä mukaan!
+
+        // Haetaan määreet
+        QRegularExpressionMatchIterator mri = maareRe.globalMatch( loppurivi );
+        while( mri.hasNext())
+        {
+            QRegularExpressionMatch maareMats = mri.next();
+            QString maare = maareMats.captured("maare");
+
+            // Sisennys
+            if( !maareMats.captured("sisennys").isEmpty())
+            {
+                int uusisisennys = maareMats.captured("sisennys").toInt();
+                if( maare == "*")
+                    kr.erittelySisennys = uusisisennys;
+                else
+                    kr.sisennys = uusisisennys;
+            }
+            if( maare == "*")
+            {
+                kr.naytaErittely = true;
+            }
+            else if( maare == "S" || maare == "SUM" || maare == "SUMMA")
+            {
+                kr.naytaTyhjarivi = true;
+            }
+            else if( maare == "H" || maare=="HEADING" || maare == "OTSIKKO")
+            {
+                kr.rivityyppi = KaavanRivi::OTSIKKO;
+                kr.naytaTyhjarivi = true;
+            }
+            else if( maare == "d" || maare == "details" || maare == "erittely")
+                kr.rivityyppi = KaavanRivi::ERITTELY;
+            else if( maare == "h" || maare == "heading" || maare == "otsikko")
+                kr.rivityyppi = KaavanRivi::OTSIKKO;
+            else if( maare == "=")
+                kr.lisaavalisumma = true;
+            else if( maare == "==")
+                kr.laskevalisummaan = false;
+            else if( maare == "bold" || maare == "lihava")
+                kr.lihava = true;
+            else if( maare == "viiva" || maare == "line")
+                kr.viiva = true;
+        }
+
+        // Tilivälit
+        QRegularExpressionMatchIterator ri = tiliRe.globalMatch(loppurivi );
+        while( ri.hasNext())
+        {
+            QRegularExpressionMatch tiliMats = ri.next();
+            KaavanVali vali;
+            vali.alku = Tili::ysiluku( tiliMats.captured("alku").toInt(), false);
+
+            if( !tiliMats.captured("loppu").isEmpty())
+                vali.loppu = Tili::ysiluku(tiliMats.captured("loppu").toInt(), true);
+            else
+                vali.loppu = Tili::ysiluku( tiliMats.captured("alku").toInt(), true);
+            vali.vainTulot = tiliMats.captured("menotulo") == "+";
+            vali.vainMenot = tiliMats.captured("menotulo") == "-";
+            kr.valit.append(vali);
+        }
+
+        rivit_.append(kr);
+    }
+}
+
+RaporttiKaava RaporttiKaava::kaava(const QString &raportinNimi)
+{
+    QString lahde = kp()->asetukset()->asetus("Raportti/" + raportinNimi);
+
+    auto talletettu = kaavat__.constFind(raportinNimi);
+    if( talletettu != kaavat__.constEnd() && talletettu.value().first == lahde)
+        return talletettu.value().second;
+
+    QStringList lista = lahde.isEmpty() ? QStringList() : lahde.split('\n');
+    RaporttiKaava kaava;
+    // Jos raporttia ei ole, jää tyhjä kaava
+    if( lista.length() > 2)
+    {
+        QString optiorivi = lista.takeFirst();
+        kaava = RaporttiKaava(lista);
+        kaava.optiorivi_ = optiorivi;
+    }
+
+    kaavat__.insert(raportinNimi, qMakePair(lahde, kaava));
+
+    return kaava;
+}
+
+
+KaavanSummat::KaavanSummat(const QMap<int, qlonglong> &data, QHash<int, int> *tililajit) :
+    tililajit_(tililajit)
+{
+    ysiluvut_.reserve( data.count() );
+    kertyma_.reserve( data.count() + 1);
+
+    qlonglong kertyma = 0;
+    kertyma_.append(0);
+
+    QMapIterator<int,qlonglong> iter(data);
+    while( iter.hasNext())
+    {
+        iter.next();
+        ysiluvut_.append( iter.key());
+        kertyma += iter.value();
+        kertyma_.append( kertyma );
+    }
+}
+
+qlonglong KaavanSummat::summa(const KaavanVali &vali) const
+{
+    int alku = static_cast<int>( std::lower_bound( ysiluvut_.constBegin(), ysiluvut_.constEnd(), vali.alku) - ysiluvut_.constBegin() );
+    int loppu = static_cast<int>( std::upper_bound( ysiluvut_.constBegin(), ysiluvut_.constEnd(), vali.loppu) - ysiluvut_.constBegin() );
+
+    if( loppu <= alku )
+        return 0;
+
+    if( vali.vainTulot || vali.vainMenot)
+    {
+        laskeLajit();
+        const QVector<qlonglong>& kertyma = vali.vainTulot ? tulot_ : menot_;
+        return kertyma.at(loppu) - kertyma.at(alku);
+    }
+
+    return kertyma_.at(loppu) - kertyma_.at(alku);
+}
+
+void KaavanSummat::laskeLajit() const
+{
+    if( !tulot_.isEmpty())
+        return;
+
+    tulot_.reserve( kertyma_.count() );
+    menot_.reserve( kertyma_.count() );
+    tulot_.append(0);
+    menot_.append(0);
+
+    for( int i=0; i < ysiluvut_.count(); i++)
+    {
+        int ysiluku = ysiluvut_.at(i);
+        int laji = 0;
+        if( tililajit_ && tililajit_->contains(ysiluku))
+            laji = tililajit_->value(ysiluku);
+        else
+        {
+            Tili tili = kp()->tilit()->tiliNumerolla( ysiluku / 10);
+            if( tili.onko(TiliLaji::TULO))
+                laji |= TULO;
+            if( tili.onko(TiliLaji::MENO))
+                laji |= MENO;
+            if( tililajit_ )
+                tililajit_->insert(ysiluku, laji);
+        }
+        qlonglong saldo = kertyma_.at(i+1) - kertyma_.at(i);
+
+        tulot_.append( tulot_.last() + ( laji & TULO ? saldo : 0 ));
+        menot_.append( menot_.last() + ( laji & MENO ? saldo : 0 ));
+    }
+}
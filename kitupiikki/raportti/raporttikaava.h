@@ -0,0 +1,134 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RAPORTTIKAAVA_H
+#define RAPORTTIKAAVA_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+
+/**
+ * @brief Raporttikaavan tilikohta, esim. 300..349+
+ */
+struct KaavanVali
+{
+    int alku = 0;       // ysiluku
+    int loppu = 0;      // ysiluku
+    bool vainTulot = false;
+    bool vainMenot = false;
+};
+
+/**
+ * @brief Raporttikaavan yksi rivi käännettynä
+ */
+struct KaavanRivi
+{
+    enum Tyyppi
+    {
+        TYHJA,          // Tyhjä rivi
+        TEKSTI,         // Pelkkä teksti ilman määreitä
+        KAAVA           // Teksti, määreet ja tilivälit
+    };
+
+    enum RivinTyyppi
+    {
+        SUMMA, OTSIKKO, ERITTELY
+    };
+
+    Tyyppi tyyppi = TYHJA;
+    QString teksti;
+
+    RivinTyyppi rivityyppi = SUMMA;
+    int sisennys = 0;
+    int erittelySisennys = 4;
+    bool naytaTyhjarivi = false;
+    bool laskevalisummaan = true;
+    bool lisaavalisumma = false;
+    bool naytaErittely = false;
+    bool lihava = false;
+    bool viiva = false;
+
+    QList<KaavanVali> valit;
+};
+
+/**
+ * @brief Muokattavan raportin kaava käännettynä
+ *
+ * Raportin määrittely jäsennetään säännöllisillä lausekkeilla vain kerran.
+ * Käännetyt kaavat pidetään tallessa raportin nimellä, ja kaava käännetään
+ * uudelleen, jos raportin asetus on muuttunut.
+ *
+ * @since 1.5
+ */
+class RaporttiKaava
+{
+public:
+    RaporttiKaava();
+    /**
+     * @brief Kääntää kaavan
+     * @param kaava Kaavan rivit ilman optioriviä
+     */
+    RaporttiKaava(const QStringList& kaava);
+
+    /**
+     * @brief Raportin käännetty kaava
+     * @param raportinNimi Asetuksissa oleva raportin nimi
+     * @return Käännetty kaava asetuksista
+     */
+    static RaporttiKaava kaava(const QString& raportinNimi);
+
+    QString optiorivi() const { return optiorivi_; }
+    const QList<KaavanRivi>& rivit() const { return rivit_; }
+
+protected:
+    QString optiorivi_;
+    QList<KaavanRivi> rivit_;
+};
+
+/**
+ * @brief Yhden sarakkeen summat kaavan tiliväleille
+ *
+ * Tilien saldot järjestetään ysiluvun mukaan ja niistä lasketaan
+ * kertymät, jolloin tilivälin summa saadaan kahdella binäärihaulla.
+ */
+class KaavanSummat
+{
+public:
+    /**
+     * @param data ysiluku, sentit
+     * @param tililajit Yhteinen välimuisti ysilukujen tulo- ja menotiedoille
+     */
+    KaavanSummat(const QMap<int,qlonglong>& data = QMap<int,qlonglong>(), QHash<int,int>* tililajit = nullptr);
+
+    qlonglong summa(const KaavanVali& vali) const;
+
+protected:
+    enum { TULO = 1, MENO = 2};
+    void laskeLajit() const;
+
+    QVector<int> ysiluvut_;
+    QVector<qlonglong> kertyma_;
+    mutable QVector<qlonglong> tulot_;
+    mutable QVector<qlonglong> menot_;
+    QHash<int,int>* tililajit_;
+};
+
+#endif // RAPORTTIKAAVA_H
@@ -0,0 +1,82 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RAPORTTIKOHDE_H
+#define RAPORTTIKOHDE_H
+
+#include <QString>
+
+#include "raporttirivi.h"
+
+/**
+ * @brief Kohde, johon raportti kirjoitetaan rivi kerrallaan
+ *
+ * Raportit kirjoittavat otsikon, sarakkeet ja otsakkeet ennen
+ * ensimmäistä riviä, minkä jälkeen rivit lisätään järjestyksessä.
+ * RaportinKirjoittaja tallettaa rivit muistiin esikatselua varten,
+ * RaporttiVirta-kohteet kirjoittavat ne suoraan tiedostoon.
+ *
+ * @since 1.5
+ */
+class RaporttiKohde
+{
+public:
+    virtual ~RaporttiKohde() {}
+
+    virtual void asetaOtsikko(const QString& otsikko) = 0;
+    virtual void asetaKausiteksti(const QString& kausiteksti) = 0;
+
+    /**
+     * @brief Lisää sarakkeen
+     * @param leveysteksti Teksti, jolle sarake mitoitetaan
+     */
+    virtual void lisaaSarake(const QString& leveysteksti, RaporttiRivi::RivinKaytto kaytto = RaporttiRivi::KAIKKI) = 0;
+    /**
+     * @brief Lisää sarakkeen
+     * @param leveysprosentti Sarakkeen leveys on % sivun leveydestä
+     */
+    virtual void lisaaSarake(int leveysprosentti) = 0;
+
+    /**
+     * @brief Lisää venyvän sarakkeen
+     * @param tekija Missä suhteessa jäljellä oleva tila jaetaan
+     */
+    virtual void lisaaVenyvaSarake(int tekija = 100) = 0;
+
+    /**
+     * @brief Lisää euromääräisen sarakkeen
+     */
+    void lisaaEurosarake();
+    /**
+     * @brief Lisää sarakkeen päivämäärälle
+     */
+    void lisaaPvmSarake();
+
+    virtual void lisaaOtsake(const RaporttiRivi &otsikkorivi) = 0;
+    virtual void lisaaRivi(const RaporttiRivi &rivi = RaporttiRivi(RaporttiRivi::EICSV)) = 0;
+
+    /**
+     * @brief Lisää tyhjän rivin jos edellinen ei ollut jo tyhjä
+     */
+    virtual void lisaaTyhjaRivi() = 0;
+
+    /**
+     * @brief Onko raporttiin lisätty yhtään riviä
+     */
+    virtual bool tyhja() const = 0;
+};
+
+#endif // RAPORTTIKOHDE_H
@@ -0,0 +1,57 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "raporttivalimuisti.h"
+#include "db/kirjanpito.h"
+
+bool RaporttiValimuisti::hae(const QString &avain, RaportinKirjoittaja &raportti)
+{
+    // Avaimeen lisätään tiedoston polku, koska eri kirjanpitojen versiot eivät ole vertailukelpoisia.
+    // Välimuisti tyhjennetään lisäksi aina kirjanpitoa avattaessa.
+    QString kokoavain = kp()->tiedostopolku() + '\n' + avain;
+
+    Raportti *talletettu = raportit__.object(kokoavain);
+    if( !talletettu )
+        return false;
+
+    if( kp()->muutokset()->onkoMuuttunut( talletettu->versio, talletettu->alkaa, talletettu->paattyy ))
+    {
+        raportit__.remove(kokoavain);
+        return false;
+    }
+
+    raportti = talletettu->kirjoittaja;
+    return true;
+}
+
+void RaporttiValimuisti::lisaa(const QString &avain, const RaportinKirjoittaja &raportti, const QDate &alkaa, const QDate &paattyy)
+{
+    Raportti *talletettava = new Raportti;
+    talletettava->kirjoittaja = raportti;
+    talletettava->versio = kp()->muutokset()->versio();
+    talletettava->alkaa = alkaa;
+    talletettava->paattyy = paattyy;
+
+    raportit__.insert( kp()->tiedostopolku() + '\n' + avain, talletettava);
+}
+
+void RaporttiValimuisti::tyhjenna()
+{
+    raportit__.clear();
+}
+
+QCache<QString, RaporttiValimuisti::Raportti> RaporttiValimuisti::raportit__(RaporttiValimuisti::MAKSIMI);
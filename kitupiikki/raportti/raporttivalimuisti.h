@@ -0,0 +1,78 @@
+/*
+   Copyright (C) 2017 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RAPORTTIVALIMUISTI_H
+#define RAPORTTIVALIMUISTI_H
+
+#include <QCache>
+#include <QDate>
+#include <QString>
+
+#include "raportinkirjoittaja.h"
+
+/**
+ * @brief Valmiiksi kirjoitettujen raporttien välimuisti
+ *
+ * Raportit talletetaan avaimella, johon kuuluvat raportin tyyppi ja kaikki
+ * sen valinnat. Raportin yhteyteen talletetaan kirjanpidon tietoversio
+ * sekä päivämääräväli, johon raportti perustuu. Raportti kelpaa niin kauan,
+ * kun muutoslokissa ei ole tälle välille osuvia muutoksia. Päätettyjen
+ * tilikausien raportit eivät siis vanhene kirjauksista.
+ *
+ * Välimuistissa on enintään MAKSIMI raporttia, vähiten käytetty poistetaan
+ * ensimmäisenä.
+ *
+ * @since 1.5
+ */
+class RaporttiValimuisti
+{
+public:
+    /**
+     * @brief Hakee raportin välimuistista
+     * @param avain Raportin ja sen valintojen yksilöivä avain
+     * @param raportti Tähän kopioidaan löytynyt raportti
+     * @return tosi, jos ajantasainen raportti löytyi
+     */
+    static bool hae(const QString& avain, RaportinKirjoittaja& raportti);
+
+    /**
+     * @brief Tallentaa raportin välimuistiin
+     * @param avain Raportin ja sen valintojen yksilöivä avain
+     * @param raportti Kirjoitettu raportti
+     * @param alkaa Raportin tietojen alkupäivä (tyhjä, jos alusta saakka)
+     * @param paattyy Raportin tietojen loppupäivä
+     */
+    static void lisaa(const QString& avain, const RaportinKirjoittaja& raportti,
+                      const QDate& alkaa, const QDate& paattyy);
+
+    static void tyhjenna();
+
+    static const int MAKSIMI = 16;
+
+protected:
+    struct Raportti
+    {
+        RaportinKirjoittaja kirjoittaja;
+        qlonglong versio = 0;
+        QDate alkaa;
+        QDate paattyy;
+    };
+
+    static QCache<QString, Raportti> raportit__;
+};
+
+#endif // RAPORTTIVALIMUISTI_H
@@ -0,0 +1,297 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QPdfWriter>
+#include <QPainter>
+#include <QSettings>
+#include <QApplication>
+#include <QStringList>
+
+#include "raporttivirta.h"
+#include "db/kirjanpito.h"
+
+RaporttiVirta::RaporttiVirta(QIODevice *laite)
+    : laite_(laite)
+{
+
+}
+
+void RaporttiVirta::asetaOtsikko(const QString &otsikko)
+{
+    pohja_.asetaOtsikko(otsikko);
+}
+
+void RaporttiVirta::asetaKausiteksti(const QString &kausiteksti)
+{
+    pohja_.asetaKausiteksti(kausiteksti);
+}
+
+void RaporttiVirta::lisaaSarake(const QString &leveysteksti, RaporttiRivi::RivinKaytto kaytto)
+{
+    pohja_.lisaaSarake(leveysteksti, kaytto);
+}
+
+void RaporttiVirta::lisaaSarake(int leveysprosentti)
+{
+    pohja_.lisaaSarake(leveysprosentti);
+}
+
+void RaporttiVirta::lisaaVenyvaSarake(int tekija)
+{
+    pohja_.lisaaVenyvaSarake(tekija);
+}
+
+void RaporttiVirta::lisaaOtsake(const RaporttiRivi &otsikkorivi)
+{
+    pohja_.lisaaOtsake(otsikkorivi);
+}
+
+void RaporttiVirta::lisaaRivi(const RaporttiRivi &rivi)
+{
+    if( !aloitettu_ )
+    {
+        aloita();
+        aloitettu_ = true;
+    }
+    kirjoitaRivi(rivi);
+    riveja_++;
+    edellinenTyhja_ = !rivi.sarakkeita();
+}
+
+void RaporttiVirta::lisaaTyhjaRivi()
+{
+    if( !edellinenTyhja_ )
+        lisaaRivi( RaporttiRivi(RaporttiRivi::EICSV));
+}
+
+void RaporttiVirta::valmis()
+{
+    if( !aloitettu_ )
+    {
+        aloita();
+        aloitettu_ = true;
+    }
+    lopeta();
+}
+
+
+CsvRaporttiVirta::CsvRaporttiVirta(QIODevice *laite)
+    : RaporttiVirta(laite), out_(laite)
+{
+    erotin_ = kp()->settings()->value("CsvErotin", QChar(',')).toChar();
+    latin1_ = kp()->settings()->value("CsvKoodaus").toString() == "latin1";
+    out_.setCodec( latin1_ ? "ISO-8859-1" : "UTF-8");
+}
+
+QString CsvRaporttiVirta::csvRivi(const RaporttiRivi &rivi) const
+{
+    QStringList sarakkeet;
+    for( int i=0; i < rivi.sarakkeita(); i++)
+        sarakkeet.append( rivi.csv(i));
+    QString txt = sarakkeet.join(erotin_);
+
+    if( latin1_ )
+        txt.replace("€","EUR");
+    return txt;
+}
+
+void CsvRaporttiVirta::aloita()
+{
+    for( const RaporttiRivi& otsikko : pohja_.otsakkeet())
+    {
+        if( otsikko.kaytto() == RaporttiRivi::EICSV)
+            continue;
+        out_ << csvRivi( otsikko );
+    }
+}
+
+void CsvRaporttiVirta::kirjoitaRivi(const RaporttiRivi &rivi)
+{
+    if( rivi.kaytto() == RaporttiRivi::EICSV || !rivi.sarakkeita())
+        return;
+
+    out_ << "\r\n" << csvRivi( rivi );
+}
+
+void CsvRaporttiVirta::lopeta()
+{
+    out_.flush();
+}
+
+
+HtmlRaporttiVirta::HtmlRaporttiVirta(QIODevice *laite, bool linkit)
+    : RaporttiVirta(laite), out_(laite), linkit_(linkit)
+{
+    out_.setCodec("UTF-8");
+}
+
+void HtmlRaporttiVirta::lisaaAlkuun(const QString &otsakkeeseen, const QString &runkoon)
+{
+    otsakkeeseen_ = otsakkeeseen;
+    runkoon_ = runkoon;
+}
+
+void HtmlRaporttiVirta::aloita()
+{
+    out_ << "<html><meta charset=\"utf-8\"><title>";
+    out_ << pohja_.otsikko();
+    out_ << "</title>"
+               "<style>"
+               " body { font-family: Helvetica; }"
+               " h1 { font-weight: normal; }"
+               " .lihava { font-weight: bold; } "
+               " tr.viiva td { border-top: 1px solid black; }"
+               " td.oikealle { text-align: right; } "
+               " th { text-align: left; color: darkgray;}"
+               " a { text-decoration: none; color: black; }"
+               " td { padding-right: 2em; }"
+               " td:last-of-type { padding-right: 0; }"
+               " table { border-collapse: collapse;}"
+               " p.tulostettu { margin-top:2em; color: darkgray; }"
+               " span.treeni { color: green; }"
+               "</style>";
+    out_ << otsakkeeseen_ << "</head><body>" << runkoon_;
+
+    out_ << "<h1>" << pohja_.otsikko() << "</h1>";
+    out_ << "<p>" << kp()->asetukset()->asetus("Nimi") << "<br>";
+    out_ << pohja_.kausiteksti() << "</p>";
+    out_ << "<table width=100%><thead>\n";
+
+    // Otsikkorivit
+    for (const RaporttiRivi& otsikkorivi : pohja_.otsakkeet() )
+    {
+        if( otsikkorivi.kaytto() == RaporttiRivi::CSV)
+            continue;
+
+        out_ << "<tr>";
+        for(int i=0; i < otsikkorivi.sarakkeita(); i++)
+        {
+
+            out_ << QString("<th colspan=%1>").arg( otsikkorivi.leveysSaraketta(i));
+            out_ << otsikkorivi.teksti(i);
+            out_ << "</th>";
+        }
+        out_ << "</tr>\n";
+    }
+
+    out_ << "</thead>\n";
+}
+
+void HtmlRaporttiVirta::kirjoitaRivi(const RaporttiRivi &rivi)
+{
+    if( rivi.kaytto() == RaporttiRivi::CSV)
+        return;
+
+    QStringList trluokat;
+    if( rivi.onkoLihava())
+        trluokat << "lihava";
+    if( rivi.onkoViivaa())
+        trluokat << "viiva";
+
+    if( trluokat.isEmpty())
+        out_ << "<tr>";
+    else
+        out_ << "<tr class=\"" + trluokat.join(' ') + "\">";
+
+    if( !rivi.sarakkeita())
+        out_ << "<td>&nbsp;</td>"; // Tyhjätkin rivit näkyviin!
+
+    for(int i=0; i < rivi.sarakkeita(); i++)
+    {
+
+        if( rivi.tasattuOikealle(i) )
+            out_ << QString("<td colspan=%1 class=oikealle>").arg(rivi.leveysSaraketta(i));
+        else
+            out_ << QString("<td colspan=%1>").arg(rivi.leveysSaraketta(i));
+
+        if(linkit_)
+        {
+            if( rivi.sarake(i).linkkityyppi == RaporttiRiviSarake::TOSITE_ID)
+            {
+                // Linkki tositteeseen
+                out_ << QString("<a href=\"%1.html\">").arg( rivi.sarake(i).linkkidata , 8, 10 , QChar('0') );
+            }
+            else if( rivi.sarake(i).linkkityyppi == RaporttiRiviSarake::TILI_NRO)
+            {
+                // Linkki tiliin
+                out_ << QString("<a href=\"paakirja.html#%2\">").arg( rivi.sarake(i).linkkidata);
+            }
+            else if( rivi.sarake(i).linkkityyppi == RaporttiRiviSarake::TILI_LINKKI)
+            {
+                // Nimiö dataan
+                out_ << QString("<a name=\"%1\">").arg( rivi.sarake(i).linkkidata);
+            }
+        }
+        QString tekstia = rivi.teksti(i);
+        tekstia.replace(' ', "&nbsp;");
+        tekstia.replace('\n', "<br>");
+
+        out_ << tekstia;
+
+        if( linkit_ && rivi.sarake(i).linkkityyppi )
+            out_ << "</a>";
+
+        out_ << "&nbsp;</td>";
+    }
+    out_ << "</tr>\n";
+}
+
+void HtmlRaporttiVirta::lopeta()
+{
+    out_ << "</table>";
+    out_ << "<p class=tulostettu>Tulostettu " << QDate::currentDate().toString("dd.MM.yyyy");
+    if( kp()->onkoHarjoitus())
+        out_ << "<br><span class=treeni>Kirjanpito on laadittu Kitupiikki-ohjelman harjoittelutilassa</span>";
+
+    out_ << "</p></body></html>\n";
+    out_.flush();
+}
+
+
+PdfRaporttiVirta::PdfRaporttiVirta(QIODevice *laite, bool taustaraidat, bool kaytaA4)
+    : RaporttiVirta(laite), writer_( new QPdfWriter(laite) ), taustaraidat_(taustaraidat)
+{
+    writer_->setCreator( QString("Kitupiikki %1").arg( qApp->applicationVersion() ) );
+
+    if( kaytaA4 )
+        writer_->setPageSize( QPdfWriter::A4 );
+    else
+        writer_->setPageLayout( kp()->printer()->pageLayout() );
+}
+
+PdfRaporttiVirta::~PdfRaporttiVirta()
+{
+
+}
+
+void PdfRaporttiVirta::aloita()
+{
+    writer_->setTitle( pohja_.otsikko() );
+    painter_.reset( new QPainter( writer_.data() ));
+    sivuttaja_.reset( new RaportinKirjoittaja::Sivuttaja( pohja_, writer_.data(), painter_.data(), taustaraidat_, 1) );
+}
+
+void PdfRaporttiVirta::kirjoitaRivi(const RaporttiRivi &rivi)
+{
+    sivuttaja_->tulosta( rivi );
+}
+
+void PdfRaporttiVirta::lopeta()
+{
+    sivuttaja_->lopeta();
+    painter_->end();
+}
@@ -0,0 +1,162 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef RAPORTTIVIRTA_H
+#define RAPORTTIVIRTA_H
+
+#include <QTextStream>
+#include <QScopedPointer>
+
+#include "raporttikohde.h"
+#include "raportinkirjoittaja.h"
+
+class QIODevice;
+class QPainter;
+class QPdfWriter;
+
+/**
+ * @brief Raportin kirjoittaminen suoraan laitteelle
+ *
+ * Muistiin talletetaan vain otsikko, sarakkeet ja otsakkeet. Rivit
+ * kirjoitetaan laitteelle sitä mukaa kun raportti lisää niitä, joten
+ * suurenkin raportin vienti vie vakiomäärän muistia.
+ *
+ * Otsakkeet ja sarakkeet on lisättävä ennen ensimmäistä riviä, ja
+ * lopuksi on kutsuttava valmis().
+ *
+ * @since 1.5
+ */
+class RaporttiVirta : public RaporttiKohde
+{
+public:
+    RaporttiVirta(QIODevice *laite);
+
+    void asetaOtsikko(const QString& otsikko) override;
+    void asetaKausiteksti(const QString& kausiteksti) override;
+
+    void lisaaSarake(const QString& leveysteksti, RaporttiRivi::RivinKaytto kaytto = RaporttiRivi::KAIKKI) override;
+    void lisaaSarake(int leveysprosentti) override;
+    void lisaaVenyvaSarake(int tekija = 100) override;
+
+    void lisaaOtsake(const RaporttiRivi &otsikkorivi) override;
+    void lisaaRivi(const RaporttiRivi &rivi = RaporttiRivi(RaporttiRivi::EICSV)) override;
+    void lisaaTyhjaRivi() override;
+
+    bool tyhja() const override { return !riveja_; }
+
+    /**
+     * @brief Kirjoittaa raportin lopun laitteelle
+     */
+    void valmis();
+
+protected:
+    /**
+     * @brief Kirjoittaa raportin alun ennen ensimmäistä riviä
+     */
+    virtual void aloita() = 0;
+    virtual void kirjoitaRivi(const RaporttiRivi& rivi) = 0;
+    virtual void lopeta() = 0;
+
+    QIODevice *laite_;
+    RaportinKirjoittaja pohja_;      ///< Otsikko, sarakkeet ja otsakkeet
+
+private:
+    bool aloitettu_ = false;
+    int riveja_ = 0;
+    bool edellinenTyhja_ = true;
+};
+
+/**
+ * @brief Raportin kirjoittaminen csv-muodossa
+ *
+ * Erotin ja merkistö ovat asetuksista.
+ */
+class CsvRaporttiVirta : public RaporttiVirta
+{
+public:
+    CsvRaporttiVirta(QIODevice *laite);
+
+    /**
+     * @brief Rivin sarakkeet csv-muodossa ilman rivinvaihtoa
+     */
+    QString csvRivi(const RaporttiRivi& rivi) const;
+
+protected:
+    void aloita() override;
+    void kirjoitaRivi(const RaporttiRivi& rivi) override;
+    void lopeta() override;
+
+    QTextStream out_;
+    QChar erotin_;
+    bool latin1_;
+};
+
+/**
+ * @brief Raportin kirjoittaminen html-muodossa
+ */
+class HtmlRaporttiVirta : public RaporttiVirta
+{
+public:
+    /**
+     * @param linkit Kirjoitetaanko arkiston linkit
+     */
+    HtmlRaporttiVirta(QIODevice *laite, bool linkit = false);
+
+    /**
+     * @brief Lisää tekstiä sivun alkuun, esimerkiksi arkiston tyylit ja navigointipalkin
+     * @param otsakkeeseen Lisätään ennen </head>
+     * @param runkoon Lisätään heti <body>:n jälkeen
+     */
+    void lisaaAlkuun(const QString& otsakkeeseen, const QString& runkoon);
+
+protected:
+    void aloita() override;
+    void kirjoitaRivi(const RaporttiRivi& rivi) override;
+    void lopeta() override;
+
+    QTextStream out_;
+    bool linkit_;
+    QString otsakkeeseen_;
+    QString runkoon_;
+};
+
+/**
+ * @brief Raportin kirjoittaminen sivutettuna pdf:nä
+ *
+ * Rivit asetellaan ja piirretään sivulle sitä mukaa kun niitä lisätään.
+ */
+class PdfRaporttiVirta : public RaporttiVirta
+{
+public:
+    /**
+     * @param taustaraidat Tulosta taustaraidat
+     * @param kaytaA4 Tulostaa asetuksista riippumatta A4
+     */
+    PdfRaporttiVirta(QIODevice *laite, bool taustaraidat = false, bool kaytaA4 = false);
+    ~PdfRaporttiVirta() override;
+
+protected:
+    void aloita() override;
+    void kirjoitaRivi(const RaporttiRivi& rivi) override;
+    void lopeta() override;
+
+    QScopedPointer<QPdfWriter> writer_;
+    QScopedPointer<QPainter> painter_;
+    QScopedPointer<RaportinKirjoittaja::Sivuttaja> sivuttaja_;
+    bool taustaraidat_;
+};
+
+#endif // RAPORTTIVIRTA_H
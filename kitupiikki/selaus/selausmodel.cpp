@@ -72,7 +72,7 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
     if( !index.isValid())
         return QVariant();
 
-    SelausRivi rivi = rivit.at( index.row());
+    const SelausRivi& rivi = rivit.at( index.row());
 
     if( role == Qt::DisplayRole || role == Qt::EditRole)
     {
@@ -80,25 +80,26 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
         switch (index.column())
         {
             case TOSITE:
-                if( role == Qt::EditRole)
-                    return rivi.lajiteltavaTositetunniste;
-                return QVariant( rivi.tositetunniste);
+                return tositetunniste(rivi, role == Qt::EditRole);
 
             case PVM:
                 if( role == Qt::DisplayRole)
-                    return QVariant( rivi.pvm );
+                    return QVariant( QDate::fromJulianDay(rivi.pvm) );
                 else
                     return QString("%1 %2")
-                            .arg(rivi.pvm.toString(Qt::ISODate))
+                            .arg(QDate::fromJulianDay(rivi.pvm).toString(Qt::ISODate))
                             .arg(rivi.vientiId, 8, 10, QChar('0') );
 
             case TILI:
+            {
+                const Tili& tili = tilit_.value( rivi.tiliId );
                 if( role == Qt::EditRole)
-                    return rivi.tili.numero();
-                else if( rivi.tili.numero())
-                    return QVariant( QString("%1 %2").arg(rivi.tili.numero()).arg(rivi.tili.nimi()) );
+                    return tili.numero();
+                else if( tili.numero())
+                    return QVariant( QString("%1 %2").arg(tili.numero()).arg(tili.nimi()) );
                 else
                     return QVariant();
+            }
 
             case DEBET:
                 if( role == Qt::EditRole)
@@ -116,26 +117,27 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
                 else
                     return QVariant();
 
-            case SELITE: return QVariant( rivi.selite );
+            case SELITE: return QVariant( merkkijono(rivi.selite) );
 
             case KOHDENNUS :
                 QString txt;
 
-                if( rivi.kohdennus.tyyppi() != Kohdennus::EIKOHDENNETA)
-                    txt = rivi.kohdennus.nimi();
+                const Kohdennus& kohdennus = kohdennukset_.value( rivi.kohdennusId );
+                if( kohdennus.tyyppi() != Kohdennus::EIKOHDENNETA)
+                    txt = kohdennus.nimi();
 
-                if( rivi.taseEra.eraId && rivi.taseEra.eraId != rivi.vientiId)
+                if( rivi.eraTunniste > -1)
                 {
                     if( !txt.isEmpty())
                         txt.append(" \n");
-                    txt.append( rivi.taseEra.tositteenTunniste() );
+                    txt.append( merkkijono(rivi.eraTunniste) );
                 }
 
-                if( rivi.tagit.count())
+                if( rivi.tagit > -1)
                 {
                     if( !txt.isEmpty())
                         txt.append(" \n");
-                    txt.append(  rivi.tagit.join(", ") );
+                    txt.append( merkkijono(rivi.tagit) );
                 }
                 return txt;
 
@@ -158,7 +160,7 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
     {
         if( rivi.eraMaksettu)
             return QIcon(":/pic/ok.png");
-        return rivi.kohdennus.tyyppiKuvake();
+        return kohdennukset_.value( rivi.kohdennusId ).tyyppiKuvake();
     }
     else if( role == Qt::DecorationRole && index.column() == TOSITE)
     {
@@ -174,83 +176,158 @@ QVariant SelausModel::data(const QModelIndex &index, int role) const
 
 void SelausModel::lataa(const QDate &alkaa, const QDate &loppuu)
 {
+    QString vali = QString("BETWEEN \"%1\" AND \"%2\"")
+            .arg( alkaa.toString(Qt::ISODate ) )
+            .arg( loppuu.toString(Qt::ISODate));
+
     QString kysymys = QString("SELECT vienti.tosite, vienti.pvm, tili, debetsnt, kreditsnt, selite, kohdennus, eraid, "
                               "tosite.laji, tosite.tunniste, vienti.id, liite.id "
                               "FROM vienti, tosite LEFT OUTER JOIN liite ON tosite.id=liite.tosite "
-                              "WHERE vienti.pvm BETWEEN \"%1\" AND \"%2\" "
+                              "WHERE vienti.pvm %1 "
                               "AND vienti.tosite=tosite.id AND tili is not null ORDER BY vienti.pvm, vienti.id")
-                              .arg( alkaa.toString(Qt::ISODate ) )
-                              .arg( loppuu.toString(Qt::ISODate)) ;
+                              .arg( vali ) ;
 
     beginResetModel();
     rivit.clear();
     tileilla.clear();
+    merkkijonot_.clear();
+    tilit_.clear();
+    kohdennukset_.clear();
+    lajitunnukset_.clear();
+
+    // Samat selitteet ja tunnukset toistuvat, joten ne talletetaan vain kerran
+    QHash<QString,int> varasto;
+    auto varastoi = [this, &varasto] (const QString& teksti) -> int {
+        if( teksti.isEmpty())
+            return -1;
+        int indeksi = varasto.value(teksti, -1);
+        if( indeksi < 0)
+        {
+            indeksi = merkkijonot_.count();
+            merkkijonot_.append(teksti);
+            varasto.insert(teksti, indeksi);
+        }
+        return indeksi;
+    };
+
+    QSqlQuery query;
+
+    // Merkkaukset haetaan yhdellä kyselyllä koko jaksolle
+    QHash<int,QStringList> tagit;
+    query.exec(QString("SELECT merkkaus.vienti, merkkaus.kohdennus FROM merkkaus, vienti "
+                       "WHERE merkkaus.vienti=vienti.id AND vienti.pvm %1").arg(vali));
+    while( query.next())
+        tagit[ query.value(0).toInt() ].append( kp()->kohdennukset()->kohdennus( query.value(1).toInt() ).nimi() );
+
+    // Samoin jaksolla viitattujen tase-erien saldot ja tositetunnisteet
+    QHash<int,qlonglong> eraSaldot;
+    query.exec(QString("SELECT id, saldosnt FROM era WHERE id IN "
+                       "(SELECT DISTINCT eraid FROM vienti WHERE pvm %1)").arg(vali));
+    while( query.next())
+        eraSaldot.insert( query.value(0).toInt(), query.value(1).toLongLong() );
+
+    QHash<int,QString> eraTunnisteet;
+    query.exec(QString("SELECT vienti.id, tositelaji.tunnus, tosite.tunniste, vienti.pvm FROM vienti, tosite, tositelaji "
+                       "WHERE vienti.tosite=tosite.id AND tosite.laji=tositelaji.id AND vienti.id IN "
+                       "(SELECT DISTINCT eraid FROM vienti WHERE pvm %1)").arg(vali));
+    while( query.next())
+        eraTunnisteet.insert( query.value(0).toInt(), QString("%1%2/%3").arg( query.value(1).toString() )
+                              .arg( query.value(2).toInt())
+                              .arg( kp()->tilikaudet()->tilikausiPaivalle( query.value(3).toDate() ).kausitunnus() ));
+
+    bool samaanSarjaan = kp()->asetukset()->onko("Samaansarjaan");
+    Tilikausi kausi;
+    int kausiIndeksi = -1;
 
     int edellinenVientiId = -1;
 
-    QSqlQuery query;
     query.exec(kysymys);
     while( query.next())
     {
-        if( query.value("vienti.id").toInt() == edellinenVientiId)
+        if( query.value(10).toInt() == edellinenVientiId)
             continue;
 
         SelausRivi rivi;
+        QDate pvm = query.value(1).toDate();
         rivi.tositeId = query.value(0).toInt();
-        rivi.pvm = query.value(1).toDate();
-        rivi.tili = kp()->tilit()->tiliIdlla( query.value(2).toInt());
+        rivi.pvm = pvm.toJulianDay();
+        rivi.tiliId = query.value(2).toInt();
         rivi.debetSnt = query.value(3).toLongLong();
         rivi.kreditSnt = query.value(4).toLongLong();
-        rivi.selite = query.value(5).toString();
-        rivi.kohdennus = kp()->kohdennukset()->kohdennus( query.value(6).toInt());
-        rivi.taseEra = TaseEra( query.value(7).toInt());
-        if( kp()->asetukset()->onko("Samaansarjaan"))
+        rivi.selite = varastoi( query.value(5).toString() );
+        rivi.kohdennusId = query.value(6).toInt();
+        rivi.tositelaji = samaanSarjaan ? -1 : query.value(8).toInt();
+        rivi.tunniste = query.value(9).toInt();
+        rivi.vientiId = query.value(10).toInt();
+        rivi.liitteita = !query.value(11).isNull();
+
+        // Rivit ovat päivämääräjärjestyksessä, joten tilikausi vaihtuu harvoin
+        if( kausiIndeksi < 0 || pvm < kausi.alkaa() || pvm > kausi.paattyy())
         {
-            rivi.tositetunniste = QString("%1/%2")
-                                           .arg( query.value(9).toInt()  )
-                                           .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
-
-            rivi.lajiteltavaTositetunniste = QString("%1/%2")
-                                           .arg( query.value(9).toInt(),8,10,QChar('0'))
-                                           .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
-        } else {
-            rivi.tositetunniste = QString("%1 %2/%3")
-                                           .arg( kp()->tositelajit()->tositelaji( query.value(8).toInt()  ).tunnus() )
-                                           .arg( query.value(9).toInt()  )
-                                           .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
-
-            rivi.lajiteltavaTositetunniste = QString("%1%2/%3")
-                                       .arg( kp()->tositelajit()->tositelaji( query.value(8).toInt()  ).tunnus() )
-                                       .arg( query.value(9).toInt(),8,10,QChar('0'))
-                                       .arg( kp()->tilikaudet()->tilikausiPaivalle(rivi.pvm).kausitunnus() );
+            kausi = kp()->tilikaudet()->tilikausiPaivalle(pvm);
+            kausiIndeksi = varastoi( kausi.kausitunnus() );
         }
+        rivi.kausi = kausiIndeksi;
 
-        rivi.vientiId = query.value("vienti.id").toInt();
-        rivi.liitteita = !query.value("liite.id").isNull();
+        if( !tilit_.contains(rivi.tiliId))
+        {
+            Tili tili = kp()->tilit()->tiliIdlla( rivi.tiliId );
+            tilit_.insert( rivi.tiliId, tili);
+            tileilla.append( QString("%1 %2").arg(tili.numero()).arg(tili.nimi()));
+        }
+        if( !kohdennukset_.contains(rivi.kohdennusId))
+            kohdennukset_.insert( rivi.kohdennusId, kp()->kohdennukset()->kohdennus( rivi.kohdennusId ));
+        if( !samaanSarjaan && !lajitunnukset_.contains(rivi.tositelaji))
+            lajitunnukset_.insert( rivi.tositelaji, kp()->tositelajit()->tositelaji( rivi.tositelaji ).tunnus() );
 
         edellinenVientiId = rivi.vientiId;
 
-        if( query.value("eraid").toInt() && rivi.tili.eritellaankoTase() )
-        {
-            TaseEra era( query.value("eraid").toInt() );
-            rivi.eraMaksettu = era.saldoSnt == 0 ;
-        }
+        int eraId = query.value(7).toInt();
+        if( eraId && eraId != rivi.vientiId )
+            rivi.eraTunniste = varastoi( eraTunnisteet.value(eraId) );
 
-        QSqlQuery tagikysely( QString("SELECT kohdennus FROM merkkaus WHERE vienti=%1").arg( query.value("vienti.id").toInt() ));
-        while( tagikysely.next())
-        {
-            rivi.tagit.append( kp()->kohdennukset()->kohdennus( tagikysely.value(0).toInt() ).nimi() );
-        }
+        if( eraId && tilit_.value(rivi.tiliId).eritellaankoTase() )
+            rivi.eraMaksettu = eraSaldot.value(eraId) == 0 ;
 
-        rivit.append(rivi);
+        if( tagit.contains( rivi.vientiId ))
+            rivi.tagit = varastoi( tagit.value( rivi.vientiId ).join(", ") );
 
-        QString tilistr = QString("%1 %2")
-                    .arg(rivi.tili.numero())
-                    .arg(rivi.tili.nimi());
-        if( !tileilla.contains(tilistr))
-            tileilla.append(tilistr);
+        rivit.append(rivi);
     }
 
+    rivit.squeeze();
+    tileilla.removeDuplicates();
     tileilla.sort();
     endResetModel();
 }
+
+QString SelausModel::merkkijono(int indeksi) const
+{
+    if( indeksi < 0)
+        return QString();
+    return merkkijonot_.at(indeksi);
+}
+
+QString SelausModel::tositetunniste(const SelausRivi &rivi, bool lajiteltava) const
+{
+    if( lajiteltava )
+    {
+        if( rivi.tositelaji > -1 )
+            return QString("%1%2/%3")
+                    .arg( lajitunnukset_.value(rivi.tositelaji))
+                    .arg( rivi.tunniste, 8, 10, QChar('0'))
+                    .arg( merkkijono(rivi.kausi) );
+        return QString("%1/%2")
+                .arg( rivi.tunniste, 8, 10, QChar('0'))
+                .arg( merkkijono(rivi.kausi) );
+    }
+
+    if( rivi.tositelaji > -1 )
+        return QString("%1 %2/%3")
+                .arg( lajitunnukset_.value(rivi.tositelaji))
+                .arg( rivi.tunniste )
+                .arg( merkkijono(rivi.kausi) );
+    return QString("%1/%2")
+            .arg( rivi.tunniste )
+            .arg( merkkijono(rivi.kausi) );
+}
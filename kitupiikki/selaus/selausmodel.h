@@ -19,32 +19,36 @@
 #define SELAUSMODEL_H
 
 #include <QAbstractTableModel>
-#include <QList>
+#include <QVector>
+#include <QHash>
 #include <QDate>
 
 #include "db/tili.h"
 #include "db/kohdennus.h"
-#include "db/eranvalintamodel.h"
 
 /**
  * @brief SelausModel:in yhden rivin (viennin) tiedot
+ *
+ * Rivi sisältää vain tunnisteita, summia ja merkkijonovaraston
+ * indeksejä. Näytettävät tekstit muodostetaan data()-funktiossa
+ * modelin hakutaulujen avulla.
  */
 struct SelausRivi
 {
-    int tositeId;
-    QDate pvm;
-    Tili tili;
-    Kohdennus kohdennus;
-
-    QString selite;
-    qlonglong debetSnt;
-    qlonglong kreditSnt;
-    TaseEra taseEra;
-    QString tositetunniste;
-    QString lajiteltavaTositetunniste;
-    QStringList tagit;
+    int tositeId = 0;
+    int vientiId = 0;
+    qint64 pvm = 0;             ///< Juliaaninen päivänumero
+    int tiliId = 0;
+    int kohdennusId = 0;
+    int tositelaji = -1;        ///< -1, jos kaikki tositteet samassa sarjassa
+    int tunniste = 0;
+    int kausi = -1;             ///< Kausitunnus merkkijonovarastossa
+    int selite = -1;            ///< Selite merkkijonovarastossa
+    int eraTunniste = -1;       ///< Tase-erän tositetunniste merkkijonovarastossa
+    int tagit = -1;             ///< Merkkaukset merkkijonovarastossa
+    qlonglong debetSnt = 0;
+    qlonglong kreditSnt = 0;
     bool eraMaksettu = false;
-    int vientiId;
     bool liitteita = false;
 };
 
@@ -75,9 +79,17 @@ public slots:
     void lataa(const QDate& alkaa, const QDate& loppuu);
 
 protected:
-    QList<SelausRivi> rivit;
+    QString merkkijono(int indeksi) const;
+    QString tositetunniste(const SelausRivi& rivi, bool lajiteltava) const;
+
+    QVector<SelausRivi> rivit;
     QStringList tileilla;
 
+    QStringList merkkijonot_;
+    QHash<int, Tili> tilit_;
+    QHash<int, Kohdennus> kohdennukset_;
+    QHash<int, QString> lajitunnukset_;
+
 };
 
 #endif // SELAUSMODEL_H
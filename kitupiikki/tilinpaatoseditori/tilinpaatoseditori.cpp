@@ -50,7 +50,7 @@ void TilinpaatosEditori::tulosta(QPagedPaintDevice *printer) const
 {
     QString teksti = raportit_ + "\n" + editori_->toHtml();
 
-    TilinpaatosTulostaja::tulostaTilinpaatos( printer, tilikausi_, teksti);
+    TilinpaatosTulostaja::tulostaTilinpaatos( printer, tilikausi_, teksti, editori_);
 }
 
 QString TilinpaatosEditori::otsikko() const
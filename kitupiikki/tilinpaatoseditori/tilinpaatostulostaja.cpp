@@ -30,6 +30,7 @@
 
 #include <QDebug>
 #include <QApplication>
+#include <QProgressDialog>
 
 #include "tilinpaatostulostaja.h"
 #include "db/kirjanpito.h"
@@ -38,8 +39,17 @@
 
 #include <cmath>
 
-void TilinpaatosTulostaja::tulostaTilinpaatos(QPagedPaintDevice *writer, Tilikausi tilikausi, const QString& teksti)
+void TilinpaatosTulostaja::tulostaTilinpaatos(QPagedPaintDevice *writer, Tilikausi tilikausi, const QString& teksti, QWidget *parent)
 {
+    // Raportit kirjoitetaan ensin kaikki valmiiksi, ja vasta sitten
+    // tulostetaan sivut järjestyksessä
+    QString ekarivi = teksti.left( teksti.indexOf('\n') );
+
+    QProgressDialog odota(kp()->tr("Muodostetaan tilinpäätöstä"), QString(), 0, 100, parent);
+    odota.setWindowModality(Qt::WindowModal);
+    odota.setMinimumDuration(250);
+
+    QList<RaportinKirjoittaja> raportit = kirjoitaRaportit(tilikausi, ekarivi, &odota);
 
     writer->setPageSize( QPdfWriter::A4);
 
@@ -49,6 +59,55 @@ void TilinpaatosTulostaja::tulostaTilinpaatos(QPagedPaintDevice *writer, Tilikau
     tulostaKansilehti( tilikausi, &painter);
     int sivulla = 1;
 
+    for( const RaportinKirjoittaja& kirjoittaja : raportit)
+    {
+        writer->newPage();
+        sivulla += kirjoittaja.tulosta(writer, &painter, false, sivulla);
+        odota.setValue( odota.value() + 1);
+    }
+
+    // Liitetiedot, allekirjoitukset yms
+    painter.setFont( QFont("FreeSans",10));
+    int rivinkorkeus = painter.fontMetrics().height();
+    RaportinKirjoittaja kirjoittaja;
+    kirjoittaja.asetaOtsikko("TILINPÄÄTÖS");
+    kirjoittaja.asetaKausiteksti( tilikausi.kausivaliTekstina());
+
+    QTextDocument doc;
+    // Sivutetaan niin, että ylätunniste mahtuu    
+
+    QSizeF sivunkoko( painter.viewport().width()  ,  painter.viewport().height() - rivinkorkeus * 4 );
+
+    doc.documentLayout()->setPaintDevice( painter.device() );
+    doc.setPageSize( sivunkoko );
+    doc.setHtml( teksti.mid(teksti.indexOf('\n')+1) );
+
+
+    int pages = qRound(std::ceil( doc.size().height() / sivunkoko.height()  ));
+    for( int i=0; i < pages; i++)
+    {
+        writer->newPage();
+        painter.save();
+        kirjoittaja.tulostaYlatunniste( &painter, sivulla);
+        painter.drawLine(0,0,qRound(sivunkoko.width()),0);
+        painter.translate(0, rivinkorkeus );
+
+        painter.translate(0, 0 - i * sivunkoko.height() );
+
+        doc.drawContents( &painter, QRectF(0, i * sivunkoko.height(),
+                                           doc.textWidth(), sivunkoko.height() ) );
+        painter.restore();
+        sivulla++;
+    }
+    painter.end();
+
+    odota.setValue( odota.maximum() );
+}
+
+QList<RaportinKirjoittaja> TilinpaatosTulostaja::kirjoitaRaportit(Tilikausi tilikausi, const QString &ekarivi, QProgressDialog *odota)
+{
+    QList<RaportinKirjoittaja> raportit;
+
     // Vertailutietoja varten
     Tilikausi edellinenKausi = kp()->tilikaudet()->tilikausiPaivalle( tilikausi.alkaa().addDays(-1) );
 
@@ -56,9 +115,21 @@ void TilinpaatosTulostaja::tulostaTilinpaatos(QPagedPaintDevice *writer, Tilikau
     // Haetaan luetteloon merkityt raportit
     // Raportit on määritelty ensimmäisellä rivillä muodossa @Raportin nimi!Tulostettava otsikko@
     // Erittelyraportti puolestaan @Raportin nimi*Tulostettava otsikko@
-    QString ekarivi = teksti.left( teksti.indexOf('\n') );
     QRegularExpression raporttiRe("@(?<raportti>.+?)(?<vertailu>\\$?)(?<erotin>[\\*!])(?<otsikko>.+?)@");
     raporttiRe.setPatternOptions(QRegularExpression::UseUnicodePropertiesOption);
+
+    // Edistyminen: raporttien kirjoittaminen, niiden tulostaminen ja liitetiedot
+    // Raportit lasketaan samoin kuin ne käydään läpi, koska QString::count
+    // laskisi myös päällekkäiset osumat
+    int raportteja = 0;
+    QRegularExpressionMatchIterator laskuri = raporttiRe.globalMatch(ekarivi);
+    while( laskuri.hasNext())
+    {
+        laskuri.next();
+        raportteja++;
+    }
+    odota->setMaximum( raportteja * 2 + 1);
+
     QRegularExpressionMatchIterator iter = raporttiRe.globalMatch(ekarivi);
     while( iter.hasNext() )
     {
@@ -66,6 +137,8 @@ void TilinpaatosTulostaja::tulostaTilinpaatos(QPagedPaintDevice *writer, Tilikau
         QString raporttiNimi = mats.captured("raportti");
         QString otsikko = mats.captured("otsikko");
 
+        odota->setValue( odota->value() + 1);
+
         Raportoija raportoija(raporttiNimi);
         if( raportoija.onkoKausiraportti() )
         {
@@ -78,7 +151,10 @@ void TilinpaatosTulostaja::tulostaTilinpaatos(QPagedPaintDevice *writer, Tilikau
             else
             {
                 if( !tilikausi.onkoBudjettia())
+                {
+                    odota->setMaximum( odota->maximum() - 1);
                     continue;   // Ei budjettivertailua, jos ei budjettia!
+                }
 
                 // Budjettivertailu
                 raportoija.lisaaKausi( tilikausi.alkaa(), tilikausi.paattyy(), Raportoija::TOTEUTUNUT);
@@ -99,49 +175,12 @@ void TilinpaatosTulostaja::tulostaTilinpaatos(QPagedPaintDevice *writer, Tilikau
 
         }
 
-        writer->newPage();
-
         RaportinKirjoittaja kirjoittaja = raportoija.raportti( mats.captured("erotin") == "*" );
         kirjoittaja.asetaOtsikko( otsikko );
         kirjoittaja.asetaKausiteksti( tilikausi.kausivaliTekstina() );
-        sivulla += kirjoittaja.tulosta(writer, &painter, false, sivulla);
-    }
-
-    // Liitetiedot, allekirjoitukset yms
-    painter.setFont( QFont("FreeSans",10));
-    int rivinkorkeus = painter.fontMetrics().height();
-    RaportinKirjoittaja kirjoittaja;
-    kirjoittaja.asetaOtsikko("TILINPÄÄTÖS");
-    kirjoittaja.asetaKausiteksti( tilikausi.kausivaliTekstina());
-
-    QTextDocument doc;
-    // Sivutetaan niin, että ylätunniste mahtuu    
-
-    QSizeF sivunkoko( painter.viewport().width()  ,  painter.viewport().height() - rivinkorkeus * 4 );
-
-    doc.documentLayout()->setPaintDevice( painter.device() );
-    doc.setPageSize( sivunkoko );
-    doc.setHtml( teksti.mid(teksti.indexOf('\n')+1) );
-
-
-    int pages = qRound(std::ceil( doc.size().height() / sivunkoko.height()  ));
-    for( int i=0; i < pages; i++)
-    {
-        writer->newPage();
-        painter.save();
-        kirjoittaja.tulostaYlatunniste( &painter, sivulla);
-        painter.drawLine(0,0,qRound(sivunkoko.width()),0);
-        painter.translate(0, rivinkorkeus );
-
-        painter.translate(0, 0 - i * sivunkoko.height() );
-
-        doc.drawContents( &painter, QRectF(0, i * sivunkoko.height(),
-                                           doc.textWidth(), sivunkoko.height() ) );
-        painter.restore();
-        sivulla++;
+        raportit.append(kirjoittaja);
     }
-    painter.end();
-
+    return raportit;
 }
 
 void TilinpaatosTulostaja::tulostaKansilehti(Tilikausi tilikausi, QPainter *painter)
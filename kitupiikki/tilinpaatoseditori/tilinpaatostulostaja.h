@@ -21,6 +21,10 @@
 #include <QTextDocument>
 #include <QPagedPaintDevice>
 #include "db/tilikausi.h"
+#include "raportti/raportinkirjoittaja.h"
+
+class QProgressDialog;
+class QWidget;
 
 /**
  * @brief Tilinpäätöksen tulostus
@@ -29,10 +33,20 @@ class TilinpaatosTulostaja
 {
 public:
 
-    static void tulostaTilinpaatos(QPagedPaintDevice* writer,Tilikausi tilikausi, const QString &teksti);
+    /**
+     * @param parent Ikkuna, jonka päällä edistyminen näytetään
+     */
+    static void tulostaTilinpaatos(QPagedPaintDevice* writer,Tilikausi tilikausi, const QString &teksti, QWidget *parent = nullptr);
 private:
     static void tulostaKansilehti(Tilikausi tilikausi, QPainter *painter);
 
+    /**
+     * @brief Kirjoittaa ensimmäisellä rivillä luetellut raportit
+     * @param ekarivi Tilinpäätöksen ensimmäinen rivi raporttien määrittelyineen
+     * @param odota Edistymisen näyttävä dialogi
+     */
+    static QList<RaportinKirjoittaja> kirjoitaRaportit(Tilikausi tilikausi, const QString& ekarivi, QProgressDialog *odota);
+
 };
 
 #endif // TILINPAATOSTULOSTAJA_H
@@ -34,6 +34,7 @@
 #include "db/eranvalintamodel.h"
 #include "laskutus/laskumodel.h"
 #include "kirjaus/ehdotusmodel.h"
+#include "db/kirjausehdotukset.h"
 
 Tuonti::Tuonti(KirjausWg *wg)
     :  kirjausWg_(wg)
@@ -314,6 +315,19 @@ void Tuonti::oterivi(QDate pvm, qlonglong sentit, const QString& iban, QString v
         }
     }
 
+    // Tunnistamattomalle riville ehdotetaan tiliä, jolle samanlainen selite on aiemmin kirjattu.
+    // Tase-eriä käyttäviä tilejä ei ehdoteta, koska erä on valittava itse.
+    if( !vastarivi.tili.onkoValidi() && !selite.isEmpty())
+    {
+        KirjausEhdotukset::Ehdotus ehdotus = KirjausEhdotukset::ehdota(selite, sentit < 0, tiliotetili().id());
+        Tili ehdotettu = kp()->tilit()->tiliIdlla( ehdotus.tiliId );
+        if( ehdotus.kertoja && ehdotettu.onkoValidi() && !ehdotettu.eritellaankoTase())
+        {
+            vastarivi.tili = ehdotettu;
+            vastarivi.kohdennus = kp()->kohdennukset()->kohdennus( ehdotus.kohdennusId );
+        }
+    }
+
     VientiRivi rivi;
     rivi.pvm = pvm;
     rivi.tili = tiliotetili();
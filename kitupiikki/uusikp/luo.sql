@@ -146,6 +146,49 @@ CREATE TABLE merkkaus (
 CREATE INDEX merkkaus_vienti ON merkkaus(vienti);
 CREATE INDEX merkkaus_kohdennus ON merkkaus(kohdennus);
 
+CREATE TABLE muutos (
+    id              INTEGER PRIMARY KEY AUTOINCREMENT,
+    taulu           VARCHAR(20) NOT NULL,
+    rivi            INTEGER,
+    alkaa           DATE,
+    paattyy         DATE,
+    tilit           TEXT
+);
+
+CREATE TABLE laskurivi (
+    id              INTEGER PRIMARY KEY AUTOINCREMENT,
+    vienti          INTEGER NOT NULL
+                            REFERENCES vienti(id)  ON DELETE CASCADE
+                                                   ON UPDATE CASCADE,
+    nimike          TEXT,
+    maara           REAL,
+    nettosnt        BIGINT,
+    bruttosnt       BIGINT,
+    alvkoodi        INTEGER,
+    alvprosentti    INTEGER,
+    tili            INTEGER,
+    kohdennus       INTEGER,
+    tuote           INTEGER
+);
+
+CREATE INDEX laskurivi_vienti ON laskurivi(vienti);
+CREATE INDEX laskurivi_nimike ON laskurivi(nimike);
+
+CREATE TABLE era (
+    id              INTEGER PRIMARY KEY
+                            REFERENCES vienti(id)  ON DELETE CASCADE
+                                                   ON UPDATE CASCADE,
+    tili            INTEGER,
+    saldosnt        BIGINT,
+    viite           VARCHAR(60),
+    asiakas         VARCHAR(60),
+    erapvm          DATE,
+    paivitetty      DATE
+);
+
+CREATE INDEX era_tili ON era(tili, saldosnt);
+CREATE INDEX era_viite ON era(viite);
+
 
 CREATE VIEW vientivw AS
     SELECT vienti.id as vientiId,
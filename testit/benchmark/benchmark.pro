@@ -0,0 +1,38 @@
+# Suorituskykymittaukset
+#
+# Mittaukset tarvitsevat koko kirjanpidon, joten projektiin otetaan
+# ohjelman omasta projektitiedostosta kaikki lähdekoodit main.cpp:tä
+# lukuunottamatta. Tiedostopolut ovat suhteessa ohjelman hakemistoon.
+#
+# Aja esimerkiksi: ./benchmark -tickcounter
+
+KITUPIIKKI = $$PWD/../../kitupiikki
+
+include($$KITUPIIKKI/kitupiikki.pro)
+
+QT += testlib
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = benchmark
+RC_ICONS =
+
+INCLUDEPATH += $$KITUPIIKKI
+
+KPSOURCES =
+for(tiedosto, SOURCES) {
+    !equals(tiedosto, main.cpp): KPSOURCES += $$KITUPIIKKI/$$tiedosto
+}
+KPHEADERS =
+for(tiedosto, HEADERS): KPHEADERS += $$KITUPIIKKI/$$tiedosto
+KPFORMS =
+for(tiedosto, FORMS): KPFORMS += $$KITUPIIKKI/$$tiedosto
+KPRESOURCES =
+for(tiedosto, RESOURCES): KPRESOURCES += $$KITUPIIKKI/$$tiedosto
+
+SOURCES = tst_benchmark.cpp $$KPSOURCES
+HEADERS = $$KPHEADERS
+FORMS = $$KPFORMS
+RESOURCES = $$KPRESOURCES
+DISTFILES =
@@ -0,0 +1,307 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QBuffer>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include "db/kirjanpito.h"
+#include "db/tositemodel.h"
+#include "db/vientimodel.h"
+#include "db/jsonkentta.h"
+#include "selaus/selausmodel.h"
+#include "raportti/raportinkirjoittaja.h"
+#include "raportti/raporttivirta.h"
+
+/**
+ * @brief Selausmodel, jonka rivien muistinkäyttö voidaan laskea
+ */
+class SelausMittari : public SelausModel
+{
+public:
+    int riveja() const { return rivit.count(); }
+
+    qint64 tavuja() const
+    {
+        qint64 tavut = rivit.capacity() * static_cast<qint64>( sizeof(SelausRivi) );
+        for( const QString& jono : merkkijonot_)
+            tavut += static_cast<qint64>( sizeof(QString) ) + jono.capacity() * static_cast<qint64>( sizeof(QChar) );
+        return tavut;
+    }
+};
+
+class BenchmarkTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchmarkTesti();
+    ~BenchmarkTesti();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void suurenTositteenTallennus();
+    void suurenTositteenMuokkaus();
+    void selausRivinKoko();
+    void jsonJasennys();
+    void jsonHaku();
+    void jsonSarjallistus();
+    void raportinPdf();
+    void raportinPdfVirtana();
+
+private:
+    RaportinKirjoittaja testiraportti(int riveja) const;
+
+    QTemporaryDir hakemisto_;
+    Kirjanpito *kirjanpito_ = nullptr;
+    TositeModel *tosite_ = nullptr;
+};
+
+static const int TOSITTEEN_RIVEJA = 2000;
+static const int RAPORTIN_RIVEJA = 5000;
+
+BenchmarkTesti::BenchmarkTesti()
+{
+
+}
+
+BenchmarkTesti::~BenchmarkTesti()
+{
+
+}
+
+void BenchmarkTesti::initTestCase()
+{
+    QVERIFY( hakemisto_.isValid() );
+    QString polku = hakemisto_.filePath("benchmark.kitupiikki");
+
+    // Tietokanta luodaan samoilla käskyillä kuin uusi kirjanpito
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "luonti");
+        db.setDatabaseName(polku);
+        QVERIFY( db.open() );
+
+        QFile sqltiedosto(":/sql/luo.sql");
+        QVERIFY( sqltiedosto.open(QIODevice::ReadOnly) );
+        QString sqluonti = QString::fromUtf8( sqltiedosto.readAll() );
+        sqluonti.replace("\n","");
+
+        QSqlQuery query(db);
+        for( const QString& kysely : sqluonti.split(";"))
+            query.exec(kysely);
+
+        query.exec("INSERT INTO asetus(avain, arvo) VALUES ('Nimi', 'Benchmark Oy')");
+        query.exec(QString("INSERT INTO asetus(avain, arvo) VALUES ('KpVersio', '%1')").arg(Kirjanpito::TIETOKANTAVERSIO));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("luonti");
+
+    // Asetukset väliaikaiseen hakemistoon, ettei käyttäjän asetuksia muuteta
+    kirjanpito_ = new Kirjanpito( hakemisto_.path() );
+    Kirjanpito::asetaInstanssi( kirjanpito_ );
+    QVERIFY( kp()->avaaTietokanta(polku, false) );
+
+    kp()->tilikaudet()->lisaaTilikausi( Tilikausi( QDate(2018,1,1), QDate(2018,12,31)));
+
+    Tili pankki;
+    pankki.asetaTyyppi("ARP");
+    pankki.asetaNumero(1910);
+    pankki.asetaNimi("Pankkitili");
+    kp()->tilit()->lisaaTili(pankki);
+
+    Tili myynti;
+    myynti.asetaTyyppi("CL");
+    myynti.asetaNumero(3000);
+    myynti.asetaNimi("Myynti");
+    kp()->tilit()->lisaaTili(myynti);
+
+    QVERIFY( kp()->tilit()->tallenna() );
+}
+
+void BenchmarkTesti::cleanupTestCase()
+{
+    delete tosite_;
+    delete kirjanpito_;
+    Kirjanpito::asetaInstanssi(nullptr);
+}
+
+void BenchmarkTesti::suurenTositteenTallennus()
+{
+    // Tiliotteen tuonti: jokaiselle tilitapahtumalle oma vientinsä
+    tosite_ = kp()->tositemodel();
+    tosite_->asetaPvm( QDate(2018,3,31));
+    tosite_->asetaOtsikko("Tiliote 3/2018");
+
+    Tili pankki = kp()->tilit()->tiliNumerolla(1910);
+    Tili myynti = kp()->tilit()->tiliNumerolla(3000);
+
+    for(int i=0; i < TOSITTEEN_RIVEJA / 2; i++)
+    {
+        VientiRivi rivi;
+        rivi.pvm = QDate(2018,3,1).addDays( i % 31 );
+        rivi.tili = pankki;
+        rivi.selite = QString("Maksu %1").arg(i);
+        rivi.debetSnt = 1000 + i;
+        rivi.viite = QString::number(1000 + i);
+        rivi.kohdennus = kp()->kohdennukset()->kohdennus(0);
+        tosite_->vientiModel()->lisaaVienti(rivi);
+
+        rivi.tili = myynti;
+        rivi.debetSnt = 0;
+        rivi.kreditSnt = 1000 + i;
+        tosite_->vientiModel()->lisaaVienti(rivi);
+    }
+
+    bool tallennettu = false;
+    QBENCHMARK_ONCE
+    {
+        tallennettu = tosite_->tallenna();
+    }
+    QVERIFY( tallennettu );
+}
+
+void BenchmarkTesti::suurenTositteenMuokkaus()
+{
+    // Tallennettaessa kirjoitetaan vain muuttunut vienti
+    QVERIFY( tosite_ );
+    QModelIndex indeksi = tosite_->vientiModel()->index(0, 0);
+    int kerta = 0;
+
+    QBENCHMARK
+    {
+        tosite_->vientiModel()->setData( indeksi, QString("Muokattu %1").arg(kerta++), VientiModel::SeliteRooli);
+        QVERIFY( tosite_->tallenna() );
+    }
+}
+
+void BenchmarkTesti::selausRivinKoko()
+{
+    SelausMittari selaus;
+    selaus.lataa( QDate(2018,1,1), QDate(2018,12,31));
+    QVERIFY( selaus.riveja() >= TOSITTEEN_RIVEJA );
+
+    QTest::setBenchmarkResult( static_cast<qreal>( selaus.tavuja() ) / selaus.riveja(), QTest::BytesAllocated );
+}
+
+void BenchmarkTesti::jsonJasennys()
+{
+    const QByteArray json("{\"Laskunumero\":\"1001\",\"Tasaerapoisto\":60,\"Viite\":\"10012\",\"Erapvm\":\"2018-04-14\"}");
+    QString numero;
+
+    QBENCHMARK
+    {
+        JsonKentta kentta( json );
+        numero = kentta.str("Laskunumero");
+    }
+    QCOMPARE( numero, QString("1001"));
+}
+
+void BenchmarkTesti::jsonHaku()
+{
+    JsonKentta kentta( QByteArray("{\"Laskunumero\":\"1001\",\"Tasaerapoisto\":60,\"Viite\":\"10012\",\"Erapvm\":\"2018-04-14\"}") );
+    int poisto = 0;
+
+    QBENCHMARK
+    {
+        poisto = kentta.luku("Tasaerapoisto");
+    }
+    QCOMPARE( poisto, 60);
+}
+
+void BenchmarkTesti::jsonSarjallistus()
+{
+    JsonKentta kentta( QByteArray("{\"Laskunumero\":\"1001\",\"Tasaerapoisto\":60,\"Viite\":\"10012\",\"Erapvm\":\"2018-04-14\"}") );
+    int kerta = 0;
+    QByteArray json;
+
+    QBENCHMARK
+    {
+        kentta.set("Tasaerapoisto", kerta++);
+        json = kentta.toJson();
+    }
+    QVERIFY( json.contains("Laskunumero") );
+}
+
+void BenchmarkTesti::raportinPdf()
+{
+    RaportinKirjoittaja raportti = testiraportti( RAPORTIN_RIVEJA );
+    QByteArray pdf;
+
+    QBENCHMARK
+    {
+        pdf = raportti.pdf(false, true);
+    }
+    QVERIFY( pdf.startsWith("%PDF") );
+}
+
+void BenchmarkTesti::raportinPdfVirtana()
+{
+    RaportinKirjoittaja raportti = testiraportti( RAPORTIN_RIVEJA );
+    QByteArray pdf;
+
+    QBENCHMARK
+    {
+        pdf.clear();
+        QBuffer puskuri(&pdf);
+        puskuri.open(QIODevice::WriteOnly);
+
+        PdfRaporttiVirta virta( &puskuri, false, true);
+        raportti.kirjoita( virta );
+        virta.valmis();
+    }
+    QVERIFY( pdf.startsWith("%PDF") );
+}
+
+RaportinKirjoittaja BenchmarkTesti::testiraportti(int riveja) const
+{
+    RaportinKirjoittaja rk;
+    rk.asetaOtsikko("PÄIVÄKIRJA");
+    rk.asetaKausiteksti("01.01.2018 - 31.12.2018");
+
+    rk.lisaaPvmSarake();
+    rk.lisaaSarake("ABC1234/99 ");
+    rk.lisaaVenyvaSarake();
+    rk.lisaaEurosarake();
+    rk.lisaaEurosarake();
+
+    RaporttiRivi otsikko;
+    otsikko.lisaa("Pvm");
+    otsikko.lisaa("Tosite");
+    otsikko.lisaa("Selite");
+    otsikko.lisaa("Debet €", 1, true);
+    otsikko.lisaa("Kredit €", 1, true);
+    rk.lisaaOtsake(otsikko);
+
+    for(int i=0; i < riveja; i++)
+    {
+        RaporttiRivi rivi;
+        rivi.lisaa( QDate(2018,1,1).addDays( i % 365 ));
+        rivi.lisaa( QString("A%1/18").arg(i));
+        rivi.lisaa( QString("Vientirivin selite %1").arg(i));
+        rivi.lisaa( qlonglong( i * 100 ) );
+        rivi.lisaa( qlonglong( 0 ) );
+        rk.lisaaRivi(rivi);
+    }
+    return rk;
+}
+
+QTEST_MAIN(BenchmarkTesti)
+
+#include "tst_benchmark.moc"
@@ -0,0 +1,51 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+#include <QCoreApplication>
+
+#include "tst_tuontitesti.h"
+#include "tst_tositenumerointi.h"
+#include "tst_alvkuutio.h"
+#include "tst_jsonkentta.h"
+
+/*
+ * Jokainen testiluokka ajetaan omana testinään. Uusi testiluokka
+ * lisätään omaan tiedostoonsa ja tähän luetteloon.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int tulos = 0;
+    {
+        TuontiTesti testi;
+        tulos |= QTest::qExec(&testi, argc, argv);
+    }
+    {
+        TositeNumerointiTesti testi;
+        tulos |= QTest::qExec(&testi, argc, argv);
+    }
+    {
+        AlvKuutioTesti testi;
+        tulos |= QTest::qExec(&testi, argc, argv);
+    }
+    {
+        JsonKenttaTesti testi;
+        tulos |= QTest::qExec(&testi, argc, argv);
+    }
+    return tulos;
+}
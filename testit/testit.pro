@@ -1,13 +1,27 @@
-QT += testlib
+QT += testlib sql
 
 CONFIG += qt console warn_on depend_includepath testcase
 CONFIG -= app_bundle
 
 TEMPLATE = app
 
-HEADERS += ../kitupiikki/validator/ibanvalidator.h \
-    ../kitupiikki/tuonti/tuontiapu.h
+HEADERS += tst_tuontitesti.h \
+    tst_tositenumerointi.h \
+    tst_alvkuutio.h \
+    tst_jsonkentta.h \
+    ../kitupiikki/validator/ibanvalidator.h \
+    ../kitupiikki/tuonti/tuontiapu.h \
+    ../kitupiikki/db/tositenumerointi.h \
+    ../kitupiikki/alv/alvkuutio.h \
+    ../kitupiikki/db/jsonkentta.h
 
-SOURCES +=  tst_tuontitesti.cpp \
+SOURCES +=  main.cpp \
+    tst_tuontitesti.cpp \
+    tst_tositenumerointi.cpp \
+    tst_alvkuutio.cpp \
+    tst_jsonkentta.cpp \
     ../kitupiikki/validator/ibanvalidator.cpp \
-    ../kitupiikki/tuonti/tuontiapu.cpp
+    ../kitupiikki/tuonti/tuontiapu.cpp \
+    ../kitupiikki/db/tositenumerointi.cpp \
+    ../kitupiikki/alv/alvkuutio.cpp \
+    ../kitupiikki/db/jsonkentta.cpp
@@ -0,0 +1,166 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include "tst_alvkuutio.h"
+
+#include "../kitupiikki/db/verotyyppimodel.h"
+#include "../kitupiikki/alv/alvkuutio.h"
+
+AlvKuutioTesti::AlvKuutioTesti()
+{
+
+}
+
+AlvKuutioTesti::~AlvKuutioTesti()
+{
+
+}
+
+void AlvKuutioTesti::initTestCase()
+{
+    // Alv-laskelman testiviennit: tammikuun kirjausten lisäksi
+    // koodittomia ja jakson ulkopuolisia vientejä
+    QSqlDatabase tietokanta = QSqlDatabase::addDatabase("QSQLITE", "alv");
+    tietokanta.setDatabaseName(":memory:");
+    tietokanta.open();
+
+    QSqlQuery kysely(tietokanta);
+    kysely.exec("CREATE TABLE vienti (id INTEGER PRIMARY KEY AUTOINCREMENT, pvm DATE, tili INTEGER, "
+                "alvkoodi INTEGER, alvprosentti INTEGER, debetsnt BIGINT, kreditsnt BIGINT)");
+    kysely.exec("INSERT INTO vienti(pvm, tili, alvkoodi, alvprosentti, debetsnt, kreditsnt) VALUES "
+                "('2018-01-03',3000,11,24,0,10000), ('2018-01-04',3000,11,24,0,5000), "
+                "('2018-01-04',3010,11,14,0,2000), ('2018-01-03',2939,111,24,0,2400), "
+                "('2018-01-04',2939,111,24,0,1200), ('2018-01-04',2939,111,14,0,280), "
+                "('2018-01-05',4000,21,24,3000,0), ('2018-01-05',1763,221,24,720,0), "
+                "('2018-01-06',3100,12,0,0,1500), ('2018-01-06',3100,12,24,0,12400), "
+                "('2018-01-07',3200,12,14,0,11400), ('2018-01-08',4100,22,24,6200,0), "
+                "('2018-01-09',3300,13,24,0,5000), ('2018-01-10',3000,118,24,0,500), "
+                "('2018-01-10',1910,0,0,100,0), ('2018-01-31',3000,11,24,300,0), "
+                "('2018-02-05',3000,11,24,0,99900), ('2017-12-31',2939,111,24,0,800)");
+}
+
+void AlvKuutioTesti::cleanupTestCase()
+{
+    {
+        QSqlDatabase tietokanta = alvTietokanta();
+        tietokanta.close();
+    }
+    QSqlDatabase::removeDatabase("alv");
+}
+
+QSqlDatabase AlvKuutioTesti::alvTietokanta() const
+{
+    return QSqlDatabase::database("alv");
+}
+
+void AlvKuutioTesti::alvKoodeittainTesti()
+{
+    // Aiempi ilmoituksen kooditaulun kysely
+    QSqlDatabase tietokanta = alvTietokanta();
+    QSqlQuery query(tietokanta);
+    query.exec("select alvkoodi, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti "
+               "where pvm between \"2018-01-01\" and \"2018-01-31\" group by alvkoodi");
+
+    QMap<int,qlonglong> odotetut;
+    while( query.next())
+    {
+        // Koodittomat viennit eivät kuulu ilmoitukselle
+        if( query.value("alvkoodi").toInt())
+            odotetut.insert( query.value("alvkoodi").toInt(),
+                             query.value("kreditit").toLongLong() - query.value("debetit").toLongLong());
+    }
+
+    AlvKuutio kuutio( tietokanta, QDate(2018,1,1), QDate(2018,1,31));
+    QCOMPARE( kuutio.saldotKoodeittain(), odotetut );
+    QCOMPARE( kuutio.saldotKoodeittain().value(AlvKoodi::MYYNNIT_NETTO), 16700LL );
+}
+
+void AlvKuutioTesti::alvNettoveroTesti()
+{
+    // Aiempi nettokirjausten koonti verokannoittain
+    QSqlDatabase tietokanta = alvTietokanta();
+    QSqlQuery query(tietokanta);
+    query.exec( QString("select alvprosentti, sum(debetsnt) as debetit, sum(kreditsnt) as kreditit from vienti "
+                        "where pvm between \"2018-01-01\" and \"2018-01-31\" and (alvkoodi=%1 or alvkoodi=%2) group by alvprosentti")
+                .arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MYYNNIT_NETTO).arg(AlvKoodi::ALVKIRJAUS + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI) );
+
+    QMap<int,qlonglong> odotetut;
+    while( query.next())
+        odotetut.insert( query.value("alvprosentti").toInt(),
+                         query.value("kreditit").toLongLong() - query.value("debetit").toLongLong());
+
+    AlvKuutio kuutio( tietokanta, QDate(2018,1,1), QDate(2018,1,31));
+    QMap<int,qlonglong> kannoittain;
+    for( int koodi : { AlvKoodi::ALVKIRJAUS + AlvKoodi::MYYNNIT_NETTO, AlvKoodi::ALVKIRJAUS + AlvKoodi::MAKSUPERUSTEINEN_MYYNTI })
+    {
+        QMapIterator<int,qlonglong> iter( kuutio.saldotProsenteittain(koodi));
+        while( iter.hasNext())
+        {
+            iter.next();
+            kannoittain[ iter.key() ] += iter.value();
+        }
+    }
+
+    QCOMPARE( kannoittain, odotetut );
+    QCOMPARE( kannoittain.value(24), 4100LL );
+}
+
+void AlvKuutioTesti::alvBruttoNollaprosenttiTesti()
+{
+    // Aiempi bruttojen oikaisun kysely. Se lopetti läpikäynnin ensimmäiseen
+    // 0 %:n riviin, jolloin saman tilin muut verokannat jäivät oikaisematta.
+    QSqlDatabase tietokanta = alvTietokanta();
+    QSqlQuery query(tietokanta);
+    query.exec(  QString("select alvkoodi,alvprosentti,sum(debetsnt) as debetit, sum(kreditsnt) as kreditit, tili from vienti "
+                         "where pvm between \"2018-01-01\" and \"2018-01-31\" and (alvkoodi=%1 or alvkoodi=%2) group by alvkoodi,tili,alvprosentti")
+                 .arg(AlvKoodi::MYYNNIT_BRUTTO).arg(AlvKoodi::OSTOT_BRUTTO) );
+
+    QStringList odotetut;
+    int ennenKorjausta = 0;
+    bool nollaLoytynyt = false;
+    while( query.next())
+    {
+        if( !query.value("alvprosentti").toInt())
+        {
+            nollaLoytynyt = true;
+            continue;
+        }
+        if( !nollaLoytynyt )
+            ennenKorjausta++;
+        odotetut << QString("%1 %2 %3 %4").arg(query.value("alvkoodi").toInt()).arg(query.value("tili").toInt())
+                    .arg(query.value("alvprosentti").toInt())
+                    .arg(query.value("kreditit").toLongLong() - query.value("debetit").toLongLong());
+    }
+
+    AlvKuutio kuutio( tietokanta, QDate(2018,1,1), QDate(2018,1,31));
+    QStringList oikaistavat;
+    for( const AlvKuutio::Solu& solu : kuutio.solut())
+    {
+        if( ( solu.alvkoodi != AlvKoodi::MYYNNIT_BRUTTO && solu.alvkoodi != AlvKoodi::OSTOT_BRUTTO) ||
+            !solu.alvprosentti )
+            continue;
+        oikaistavat << QString("%1 %2 %3 %4").arg(solu.alvkoodi).arg(solu.tili).arg(solu.alvprosentti).arg(solu.saldo());
+    }
+
+    QCOMPARE( oikaistavat, odotetut );
+    QCOMPARE( oikaistavat.count(), 3 );
+    QVERIFY( ennenKorjausta < oikaistavat.count() );
+}
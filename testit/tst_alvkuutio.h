@@ -0,0 +1,43 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TST_ALVKUUTIO_H
+#define TST_ALVKUUTIO_H
+
+#include <QObject>
+#include <QSqlDatabase>
+
+class AlvKuutioTesti : public QObject
+{
+    Q_OBJECT
+
+public:
+    AlvKuutioTesti();
+    ~AlvKuutioTesti();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void alvKoodeittainTesti();
+    void alvNettoveroTesti();
+    void alvBruttoNollaprosenttiTesti();
+
+private:
+    QSqlDatabase alvTietokanta() const;
+
+};
+
+#endif // TST_ALVKUUTIO_H
@@ -0,0 +1,46 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+
+#include "tst_jsonkentta.h"
+
+#include "../kitupiikki/db/jsonkentta.h"
+
+JsonKenttaTesti::JsonKenttaTesti()
+{
+
+}
+
+JsonKenttaTesti::~JsonKenttaTesti()
+{
+
+}
+
+void JsonKenttaTesti::jsonVertailuTesti()
+{
+    // Vientien tallennus vertaa muokkaamattomien vientien jsonit
+    // tallennettuihin kopioimatta jaettuja tietoja
+    const JsonKentta tallennettu( QByteArray("{\"Laskunumero\":\"1001\",\"Tasaerapoisto\":60}") );
+    const JsonKentta rivi = tallennettu;
+
+    QVERIFY( rivi.toJson() == tallennettu.toJson() );
+
+    JsonKentta muokattu = tallennettu;
+    muokattu.set("Tasaerapoisto", 48);
+    QVERIFY( muokattu.toJson() != tallennettu.toJson() );
+    QCOMPARE( tallennettu.toJson(), QByteArray("{\"Laskunumero\":\"1001\",\"Tasaerapoisto\":60}") );
+}
@@ -0,0 +1,71 @@
+/*
+   Copyright (C) 2018 Arto Hyvättinen
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QtTest>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include "tst_tositenumerointi.h"
+
+#include "../kitupiikki/db/tositenumerointi.h"
+
+TositeNumerointiTesti::TositeNumerointiTesti()
+{
+
+}
+
+TositeNumerointiTesti::~TositeNumerointiTesti()
+{
+
+}
+
+QList<int> TositeNumerointiTesti::numeroiTestitositteet(bool samaanSarjaan)
+{
+    QList<int> tunnisteet;
+    {
+        QSqlDatabase tietokanta = QSqlDatabase::addDatabase("QSQLITE", "numerointi");
+        tietokanta.setDatabaseName(":memory:");
+        tietokanta.open();
+
+        QSqlQuery kysely(tietokanta);
+        kysely.exec("CREATE TABLE tosite (id INTEGER PRIMARY KEY AUTOINCREMENT, pvm DATE, tunniste INTEGER, laji INTEGER)");
+        kysely.exec("INSERT INTO tosite(pvm, tunniste, laji) VALUES "
+                    "('2018-03-01',99,1), ('2018-01-05',99,2), ('2018-01-05',99,1), "
+                    "('2018-02-01',99,2), ('2017-12-31',99,1), ('2018-01-02',99,1)");
+
+        if( TositeNumerointi::numeroiUudelleen( tietokanta, QDate(2018,1,1), QDate(2018,12,31), samaanSarjaan) )
+        {
+            kysely.exec("SELECT tunniste FROM tosite ORDER BY id");
+            while( kysely.next())
+                tunnisteet.append( kysely.value(0).toInt());
+        }
+        tietokanta.close();
+    }
+    QSqlDatabase::removeDatabase("numerointi");
+    return tunnisteet;
+}
+
+void TositeNumerointiTesti::numerointiSamaanSarjaanTesti()
+{
+    // Saman päivän tositteet luontijärjestyksessä, kauden ulkopuolinen ennallaan
+    QCOMPARE( numeroiTestitositteet(true), QList<int>() << 5 << 2 << 3 << 4 << 99 << 1 );
+}
+
+void TositeNumerointiTesti::numerointiLajeittainTesti()
+{
+    QCOMPARE( numeroiTestitositteet(false), QList<int>() << 3 << 1 << 2 << 2 << 99 << 1 );
+}